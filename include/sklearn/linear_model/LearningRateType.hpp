@@ -0,0 +1,38 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+namespace sklearn {
+    namespace linear_model {
+        enum class LearningRateType {
+            // eta = eta0
+            kConstant,
+            // eta = 1 / (alpha (t + t0)), t0 chosen by a heuristic of Leon Bottou
+            kOptimal,
+            // eta = eta0 / t^power_t
+            kInvscaling,
+            // eta = eta0, divided by 5 each time n_iter_no_change epochs in a row do not improve by tol
+            kAdaptive
+        };
+    }
+}// namespace sklearn
@@ -0,0 +1,564 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <np/Array.hpp>
+
+#include <sklearn/linear_model/SolverType.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+#include <sklearn/utils/extmath.hpp>
+
+namespace sklearn {
+    namespace linear_model {
+        namespace internal {
+            // Least squares with an intercept, solved on centered statistics of the augmented rows a = (x, y), q
+            // columns: the features then the target. The design is read kLeastSquaresBlockRows rows at a time, so a fit
+            // needs O(q^2 + kLeastSquaresBlockRows * q) memory besides X, and neither a copy of X with a column of ones
+            // nor an explicit inverse is ever formed. Sample weights w enter as weighted means and centered rows scaled
+            // by sqrt(w), so weighted problems cost the same and never form diag(w).
+
+            // A block of rows, centered and transposed, stays in the L2 cache while it is folded into the statistics.
+            constexpr np::Size kLeastSquaresBlockRows = 256;
+
+            // Stores the m rows of block (row-major, q columns) centered on their mean, transposed: column j of the
+            // block at Bt + j * ldb. With weights, the mean is the weighted one and row r is scaled by sqrt(weights[r]).
+            // The mean is written to mean, the total weight of the rows is returned.
+            inline np::float_ centerTransposed(const np::float_ *block, const np::float_ *weights, np::Size m, np::Size q, np::float_ *mean, np::float_ *Bt, np::Size ldb) {
+                std::fill(mean, mean + q, 0.0);
+                np::float_ total{0};
+                for (np::Size r = 0; r < m; ++r) {
+                    const np::float_ w = weights != nullptr ? weights[r] : 1.0;
+                    total += w;
+                    for (np::Size j = 0; j < q; ++j) {
+                        mean[j] += w * block[r * q + j];
+                    }
+                }
+                if (total > 0.0) {
+                    for (np::Size j = 0; j < q; ++j) {
+                        mean[j] /= total;
+                    }
+                }
+                for (np::Size r = 0; r < m; ++r) {
+                    const np::float_ scale = weights != nullptr ? std::sqrt(weights[r]) : 1.0;
+                    for (np::Size j = 0; j < q; ++j) {
+                        Bt[j * ldb + r] = scale * (block[r * q + j] - mean[j]);
+                    }
+                }
+                return total;
+            }
+
+            // Folds rows into the upper triangular R (q x q, row-major) by Householder reflections: afterwards R^T R is
+            // the previous R^T R plus B^T B, for the m rows of B stored column-major (column j at Bt + j * ldb). B is
+            // overwritten. The reflection of column j only touches row j of R and the block, so R is updated in place.
+            struct HouseholderFold {
+                SKLEARN_ALWAYS_INLINE static void run(np::float_ *R, np::Size q, np::float_ *Bt, np::Size m, np::Size ldb) {
+                    for (np::Size j = 0; j < q; ++j) {
+                        const np::float_ *v = Bt + j * ldb;
+                        np::float_ tail{0};
+                        for (np::Size r = 0; r < m; ++r) {
+                            tail += v[r] * v[r];
+                        }
+                        if (tail == 0.0) {
+                            continue;
+                        }
+                        // The sign of alpha is opposite to R[j][j], so v0 = R[j][j] - alpha does not cancel.
+                        const np::float_ rjj = R[j * q + j];
+                        const np::float_ norm = std::sqrt(rjj * rjj + tail);
+                        const np::float_ alpha = rjj > 0.0 ? -norm : norm;
+                        const np::float_ v0 = rjj - alpha;
+                        const np::float_ scale = 2.0 / (v0 * v0 + tail);
+                        R[j * q + j] = alpha;
+                        for (np::Size k = j + 1; k < q; ++k) {
+                            np::float_ *b = Bt + k * ldb;
+                            np::float_ s = v0 * R[j * q + k];
+                            for (np::Size r = 0; r < m; ++r) {
+                                s += v[r] * b[r];
+                            }
+                            s *= scale;
+                            R[j * q + k] -= s * v0;
+                            for (np::Size r = 0; r < m; ++r) {
+                                b[r] -= s * v[r];
+                            }
+                        }
+                    }
+                }
+            };
+
+            // The count, the means and the centered cross products M = sum (a - mean)(a - mean)^T (q x q, row-major)
+            // of the augmented rows. Every block is centered on its own mean and merged by the pairwise update of Chan,
+            // Golub and LeVeque, so data far from the origin loses no precision to cancellation. The same update merges
+            // the statistics of another part of the data, e.g. of a shard accumulated by another thread.
+            class GramStatistics {
+            public:
+                explicit GramStatistics(np::Size q = 0)
+                    : m_q{q}, m_mean(q), m_moments(q * q) {
+                }
+
+                // Adds the m rows of block, row-major with q columns, with the non-negative weights if given. The count
+                // is the total weight.
+                void add(const np::float_ *block, np::Size m, const np::float_ *weights = nullptr) {
+                    if (m == 0) {
+                        return;
+                    }
+                    m_rows += m;
+                    m_blockMean.resize(m_q);
+                    m_transposed.resize(std::max(m_transposed.size(), m * m_q));
+                    m_blockMoments.resize(m_q * m_q);
+                    const auto count = centerTransposed(block, weights, m, m_q, m_blockMean.data(), m_transposed.data(), m);
+                    if (!(count > 0.0)) {
+                        return;
+                    }
+                    utils::dot_transposed(m_transposed.data(), m, m_transposed.data(), m, m_q, m_q, m, m_blockMoments.data(), m_q);
+                    mergeMoments(count, m_blockMean.data(), m_blockMoments.data());
+                }
+
+                // Adds the statistics of other rows with the same q.
+                void merge(const GramStatistics &other) {
+                    m_rows += other.m_rows;
+                    if (other.m_count > 0.0) {
+                        mergeMoments(other.m_count, other.m_mean.data(), other.m_moments.data());
+                    }
+                }
+
+                [[nodiscard]] np::Size q() const {
+                    return m_q;
+                }
+
+                // The number of rows added, including the ones of zero weight.
+                [[nodiscard]] np::Size rows() const {
+                    return m_rows;
+                }
+
+                [[nodiscard]] np::float_ count() const {
+                    return m_count;
+                }
+
+                [[nodiscard]] const std::vector<np::float_> &mean() const {
+                    return m_mean;
+                }
+
+                [[nodiscard]] const std::vector<np::float_> &moments() const {
+                    return m_moments;
+                }
+
+            private:
+                void mergeMoments(np::float_ count, const np::float_ *mean, const np::float_ *moments) {
+                    const auto total = m_count + count;
+                    const auto weight = m_count * count / total;
+                    for (np::Size i = 0; i < m_q; ++i) {
+                        const auto di = mean[i] - m_mean[i];
+                        for (np::Size j = 0; j < m_q; ++j) {
+                            m_moments[i * m_q + j] += moments[i * m_q + j] + weight * di * (mean[j] - m_mean[j]);
+                        }
+                    }
+                    for (np::Size i = 0; i < m_q; ++i) {
+                        m_mean[i] += (mean[i] - m_mean[i]) * count / total;
+                    }
+                    m_count = total;
+                }
+
+                np::Size m_q;
+                np::Size m_rows{0};
+                np::float_ m_count{0};
+                std::vector<np::float_> m_mean;
+                std::vector<np::float_> m_moments;
+                std::vector<np::float_> m_blockMean;
+                std::vector<np::float_> m_transposed;
+                std::vector<np::float_> m_blockMoments;
+            };
+
+            // The count, the means and the upper triangular R (q x q, row-major) with R^T R = M of GramStatistics, built
+            // without forming M: the centered rows of every block, and the row sqrt(n m / (n + m)) (mean_B - mean) that
+            // accounts for the shift between the means, are folded into R by HouseholderFold. The condition number of R
+            // is the one of the centered X, not its square as for M. The statistics of another part of the data merge
+            // the same way, with the rows of its R in place of the centered rows.
+            class QrStatistics {
+            public:
+                explicit QrStatistics(np::Size q = 0)
+                    : m_q{q}, m_mean(q), m_r(q * q) {
+                }
+
+                // Adds the m rows of block, row-major with q columns, with the non-negative weights if given. The count
+                // is the total weight.
+                void add(const np::float_ *block, np::Size m, const np::float_ *weights = nullptr) {
+                    if (m == 0) {
+                        return;
+                    }
+                    m_rows += m;
+                    const np::Size ldb = m + 1;
+                    m_blockMean.resize(m_q);
+                    m_transposed.resize(std::max(m_transposed.size(), ldb * m_q));
+                    const auto count = centerTransposed(block, weights, m, m_q, m_blockMean.data(), m_transposed.data(), ldb);
+                    if (count > 0.0) {
+                        fold(count, m_blockMean.data(), m, ldb);
+                    }
+                }
+
+                // Adds the statistics of other rows with the same q.
+                void merge(const QrStatistics &other) {
+                    m_rows += other.m_rows;
+                    if (!(other.m_count > 0.0)) {
+                        return;
+                    }
+                    const np::Size ldb = m_q + 1;
+                    m_transposed.resize(std::max(m_transposed.size(), ldb * m_q));
+                    for (np::Size i = 0; i < m_q; ++i) {
+                        for (np::Size j = 0; j < m_q; ++j) {
+                            m_transposed[j * ldb + i] = other.m_r[i * m_q + j];
+                        }
+                    }
+                    fold(other.m_count, other.m_mean.data(), m_q, ldb);
+                }
+
+                [[nodiscard]] np::Size q() const {
+                    return m_q;
+                }
+
+                // The number of rows added, including the ones of zero weight.
+                [[nodiscard]] np::Size rows() const {
+                    return m_rows;
+                }
+
+                [[nodiscard]] np::float_ count() const {
+                    return m_count;
+                }
+
+                [[nodiscard]] const std::vector<np::float_> &mean() const {
+                    return m_mean;
+                }
+
+                [[nodiscard]] const std::vector<np::float_> &r() const {
+                    return m_r;
+                }
+
+            private:
+                // Folds the m centered rows in m_transposed (stride ldb > m), of total weight count and mean mean, into R,
+                // with the row of the shift between the means in column m.
+                void fold(np::float_ count, const np::float_ *mean, np::Size m, np::Size ldb) {
+                    const auto total = m_count + count;
+                    np::Size rows = m;
+                    if (m_count > 0.0) {
+                        const auto shift = std::sqrt(m_count * count / total);
+                        for (np::Size j = 0; j < m_q; ++j) {
+                            m_transposed[j * ldb + m] = shift * (mean[j] - m_mean[j]);
+                        }
+                        rows = m + 1;
+                    }
+                    utils::cpu_dispatch<HouseholderFold>(m_r.data(), m_q, m_transposed.data(), rows, ldb);
+                    for (np::Size i = 0; i < m_q; ++i) {
+                        m_mean[i] += (mean[i] - m_mean[i]) * count / total;
+                    }
+                    m_count = total;
+                }
+
+                np::Size m_q;
+                np::Size m_rows{0};
+                np::float_ m_count{0};
+                std::vector<np::float_> m_mean;
+                std::vector<np::float_> m_r;
+                std::vector<np::float_> m_blockMean;
+                std::vector<np::float_> m_transposed;
+            };
+
+            // Pivots of the Cholesky factorization of the scaled Gram matrix below this one make kAuto switch to qr: the
+            // normal equations would lose about half of the digits.
+            inline np::float_ minCholeskyPivot() {
+                return std::sqrt(std::numeric_limits<np::float_>::epsilon());
+            }
+
+            // Singular values below rcond times the largest one are treated as zero, as numpy.linalg.lstsq does.
+            inline np::float_ lstsqRcond(np::Size n_samples, np::Size q) {
+                return std::numeric_limits<np::float_>::epsilon() * static_cast<np::float_>(std::max(n_samples, q));
+            }
+
+            // Solves the normal equations M_xx coef = M_xy by an in-place Cholesky factorization of the Gram matrix
+            // scaled to a unit diagonal, which makes the pivots independent of the units of the features. Returns false
+            // if the matrix is not positive definite, e.g. for a constant or duplicated feature, otherwise stores the
+            // smallest pivot into min_pivot.
+            inline bool solveCholesky(const GramStatistics &statistics, std::vector<np::float_> &coef, np::float_ &min_pivot) {
+                const np::Size q = statistics.q();
+                const np::Size p = q - 1;
+                const auto &M = statistics.moments();
+                std::vector<np::float_> scale(p);
+                for (np::Size i = 0; i < p; ++i) {
+                    if (!(M[i * q + i] > 0.0)) {
+                        return false;
+                    }
+                    scale[i] = 1.0 / std::sqrt(M[i * q + i]);
+                }
+                // A copy of the scaled matrix, as partial_fit keeps accumulating into the statistics. L overwrites its
+                // lower triangle in place, row by row: the inner products run over two contiguous rows of L.
+                std::vector<np::float_> L(p * p);
+                for (np::Size i = 0; i < p; ++i) {
+                    for (np::Size j = 0; j <= i; ++j) {
+                        L[i * p + j] = M[i * q + j] * scale[i] * scale[j];
+                    }
+                }
+                min_pivot = 1.0;
+                for (np::Size i = 0; i < p; ++i) {
+                    for (np::Size j = 0; j <= i; ++j) {
+                        np::float_ sum = L[i * p + j];
+                        for (np::Size k = 0; k < j; ++k) {
+                            sum -= L[i * p + k] * L[j * p + k];
+                        }
+                        if (j < i) {
+                            L[i * p + j] = sum / L[j * p + j];
+                        } else {
+                            if (!(sum > 0.0)) {
+                                return false;
+                            }
+                            min_pivot = std::min(min_pivot, sum);
+                            L[i * p + i] = std::sqrt(sum);
+                        }
+                    }
+                }
+                coef.resize(p);
+                for (np::Size i = 0; i < p; ++i) {
+                    np::float_ sum = M[i * q + p] * scale[i];
+                    for (np::Size k = 0; k < i; ++k) {
+                        sum -= L[i * p + k] * coef[k];
+                    }
+                    coef[i] = sum / L[i * p + i];
+                }
+                for (np::Size i = p; i-- > 0;) {
+                    np::float_ sum = coef[i];
+                    for (np::Size k = i + 1; k < p; ++k) {
+                        sum -= L[k * p + i] * coef[k];
+                    }
+                    coef[i] = sum / L[i * p + i];
+                }
+                for (np::Size i = 0; i < p; ++i) {
+                    coef[i] *= scale[i];
+                }
+                return true;
+            }
+
+            // Solves R_xx coef = R_xy by back substitution. Returns false if a diagonal element of R is at most
+            // tolerance times the norm of its column, that is if the centered X is rank deficient to that tolerance.
+            inline bool solveQr(const QrStatistics &statistics, np::float_ tolerance, std::vector<np::float_> &coef) {
+                const np::Size q = statistics.q();
+                const np::Size p = q - 1;
+                const auto &R = statistics.r();
+                for (np::Size j = 0; j < p; ++j) {
+                    np::float_ norm{0};
+                    for (np::Size i = 0; i <= j; ++i) {
+                        norm += R[i * q + j] * R[i * q + j];
+                    }
+                    if (!(std::abs(R[j * q + j]) > tolerance * std::sqrt(norm))) {
+                        return false;
+                    }
+                }
+                coef.resize(p);
+                for (np::Size i = p; i-- > 0;) {
+                    np::float_ sum = R[i * q + p];
+                    for (np::Size k = i + 1; k < p; ++k) {
+                        sum -= R[i * q + k] * coef[k];
+                    }
+                    coef[i] = sum / R[i * q + i];
+                }
+                return true;
+            }
+
+            // The minimum norm solution of R_xx coef = R_xy from the singular value decomposition R_xx = U S V^T,
+            // computed by one-sided Jacobi rotations of the columns of R_xx: on convergence the columns are U S.
+            // Singular values below rcond times the largest one are discarded.
+            inline void solveSvd(const QrStatistics &statistics, np::float_ rcond, std::vector<np::float_> &coef) {
+                constexpr int kMaxSweeps = 64;
+                const np::Size q = statistics.q();
+                const np::Size p = q - 1;
+                const auto &R = statistics.r();
+                const auto eps = std::numeric_limits<np::float_>::epsilon();
+                // Column-major copies: column j of R_xx at A + j * p, of V at V + j * p.
+                std::vector<np::float_> A(p * p);
+                std::vector<np::float_> V(p * p);
+                for (np::Size j = 0; j < p; ++j) {
+                    for (np::Size i = 0; i <= j; ++i) {
+                        A[j * p + i] = R[i * q + j];
+                    }
+                    V[j * p + j] = 1.0;
+                }
+                for (int sweep = 0; sweep < kMaxSweeps; ++sweep) {
+                    bool rotated = false;
+                    for (np::Size i = 0; i + 1 < p; ++i) {
+                        for (np::Size j = i + 1; j < p; ++j) {
+                            np::float_ *ai = A.data() + i * p;
+                            np::float_ *aj = A.data() + j * p;
+                            np::float_ alpha{0};
+                            np::float_ beta{0};
+                            np::float_ gamma{0};
+                            for (np::Size k = 0; k < p; ++k) {
+                                alpha += ai[k] * ai[k];
+                                beta += aj[k] * aj[k];
+                                gamma += ai[k] * aj[k];
+                            }
+                            if (!(std::abs(gamma) > eps * std::sqrt(alpha * beta))) {
+                                continue;
+                            }
+                            rotated = true;
+                            const auto zeta = (beta - alpha) / (2.0 * gamma);
+                            const auto t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                            const auto c = 1.0 / std::sqrt(1.0 + t * t);
+                            const auto s = c * t;
+                            for (np::Size k = 0; k < p; ++k) {
+                                const auto x = ai[k];
+                                ai[k] = c * x - s * aj[k];
+                                aj[k] = s * x + c * aj[k];
+                            }
+                            np::float_ *vi = V.data() + i * p;
+                            np::float_ *vj = V.data() + j * p;
+                            for (np::Size k = 0; k < p; ++k) {
+                                const auto x = vi[k];
+                                vi[k] = c * x - s * vj[k];
+                                vj[k] = s * x + c * vj[k];
+                            }
+                        }
+                    }
+                    if (!rotated) {
+                        break;
+                    }
+                }
+                std::vector<np::float_> sigma2(p);
+                np::float_ max_sigma2{0};
+                for (np::Size j = 0; j < p; ++j) {
+                    for (np::Size k = 0; k < p; ++k) {
+                        sigma2[j] += A[j * p + k] * A[j * p + k];
+                    }
+                    max_sigma2 = std::max(max_sigma2, sigma2[j]);
+                }
+                coef.assign(p, 0.0);
+                for (np::Size j = 0; j < p; ++j) {
+                    if (!(sigma2[j] > rcond * rcond * max_sigma2)) {
+                        continue;
+                    }
+                    // (u_j . R_xy) / s_j with u_j = a_j / s_j
+                    np::float_ projection{0};
+                    for (np::Size k = 0; k < p; ++k) {
+                        projection += A[j * p + k] * R[k * q + p];
+                    }
+                    projection /= sigma2[j];
+                    for (np::Size k = 0; k < p; ++k) {
+                        coef[k] += projection * V[j * p + k];
+                    }
+                }
+            }
+
+            // The intercept of the centered solution, mean_y - mean_x . coef.
+            inline np::float_ interceptOf(const std::vector<np::float_> &mean, const std::vector<np::float_> &coef) {
+                np::float_ intercept = mean.back();
+                for (np::Size i = 0; i < coef.size(); ++i) {
+                    intercept -= mean[i] * coef[i];
+                }
+                return intercept;
+            }
+
+            // Adds the n_samples rows produced by readRows(start, m, block), which writes the augmented rows
+            // [start, start + m) into block, row-major: the features then the target. sample_weight holds n_samples
+            // non-negative weights, or is nullptr for unit weights.
+            template<typename Statistics, typename ReadRows>
+            void accumulateRows(Statistics &statistics, np::Size n_samples, const ReadRows &readRows, const np::float_ *sample_weight) {
+                if (sample_weight != nullptr) {
+                    for (np::Size i = 0; i < n_samples; ++i) {
+                        if (!(sample_weight[i] >= 0.0)) {
+                            throw std::runtime_error("Sample weights must be non-negative");
+                        }
+                    }
+                }
+                const np::Size q = statistics.q();
+                std::vector<np::float_> block(std::min(n_samples, kLeastSquaresBlockRows) * q);
+                for (np::Size start = 0; start < n_samples; start += kLeastSquaresBlockRows) {
+                    const np::Size m = std::min(kLeastSquaresBlockRows, n_samples - start);
+                    readRows(start, m, block.data());
+                    statistics.add(block.data(), m, sample_weight != nullptr ? sample_weight + start : nullptr);
+                }
+            }
+
+            template<typename Statistics>
+            void checkStatistics(const Statistics &statistics) {
+                if (statistics.rows() == 0) {
+                    throw std::runtime_error("Found array with 0 sample(s) while a minimum of 1 is required");
+                }
+                if (!(statistics.count() > 0.0)) {
+                    throw std::runtime_error("Sample weights sum to zero");
+                }
+            }
+
+            // Solves the normal equations of the Gram statistics by Cholesky. If strict, a singular matrix throws,
+            // otherwise false is returned for a singular or ill-conditioned one, see minCholeskyPivot.
+            inline bool solveGram(const GramStatistics &statistics, bool strict, std::vector<np::float_> &coef, np::float_ &intercept) {
+                checkStatistics(statistics);
+                np::float_ min_pivot{0};
+                const bool solved = solveCholesky(statistics, coef, min_pivot);
+                if (solved && (strict || min_pivot >= minCholeskyPivot())) {
+                    intercept = interceptOf(statistics.mean(), coef);
+                    return true;
+                }
+                if (strict) {
+                    throw std::runtime_error("The Gram matrix is singular, use the qr or svd solver");
+                }
+                return false;
+            }
+
+            // Solves the problem of the R statistics by back substitution for kQr, by singular value decomposition for
+            // kSvd, and for kAuto by back substitution unless R is rank deficient, otherwise by singular value
+            // decomposition. Returns the solver used, throws for kQr if R is singular.
+            inline SolverType solveR(const QrStatistics &statistics, SolverType solver, std::vector<np::float_> &coef, np::float_ &intercept) {
+                checkStatistics(statistics);
+                const auto rcond = lstsqRcond(statistics.rows(), statistics.q());
+                SolverType used = SolverType::kSvd;
+                if (solver != SolverType::kSvd && solveQr(statistics, solver == SolverType::kQr ? 0.0 : rcond, coef)) {
+                    used = SolverType::kQr;
+                } else if (solver == SolverType::kQr) {
+                    throw std::runtime_error("X is rank deficient, use the svd solver");
+                } else {
+                    solveSvd(statistics, rcond, coef);
+                }
+                intercept = interceptOf(statistics.mean(), coef);
+                return used;
+            }
+
+            // Fits y on the n_samples rows of readRows with an intercept, see accumulateRows. kAuto tries Cholesky first
+            // and reads the rows a second time for the R statistics only if it fails.
+            // Returns the solver that produced the solution, kAuto resolved. Throws if the solver asked for cannot
+            // solve the problem: cholesky for a singular Gram matrix, qr for a rank deficient X.
+            template<typename ReadRows>
+            SolverType leastSquares(np::Size n_samples, np::Size n_features, SolverType solver, const ReadRows &readRows, const np::float_ *sample_weight, std::vector<np::float_> &coef, np::float_ &intercept) {
+                if (solver == SolverType::kAuto || solver == SolverType::kCholesky) {
+                    GramStatistics gram{n_features + 1};
+                    accumulateRows(gram, n_samples, readRows, sample_weight);
+                    if (solveGram(gram, solver == SolverType::kCholesky, coef, intercept)) {
+                        return SolverType::kCholesky;
+                    }
+                }
+                QrStatistics qr{n_features + 1};
+                accumulateRows(qr, n_samples, readRows, sample_weight);
+                return solveR(qr, solver, coef, intercept);
+            }
+        }// namespace internal
+    }// namespace linear_model
+}// namespace sklearn
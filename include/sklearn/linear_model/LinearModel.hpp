@@ -0,0 +1,108 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <np/Array.hpp>
+
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+
+namespace sklearn {
+    namespace linear_model {
+        namespace internal {
+            // out[i] = X[i] . coef + intercept for the n_samples rows of X, every row summed in Acc in the order of the
+            // features as X.dot(coef) + intercept does.
+            template<typename Acc, typename DType, typename Out>
+            void decisionRows(const DType *X, np::Size n_samples, np::Size n_features, const Acc *coef, Acc intercept, Out *out) {
+                for (np::Size i = 0; i < n_samples; ++i) {
+                    const DType *x = X + i * n_features;
+                    Acc sum{0};
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        sum += static_cast<Acc>(x[j]) * coef[j];
+                    }
+                    out[i] = static_cast<Out>(sum + intercept);
+                }
+            }
+        }// namespace internal
+
+        // The coefficients and the intercept of a fitted linear model, kept in np::float_ and in float so that
+        // predictions in either precision (see utils::Accumulation) read them as they are and allocate nothing.
+        class LinearPredictor {
+        public:
+            LinearPredictor() = default;
+
+            template<typename Iterator>
+            LinearPredictor(Iterator coef_begin, Iterator coef_end, np::float_ intercept)
+                : m_coef(coef_begin, coef_end), m_coef32(m_coef.cbegin(), m_coef.cend()), m_intercept{intercept} {
+            }
+
+            // Replaces the coefficients and the intercept, in place when the number of features does not change.
+            template<typename Iterator>
+            void assign(Iterator coef_begin, Iterator coef_end, np::float_ intercept) {
+                m_coef.assign(coef_begin, coef_end);
+                m_coef32.assign(m_coef.cbegin(), m_coef.cend());
+                m_intercept = intercept;
+            }
+
+            [[nodiscard]] np::Size n_features() const {
+                return m_coef.size();
+            }
+
+            // Predictions X * coef + intercept of the n_samples row-major samples of X into the n_samples values of
+            // out, summed in the precision chosen by accumulation. Nothing is allocated.
+            template<typename DType, typename Out>
+            void predict_into(const DType *X, np::Size n_samples, np::Size n_features, Out *out, utils::Accumulation accumulation = utils::Accumulation::kFloat64) const {
+                if (n_features != m_coef.size()) {
+                    throw std::runtime_error("X has " + std::to_string(n_features) + " features, but the model is expecting " + std::to_string(m_coef.size()) + " features as input");
+                }
+                utils::visit_accumulator<DType>(accumulation, [&](auto zero) {
+                    using Acc = decltype(zero);
+                    if constexpr (std::is_same_v<Acc, float>) {
+                        internal::decisionRows(X, n_samples, n_features, m_coef32.data(), static_cast<float>(m_intercept), out);
+                    } else {
+                        internal::decisionRows(X, n_samples, n_features, m_coef.data(), m_intercept, out);
+                    }
+                });
+            }
+
+            // Predictions for the rows of X: float32 for float32 samples, np::float_ for any other samples (see
+            // utils::result_t).
+            template<typename DType>
+            [[nodiscard]] np::Array<utils::result_t<DType>> decision_function(const utils::DenseMatrix<DType> &X, utils::Accumulation accumulation = utils::Accumulation::kFloat64) const {
+                std::vector<utils::result_t<DType>> result(X.rows());
+                predict_into(X.data(), X.rows(), X.cols(), result.data(), accumulation);
+                return np::Array<utils::result_t<DType>>{std::move(result), np::Shape{X.rows()}};
+            }
+
+        private:
+            std::vector<np::float_> m_coef;
+            std::vector<float> m_coef32;
+            np::float_ m_intercept{0};
+        };
+    }// namespace linear_model
+}// namespace sklearn
@@ -27,14 +27,22 @@ SOFTWARE.
 #include <np/Array.hpp>
 #include <np/Constants.hpp>
 #include <np/DType.hpp>
-#include <np/linalg/Inv.hpp>
 
 #include <pd/core/frame/DataFrame/DataFrame.hpp>
 #include <pd/core/frame/DataFrame/DataFrameStreamIo.hpp>
 
+#include <sklearn/linear_model/LeastSquares.hpp>
+#include <sklearn/linear_model/LinearModel.hpp>
+#include <sklearn/linear_model/SolverType.hpp>
 #include <sklearn/model_selection/train_test_split.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace sklearn {
@@ -48,8 +56,59 @@ namespace sklearn {
         */
 
         struct LinearRegressionParameters {
+            /// Solver of the least squares problem, see SolverType. All of them factorize statistics accumulated over
+            /// blocks of rows of X in place, without an explicit inverse.
+            SolverType solver{SolverType::kAuto};
+            /// Precision of the predictions for float32 samples, see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
         };
 
+        namespace internal {
+            // The state of a model solved lazily by const methods, which may run on several threads at once: the
+            // first of them that finds the model stale solves it under the mutex, the others wait for it, and once
+            // solved the check is a single atomic load. Copies get their own mutex.
+            class LazySolution {
+            public:
+                LazySolution() = default;
+
+                LazySolution(const LazySolution &other) noexcept
+                    : m_solved{other.solved()} {
+                }
+
+                LazySolution &operator=(const LazySolution &other) noexcept {
+                    m_solved.store(other.solved(), std::memory_order_release);
+                    return *this;
+                }
+
+                [[nodiscard]] bool solved() const {
+                    return m_solved.load(std::memory_order_acquire);
+                }
+
+                // Marks the model stale or solved, only from non-const methods, which must not run concurrently
+                // with other calls.
+                void reset(bool solved) {
+                    m_solved.store(solved, std::memory_order_release);
+                }
+
+                // Runs solve once if the model is stale, whatever the number of threads calling.
+                template<typename Solve>
+                void solveOnce(const Solve &solve) {
+                    if (solved()) {
+                        return;
+                    }
+                    const std::lock_guard<std::mutex> lock{m_mutex};
+                    if (!solved()) {
+                        solve();
+                        m_solved.store(true, std::memory_order_release);
+                    }
+                }
+
+            private:
+                std::atomic<bool> m_solved{true};
+                std::mutex m_mutex;
+            };
+        }// namespace internal
+
         class LinearRegression {
         public:
             explicit LinearRegression(LinearRegressionParameters parameters = {})
@@ -73,10 +132,141 @@ namespace sklearn {
                 if (X.ndim() != 2) {
                     throw std::runtime_error("2D array expected as X");
                 }
+                checkTargets(X.shape()[0], y, sample_weight);
+                fitRows(X.shape()[0], X.shape()[1], sample_weight, arrayRows(X, y));
+            }
+
+            // Fit linear model on a row-major matrix, e.g. a utils::DenseMatrix::view of the caller's data: the rows
+            // are read in place, so a large X is not copied.
+            // X - training data of shape (n_samples, n_features)
+            // y - target values of shape (n_samples,)
+            // sample_weight array of shape (n_samples,), default=None
+            template<typename DType, typename DTypeY, typename DerivedY, typename StorageY>
+            void fit(const utils::DenseMatrix<DType> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y, std::optional<np::Array<np::float_>> sample_weight = std::nullopt) {
+                checkTargets(X.rows(), y, sample_weight);
+                fitRows(X.rows(), X.cols(), sample_weight, denseRows(X, y));
+            }
+
+            // Incremental fit on a chunk of the samples, for data that does not fit in memory.
+            // The chunk is folded into centered statistics of the samples seen so far, O(n_features^2) memory whatever
+            // their number, and the model is solved from them on the first predict, coef_() or intercept_() after
+            // the call. The statistics are the Gram matrix for the cholesky solver and its R factor for the others;
+            // as the data cannot be read twice, kAuto uses qr, falling back to svd for rank deficient data.
+            // A fit discards them, the first partial_fit after a fit starts new ones.
+            // X - chunk of shape (n_chunk_samples, n_features)
+            // y - target values of shape (n_chunk_samples,)
+            // sample_weight array of shape (n_chunk_samples,), default=None
+            template<typename DType1, typename Derived1, typename Storage1, typename DType2, typename Derived2, typename Storage2>
+            void partial_fit(const np::ndarray::internal::NDArrayBase<DType1, Derived1, Storage1> &X, const np::ndarray::internal::NDArrayBase<DType2, Derived2, Storage2> &y, std::optional<np::Array<np::float_>> sample_weight = std::nullopt) {
+                if (X.ndim() != 2) {
+                    throw std::runtime_error("2D array expected as X");
+                }
+                checkTargets(X.shape()[0], y, sample_weight);
+                partialFitRows(X.shape()[0], X.shape()[1], sample_weight, arrayRows(X, y));
+            }
+
+            // Incremental fit on a chunk given as a row-major matrix, e.g. a utils::DenseMatrix::view of a buffer read
+            // from a file, see partial_fit above.
+            template<typename DType, typename DTypeY, typename DerivedY, typename StorageY>
+            void partial_fit(const utils::DenseMatrix<DType> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y, std::optional<np::Array<np::float_>> sample_weight = std::nullopt) {
+                checkTargets(X.rows(), y, sample_weight);
+                partialFitRows(X.rows(), X.cols(), sample_weight, denseRows(X, y));
+            }
+
+            // Adds the statistics another estimator accumulated by partial_fit on other samples, e.g. on another shard in
+            // another thread: the model is then the one of the samples of both. The estimators must have the same
+            // solver and number of features. The result does not depend on how the samples were split, up to rounding.
+            void merge(const LinearRegression &other) {
+                if (&other == this) {
+                    const LinearRegression copy{other};
+                    merge(copy);
+                    return;
+                }
+                if (other.m_nSamplesSeen == 0) {
+                    return;
+                }
+                if (m_parameters.solver != other.m_parameters.solver) {
+                    throw std::runtime_error("Cannot merge LinearRegression statistics of different solvers");
+                }
+                if (m_nSamplesSeen == 0) {
+                    m_gram = other.m_gram;
+                    m_qr = other.m_qr;
+                    m_nFeatures = other.m_nFeatures;
+                } else if (m_nFeatures != other.m_nFeatures) {
+                    throw std::runtime_error("Cannot merge LinearRegression statistics of different numbers of features");
+                } else if (usesGram()) {
+                    m_gram.merge(other.m_gram);
+                } else {
+                    m_qr.merge(other.m_qr);
+                }
+                m_nSamplesSeen += other.m_nSamplesSeen;
+                m_solution.reset(false);
+            }
+
+            // Predict using the linear model.
+            // X - test samples of shape (n_samples, n_features).
+            // Returns the predictions of shape (n_samples,): float32 for float32 samples, np::float_ otherwise.
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            np::Array<utils::result_t<DTypeX>> predict(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X) const {
+                checkFitted();
+                if (X.ndim() != 2) {
+                    throw std::runtime_error("Expected 2D array.");
+                }
+                return m_predictor.decision_function(utils::DenseMatrix<DTypeX>{X}, m_parameters.accumulation);
+            }
+
+            // Predict one sample without allocating, for low-latency serving.
+            // row - the n_features features of the sample
+            // out - where the prediction is written, e.g. a float or a np::float_
+            template<typename DType, typename Out>
+            void predict_into(const DType *row, np::Size n_features, Out *out) const {
+                predict_into(row, 1, n_features, out);
+            }
+
+            // Predict n_samples samples into a caller-provided buffer without allocating.
+            // Like the other const methods, it can serve from several threads at once, also right after a partial_fit
+            // or a merge: the first call solves the model under a lock, the later ones only check an atomic flag.
+            // X - the row-major samples, n_samples x n_features
+            // out - n_samples predictions
+            template<typename DType, typename Out>
+            void predict_into(const DType *X, np::Size n_samples, np::Size n_features, Out *out) const {
+                checkFitted();
+                m_predictor.predict_into(X, n_samples, n_features, out, m_parameters.accumulation);
+            }
+
+            [[nodiscard]] auto coef_() const {
+                solvePartial();
+                return m_coeff;
+            }
+
+            [[nodiscard]] auto coeffs_() const {
+                solvePartial();
+                return m_coeffs;
+            }
+
+            [[nodiscard]] auto intercept_() const {
+                solvePartial();
+                return m_intercept;
+            }
+
+            // The solver used by the last fit, with kAuto resolved.
+            [[nodiscard]] SolverType solver_() const {
+                solvePartial();
+                return m_solver;
+            }
+
+            // The number of samples seen by partial_fit since the last fit.
+            [[nodiscard]] np::Size n_samples_seen_() const {
+                return m_nSamplesSeen;
+            }
+
+        private:
+            template<typename DTypeY, typename DerivedY, typename StorageY>
+            static void checkTargets(np::Size n_samples, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y, const std::optional<np::Array<np::float_>> &sample_weight) {
                 if (y.ndim() != 1) {
                     throw std::runtime_error("1D array expected as y");
                 }
-                if (X.shape()[0] != y.shape()[0]) {
+                if (n_samples != y.shape()[0]) {
                     throw std::runtime_error("Found input variables with inconsistent numbers of samples");
                 }
                 if (sample_weight) {
@@ -87,56 +277,136 @@ namespace sklearn {
                         throw std::runtime_error("Sample weight has inconsistent number of samples");
                     }
                 }
-                np::Array<np::float_> ones{np::Shape{X.shape()[0]}, 1.0};
-                auto x = np::column_stack(ones, X);
-                auto xT = x.transpose();
-                if (!sample_weight) {
-                    m_coeffs = np::linalg::inv(xT.dot(x)).dot(xT).dot(y);
-                } else {
-                    auto W = np::diag(*sample_weight);
-                    m_coeffs = np::linalg::inv(xT.dot(W).dot(x)).dot(xT).dot(W).dot(y);
+            }
+
+            // Readers of the augmented rows (x, y) for internal::accumulateRows.
+            template<typename DTypeX, typename DerivedX, typename StorageX, typename DTypeY, typename DerivedY, typename StorageY>
+            static auto arrayRows(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y) {
+                return [&X, &y, n_features = X.shape()[1]](np::Size start, np::Size m, np::float_ *block) {
+                    for (np::Size r = 0; r < m; ++r) {
+                        const np::Size i = start + r;
+                        for (np::Size j = 0; j < n_features; ++j) {
+                            block[r * (n_features + 1) + j] = static_cast<np::float_>(X.get(i * n_features + j));
+                        }
+                        block[r * (n_features + 1) + n_features] = static_cast<np::float_>(y.get(i));
+                    }
+                };
+            }
+
+            template<typename DType, typename DTypeY, typename DerivedY, typename StorageY>
+            static auto denseRows(const utils::DenseMatrix<DType> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y) {
+                return [&X, &y, n_features = X.cols()](np::Size start, np::Size m, np::float_ *block) {
+                    for (np::Size r = 0; r < m; ++r) {
+                        const DType *x = X.row(start + r);
+                        std::copy(x, x + n_features, block + r * (n_features + 1));
+                        block[r * (n_features + 1) + n_features] = static_cast<np::float_>(y.get(start + r));
+                    }
+                };
+            }
+
+            static std::vector<np::float_> weightsOf(np::Size n_samples, const std::optional<np::Array<np::float_>> &sample_weight) {
+                std::vector<np::float_> weights;
+                if (sample_weight) {
+                    weights.resize(n_samples);
+                    for (np::Size i = 0; i < n_samples; ++i) {
+                        weights[i] = sample_weight->get(i);
+                    }
                 }
-                m_coeff = m_coeffs["1:"];
-                m_intercept = m_coeffs.get(0);
+                return weights;
+            }
 
-                m_fitted = true;
+            // Solves the least squares problem on the augmented rows produced by readRows, see
+            // internal::leastSquares. The weights are copied once into a contiguous buffer, O(n_samples) memory.
+            template<typename ReadRows>
+            void fitRows(np::Size n_samples, np::Size n_features, const std::optional<np::Array<np::float_>> &sample_weight, const ReadRows &readRows) {
+                const auto weights = weightsOf(n_samples, sample_weight);
+                std::vector<np::float_> coef;
+                np::float_ intercept{0};
+                const auto solver = internal::leastSquares(n_samples, n_features, m_parameters.solver, readRows, sample_weight ? weights.data() : nullptr, coef, intercept);
+                m_nSamplesSeen = 0;
+                m_gram = internal::GramStatistics{};
+                m_qr = internal::QrStatistics{};
+                m_nFeatures = n_features;
+                setCoefficients(coef, intercept, solver);
+                m_solution.reset(true);
             }
 
-            // Predict using the linear model.
-            // X - test samples.
-            auto predict(const auto &X) {
-                if (!m_fitted) {
-                    throw std::runtime_error(
-                            "This LinearRegression instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
+            template<typename ReadRows>
+            void partialFitRows(np::Size n_samples, np::Size n_features, const std::optional<np::Array<np::float_>> &sample_weight, const ReadRows &readRows) {
+                if (m_nSamplesSeen == 0) {
+                    m_gram = internal::GramStatistics{usesGram() ? n_features + 1 : 0};
+                    m_qr = internal::QrStatistics{usesGram() ? 0 : n_features + 1};
+                    m_nFeatures = n_features;
+                } else if (n_features != m_nFeatures) {
+                    throw std::runtime_error("X has " + std::to_string(n_features) + " features, but LinearRegression is expecting " + std::to_string(m_nFeatures) + " features as input");
                 }
-                if (X.ndim() != 2) {
-                    throw std::runtime_error("Expected 2D array.");
+                const auto weights = weightsOf(n_samples, sample_weight);
+                if (usesGram()) {
+                    internal::accumulateRows(m_gram, n_samples, readRows, sample_weight ? weights.data() : nullptr);
+                } else {
+                    internal::accumulateRows(m_qr, n_samples, readRows, sample_weight ? weights.data() : nullptr);
                 }
-                return forwardStep(X);
+                m_nSamplesSeen += n_samples;
+                m_solution.reset(false);
             }
 
-            [[nodiscard]] auto coef_() const {
-                return m_coeff;
+            [[nodiscard]] bool usesGram() const {
+                return m_parameters.solver == SolverType::kCholesky;
             }
 
-            [[nodiscard]] auto coeffs_() const {
-                return m_coeffs;
+            // Solves the model from the statistics of partial_fit if they changed since the last solution, once for
+            // all the threads calling, see internal::LazySolution.
+            void solvePartial() const {
+                m_solution.solveOnce([this] {
+                    if (m_nSamplesSeen == 0) {
+                        return;
+                    }
+                    std::vector<np::float_> coef;
+                    np::float_ intercept{0};
+                    auto solver = SolverType::kCholesky;
+                    if (usesGram()) {
+                        internal::solveGram(m_gram, true, coef, intercept);
+                    } else {
+                        solver = internal::solveR(m_qr, m_parameters.solver, coef, intercept);
+                    }
+                    setCoefficients(coef, intercept, solver);
+                });
             }
 
-            [[nodiscard]] auto intercept_() const {
-                return m_intercept;
+            void checkFitted() const {
+                solvePartial();
+                if (!m_fitted) {
+                    throw std::runtime_error(
+                            "This LinearRegression instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
+                }
             }
 
-        private:
-            auto forwardStep(const auto &X) {
-                return X.dot(m_coeff).add(m_intercept);
+            void setCoefficients(const std::vector<np::float_> &coef, np::float_ intercept, SolverType solver) const {
+                std::vector<np::float_> coeffs{intercept};
+                coeffs.insert(coeffs.end(), coef.cbegin(), coef.cend());
+                m_coeffs = np::Array<np::float_>{coeffs, np::Shape{coeffs.size()}};
+                m_coeff = m_coeffs["1:"];
+                m_intercept = intercept;
+                m_predictor = LinearPredictor{coef.cbegin(), coef.cend(), intercept};
+                m_solver = solver;
+                m_fitted = true;
             }
 
             LinearRegressionParameters m_parameters;
-            bool m_fitted{false};
-            np::ndarray::array_dynamic::NDArrayDynamicIndexKeyType<np::float_> m_coeff;
-            np::Array<np::float_> m_coeffs;
-            np::float_ m_intercept;
+            np::Size m_nFeatures{0};
+            // Statistics of the partial_fit calls since the last fit, only the ones of the solver are used.
+            np::Size m_nSamplesSeen{0};
+            internal::GramStatistics m_gram;
+            internal::QrStatistics m_qr;
+            // The model, solved by fit or lazily from the statistics: the first call that needs it after a partial_fit
+            // or a merge updates these members under the lock of m_solution.
+            mutable internal::LazySolution m_solution;
+            mutable bool m_fitted{false};
+            mutable SolverType m_solver{SolverType::kAuto};
+            mutable np::ndarray::array_dynamic::NDArrayDynamicIndexKeyType<np::float_> m_coeff;
+            mutable np::Array<np::float_> m_coeffs;
+            mutable LinearPredictor m_predictor;
+            mutable np::float_ m_intercept;
         };
 
     }// namespace linear_model
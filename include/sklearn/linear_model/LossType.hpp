@@ -0,0 +1,38 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+namespace sklearn {
+    namespace linear_model {
+        enum class LossType {
+            // ordinary least squares, 0.5 (y - p)^2
+            kSquaredError,
+            // squared error up to a distance epsilon, linear beyond it, less sensitive to outliers
+            kHuber,
+            // ignores errors below epsilon, linear beyond it, as in support vector regression
+            kEpsilonInsensitive,
+            // ignores errors below epsilon, squared beyond it
+            kSquaredEpsilonInsensitive
+        };
+    }
+}// namespace sklearn
@@ -21,7 +21,6 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
-
 #pragma once
 
 #include <np/Array.hpp>
@@ -31,9 +30,22 @@ SOFTWARE.
 #include <pd/core/frame/DataFrame/DataFrame.hpp>
 #include <pd/core/frame/DataFrame/DataFrameStreamIo.hpp>
 
+#include <sklearn/linear_model/LearningRateType.hpp>
+#include <sklearn/linear_model/LinearModel.hpp>
+#include <sklearn/linear_model/LossType.hpp>
+#include <sklearn/linear_model/PenaltyType.hpp>
 #include <sklearn/model_selection/train_test_split.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace sklearn {
@@ -49,8 +61,83 @@ namespace sklearn {
         */
 
         struct SGDRegressorParameters {
+            /// The loss function to be minimized, see LossType.
+            LossType loss{LossType::kSquaredError};
+            /// The regularization term, see PenaltyType.
+            PenaltyType penalty{PenaltyType::kL2};
+            /// Constant that multiplies the regularization term, also used by the optimal learning rate.
+            np::float_ alpha{0.0001};
+            /// The Elastic Net mixing parameter, the share of L1 in the penalty, only used by kElasticNet.
+            np::float_ l1_ratio{0.15};
+            /// The maximum number of passes over the training data (epochs).
+            np::Size max_iter{1000};
+            /// The stopping criterion: training stops when the training loss, or the validation score with early_stopping,
+            /// does not improve by tol for n_iter_no_change epochs in a row. std::nullopt runs max_iter epochs.
+            std::optional<np::float_> tol{1e-3};
+            /// Whether the training data is shuffled before every epoch.
+            bool shuffle{true};
+            /// Distance below which the huber and epsilon-insensitive losses treat the errors differently.
+            np::float_ epsilon{0.1};
+            /// Seed of the shuffling and of the validation split.
+            unsigned random_state{42};
+            /// The learning rate schedule, see LearningRateType.
+            LearningRateType learning_rate{LearningRateType::kInvscaling};
+            /// The initial learning rate of the constant, invscaling and adaptive schedules.
+            np::float_ eta0{0.01};
+            /// The exponent of the invscaling schedule.
+            np::float_ power_t{0.25};
+            /// Whether validation_fraction of the training data is set aside, and training stops on its R^2 score.
+            bool early_stopping{false};
+            /// The share of the training data set aside for early_stopping.
+            np::float_ validation_fraction{0.1};
+            /// Number of epochs with no improvement to wait before stopping, or before dividing an adaptive learning rate.
+            np::Size n_iter_no_change{5};
+            /// Number of samples per update: 1 updates the model after every sample, larger batches average the
+            /// gradients of batch_size samples into one update.
+            np::Size batch_size{1};
+            /// Averaged SGD: 0 uses the coefficients of the last update, n >= 1 makes coef_ and intercept_ the average of
+            /// the coefficients after every update from the n-th on, 1 averages all the updates.
+            np::Size average{0};
+            /// Precision of the predictions for float32 samples, see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
         };
 
+        namespace internal {
+            // The loss of the prediction p of the target y.
+            inline np::float_ sgdLoss(LossType loss, np::float_ epsilon, np::float_ y, np::float_ p) {
+                const np::float_ r = p - y;
+                switch (loss) {
+                    case LossType::kSquaredError:
+                        return 0.5 * r * r;
+                    case LossType::kHuber:
+                        return std::abs(r) <= epsilon ? 0.5 * r * r : epsilon * std::abs(r) - 0.5 * epsilon * epsilon;
+                    case LossType::kEpsilonInsensitive:
+                        return std::max(0.0, std::abs(r) - epsilon);
+                    case LossType::kSquaredEpsilonInsensitive: {
+                        const np::float_ e = std::max(0.0, std::abs(r) - epsilon);
+                        return e * e;
+                    }
+                }
+                return 0.0;
+            }
+
+            // The derivative of the loss by the prediction p.
+            inline np::float_ sgdDLoss(LossType loss, np::float_ epsilon, np::float_ y, np::float_ p) {
+                const np::float_ r = p - y;
+                switch (loss) {
+                    case LossType::kSquaredError:
+                        return r;
+                    case LossType::kHuber:
+                        return std::abs(r) <= epsilon ? r : (r > 0.0 ? epsilon : -epsilon);
+                    case LossType::kEpsilonInsensitive:
+                        return r > epsilon ? 1.0 : (r < -epsilon ? -1.0 : 0.0);
+                    case LossType::kSquaredEpsilonInsensitive:
+                        return r > epsilon ? 2.0 * (r - epsilon) : (r < -epsilon ? 2.0 * (r + epsilon) : 0.0);
+                }
+                return 0.0;
+            }
+        }// namespace internal
+
         template<typename ArrayDataType = np::Array<np::float_>, typename ArrayTargetType = ArrayDataType>
         class SGDRegressor {
         public:
@@ -70,71 +157,398 @@ namespace sklearn {
             // X - training data
             // y - target values
             void fit(const ArrayDataType &X, const ArrayTargetType &y) {
-                // initialize m_coeff and m_intercept randomly
-                m_coeff = np::zeros(np::Shape{X.shape()[1]});
-                m_intercept = 0.0;
+                if (X.ndim() != 2) {
+                    throw std::runtime_error("2D array expected as X");
+                }
+                fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Fit linear model on a row-major matrix, e.g. a utils::DenseMatrix::view of the caller's data, which is
+            // read in place.
+            // X - training data of shape (n_samples, n_features)
+            // y - target values of shape (n_samples,)
+            template<typename DType, typename DTypeY, typename DerivedY, typename StorageY>
+            void fit(const utils::DenseMatrix<DType> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y) {
+                checkParameters();
+                std::vector<np::float_> targets;
+                readTargets(X.rows(), y, targets);
+                initialize(X.cols());
 
-                for (std::size_t i = 0; i < m_iterations; ++i) {
-                    auto pred = forwardStep(X);
-                    auto derivatives = backPropagation(X, y, pred);
-                    if (!updateCoeff(derivatives))
-                        break;
+                std::vector<np::Size> order;
+                identityOrder(X.rows(), order);
+                np::Size n_train = X.rows();
+                if (m_parameters.early_stopping) {
+                    // The validation samples are a random validation_fraction of the rows, moved to the end of order.
+                    const auto n_validation = static_cast<np::Size>(std::ceil(m_parameters.validation_fraction * static_cast<np::float_>(X.rows())));
+                    if (n_validation == 0 || n_validation >= X.rows()) {
+                        throw std::runtime_error("The validation_fraction leaves an empty training or validation set");
+                    }
+                    shuffleOrder(order.data(), order.size());
+                    n_train -= n_validation;
                 }
 
-                m_fitted = true;
+                np::float_ best_loss = std::numeric_limits<np::float_>::infinity();
+                np::float_ best_score = -std::numeric_limits<np::float_>::infinity();
+                np::Size no_improvement = 0;
+                m_nIter = 0;
+                while (m_nIter < m_parameters.max_iter) {
+                    if (m_parameters.shuffle) {
+                        shuffleOrder(order.data(), n_train);
+                    }
+                    const auto loss = epoch(X, targets.data(), order.data(), n_train);
+                    ++m_nIter;
+                    checkFinite(loss);
+                    const auto tol = m_parameters.tol.value_or(-std::numeric_limits<np::float_>::infinity());
+                    bool improved = true;
+                    if (m_parameters.early_stopping) {
+                        const auto score = validationScore(X, targets.data(), order.data() + n_train, X.rows() - n_train);
+                        improved = score > best_score + tol;
+                        best_score = std::max(best_score, score);
+                    } else {
+                        improved = loss < best_loss - tol * static_cast<np::float_>(n_train);
+                        best_loss = std::min(best_loss, loss);
+                    }
+                    no_improvement = improved ? 0 : no_improvement + 1;
+                    if (no_improvement >= m_parameters.n_iter_no_change) {
+                        if (m_parameters.learning_rate == LearningRateType::kAdaptive && m_eta > 1e-6) {
+                            m_eta /= 5.0;
+                            no_improvement = 0;
+                        } else {
+                            break;
+                        }
+                    }
+                }
+                updatePredictor();
+            }
+
+            // Online learning: one epoch over the samples of X, continuing from the coefficients, the learning rate, the
+            // update count t_ and the averages of the previous fit or partial_fit calls. The first call on an unfitted
+            // estimator starts from zero coefficients. There is no stopping rule, n_iter_() is 1 after the call.
+            // The model state is updated in place, so a call costs O(n_samples * n_features) and, once the scratch
+            // buffers of the targets and of the order grew to the largest batch, allocates nothing for a DenseMatrix
+            // view; arrays are copied into a DenseMatrix first.
+            // X - batch of shape (n_batch_samples, n_features)
+            // y - target values of shape (n_batch_samples,)
+            void partial_fit(const ArrayDataType &X, const ArrayTargetType &y) {
+                if (X.ndim() != 2) {
+                    throw std::runtime_error("2D array expected as X");
+                }
+                partial_fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Online learning on a batch given as a row-major matrix, e.g. a utils::DenseMatrix::view of a buffer of
+            // events, see partial_fit above.
+            template<typename DType, typename DTypeY, typename DerivedY, typename StorageY>
+            void partial_fit(const utils::DenseMatrix<DType> &X, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y) {
+                checkParameters();
+                if (!m_fitted) {
+                    initialize(X.cols());
+                } else if (X.cols() != m_coef.size()) {
+                    throw std::runtime_error("X has " + std::to_string(X.cols()) + " features, but SGDRegressor is expecting " + std::to_string(m_coef.size()) + " features as input");
+                }
+                readTargets(X.rows(), y, m_targets);
+                identityOrder(X.rows(), m_order);
+                if (m_parameters.shuffle) {
+                    shuffleOrder(m_order.data(), m_order.size());
+                }
+                m_nIter = 1;
+                checkFinite(epoch(X, m_targets.data(), m_order.data(), m_order.size()));
+                updatePredictor();
             }
 
             // Predict using the linear model.
-            // X - test samples.
-            auto predict(const auto &X) {
+            // X - test samples of shape (n_samples, n_features).
+            // Returns the predictions of shape (n_samples,): float32 for float32 samples, np::float_ otherwise.
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            np::Array<utils::result_t<DTypeX>> predict(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X) const {
                 if (!m_fitted) {
                     throw std::runtime_error(
-                            "This LinearRegression instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
+                            "This SGDRegressor instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
                 }
                 if (X.ndim() != 2) {
                     throw std::runtime_error("Expected 2D array.");
                 }
-                return forwardStep(X);
+                return m_predictor.decision_function(utils::DenseMatrix<DTypeX>{X}, m_parameters.accumulation);
+            }
+
+            // Predict one sample without allocating, for low-latency serving.
+            // row - the n_features features of the sample
+            // out - where the prediction is written, e.g. a float or a np::float_
+            template<typename DType, typename Out>
+            void predict_into(const DType *row, np::Size n_features, Out *out) const {
+                predict_into(row, 1, n_features, out);
+            }
+
+            // Predict n_samples samples into a caller-provided buffer without allocating.
+            // X - the row-major samples, n_samples x n_features
+            // out - n_samples predictions
+            template<typename DType, typename Out>
+            void predict_into(const DType *X, np::Size n_samples, np::Size n_features, Out *out) const {
+                if (!m_fitted) {
+                    throw std::runtime_error(
+                            "This SGDRegressor instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
+                }
+                m_predictor.predict_into(X, n_samples, n_features, out, m_parameters.accumulation);
             }
 
+            // The coefficients, averaged when average is set and the average started.
             [[nodiscard]] np::Array<np::float_> coef_() const {
-                return m_coeff;
+                return np::Array<np::float_>{modelCoef(), np::Shape{m_coef.size()}};
             }
 
             [[nodiscard]] np::float_ intercept_() const {
-                return m_intercept;
+                return modelIntercept();
+            }
+
+            // The number of epochs run by the last fit or partial_fit.
+            [[nodiscard]] np::Size n_iter_() const {
+                return m_nIter;
+            }
+
+            // The number of updates made plus one, the t of the optimal and invscaling learning rates.
+            [[nodiscard]] np::float_ t_() const {
+                return m_t;
             }
 
         private:
-            struct Derivatives {
-                np::Array<np::float_> coeff;
-                np::float_ intercept{0.0};
-            };
+            void checkParameters() const {
+                if (m_parameters.alpha < 0.0) {
+                    throw std::runtime_error("alpha must be >= 0");
+                }
+                if (m_parameters.l1_ratio < 0.0 || m_parameters.l1_ratio > 1.0) {
+                    throw std::runtime_error("l1_ratio must be in [0, 1]");
+                }
+                if (m_parameters.learning_rate == LearningRateType::kOptimal && m_parameters.alpha == 0.0) {
+                    throw std::runtime_error("alpha must be > 0 since learning_rate is 'optimal'. alpha is used to compute the optimal learning rate.");
+                }
+                if (m_parameters.learning_rate != LearningRateType::kOptimal && m_parameters.eta0 <= 0.0) {
+                    throw std::runtime_error("eta0 must be > 0");
+                }
+                if (m_parameters.batch_size == 0) {
+                    throw std::runtime_error("batch_size must be >= 1");
+                }
+                if (m_parameters.n_iter_no_change == 0) {
+                    throw std::runtime_error("n_iter_no_change must be >= 1");
+                }
+            }
+
+            // Starts the optimization: zero coefficients and averages, the initial learning rate and the generator
+            // seeded with random_state.
+            void initialize(np::Size n_features) {
+                m_coef.assign(n_features, 0.0);
+                m_intercept = 0.0;
+                m_t = 1.0;
+                m_eta = m_parameters.eta0;
+                m_cumulativeL1 = 0.0;
+                m_appliedL1.assign(n_features, 0.0);
+                m_gradient.assign(n_features, 0.0);
+                m_averageCoef.assign(n_features, 0.0);
+                m_averageIntercept = 0.0;
+                m_nAveraged = 0;
+                m_generator.seed(m_parameters.random_state);
+            }
+
+            // Copies y into targets, which keeps its capacity between calls.
+            template<typename DTypeY, typename DerivedY, typename StorageY>
+            static void readTargets(np::Size n_samples, const np::ndarray::internal::NDArrayBase<DTypeY, DerivedY, StorageY> &y, std::vector<np::float_> &targets) {
+                if (y.ndim() != 1) {
+                    throw std::runtime_error("1D array expected as y");
+                }
+                if (y.shape()[0] != n_samples) {
+                    throw std::runtime_error("Found input variables with inconsistent numbers of samples");
+                }
+                targets.resize(n_samples);
+                for (np::Size i = 0; i < n_samples; ++i) {
+                    targets[i] = static_cast<np::float_>(y.get(i));
+                }
+            }
+
+            static void identityOrder(np::Size n_samples, std::vector<np::Size> &order) {
+                order.resize(n_samples);
+                for (np::Size i = 0; i < n_samples; ++i) {
+                    order[i] = i;
+                }
+            }
+
+            void checkFinite(np::float_ loss) const {
+                if (!std::isfinite(loss)) {
+                    throw std::runtime_error("Floating-point under-/overflow occurred at epoch #" + std::to_string(m_nIter) + ". Scaling input data with StandardScaler or MinMaxScaler might help.");
+                }
+            }
+
+            // The coefficients of the model: the averages once averaging started, the last update otherwise.
+            [[nodiscard]] const std::vector<np::float_> &modelCoef() const {
+                return m_nAveraged > 0 ? m_averageCoef : m_coef;
+            }
+
+            [[nodiscard]] np::float_ modelIntercept() const {
+                return m_nAveraged > 0 ? m_averageIntercept : m_intercept;
+            }
+
+            void updatePredictor() {
+                m_predictor.assign(modelCoef().cbegin(), modelCoef().cend(), modelIntercept());
+                m_fitted = true;
+            }
+
+            // Fisher-Yates shuffle of the first n entries of order, on the raw output of the Mersenne twister, so that a
+            // random_state gives the same order with every standard library.
+            void shuffleOrder(np::Size *order, np::Size n) {
+                for (np::Size i = n; i > 1; --i) {
+                    std::swap(order[i - 1], order[m_generator() % i]);
+                }
+            }
 
-            auto forwardStep(const ArrayDataType &X) {
-                auto d = X.dot(m_coeff);
-                return d.add(m_intercept);
+            // The share of L1 in the penalty.
+            [[nodiscard]] np::float_ l1Ratio() const {
+                switch (m_parameters.penalty) {
+                    case PenaltyType::kNone:
+                    case PenaltyType::kL2:
+                        return 0.0;
+                    case PenaltyType::kL1:
+                        return 1.0;
+                    case PenaltyType::kElasticNet:
+                        return m_parameters.l1_ratio;
+                }
+                return 0.0;
             }
 
-            Derivatives backPropagation(const ArrayDataType &trainInput, const ArrayTargetType &trainOutput, const auto &pred) {
-                auto df = pred.subtract(trainOutput);
-                return Derivatives{trainInput.transpose().dot(df).divide(trainInput.shape()[0]), df.sum() / trainInput.shape()[0]};
+            // The learning rate of the update number m_t.
+            [[nodiscard]] np::float_ learningRate() const {
+                switch (m_parameters.learning_rate) {
+                    case LearningRateType::kConstant:
+                    case LearningRateType::kAdaptive:
+                        return m_eta;
+                    case LearningRateType::kOptimal: {
+                        // t0 makes the first rate about the one of a weight vector of norm 1 / sqrt(alpha), as in
+                        // Leon Bottou's sgd.
+                        const auto alpha = m_parameters.alpha;
+                        const auto typw = std::sqrt(1.0 / std::sqrt(alpha));
+                        const auto initial_eta0 = typw / std::max(1.0, internal::sgdDLoss(m_parameters.loss, m_parameters.epsilon, 1.0, -typw));
+                        const auto optimal_init = 1.0 / (initial_eta0 * alpha);
+                        return 1.0 / (alpha * (optimal_init + m_t - 1.0));
+                    }
+                    case LearningRateType::kInvscaling:
+                        return m_parameters.eta0 / std::pow(m_t, m_parameters.power_t);
+                }
+                return m_eta;
             }
 
-            bool updateCoeff(const Derivatives &derivatives) {
-                auto delta = derivatives.coeff.multiply(m_learningRate);
-                m_coeff = m_coeff.subtract(delta);
-                m_intercept -= derivatives.intercept * m_learningRate;
-                return true;
+            // One pass over the rows order[0, n) in batches of batch_size rows: the gradient of the batch, taken at the
+            // coefficients before the batch, is averaged and the coefficients are updated in place. Returns the sum of
+            // the losses of the rows before their updates.
+            template<typename DType>
+            np::float_ epoch(const utils::DenseMatrix<DType> &X, const np::float_ *y, const np::Size *order, np::Size n) {
+                constexpr np::float_ kMaxDLoss = 1e12;
+                const np::Size n_features = X.cols();
+                const auto l1_ratio = l1Ratio();
+                const bool penalized = m_parameters.penalty != PenaltyType::kNone && m_parameters.alpha > 0.0;
+                np::float_ sum_loss{0};
+                for (np::Size begin = 0; begin < n; begin += m_parameters.batch_size) {
+                    const np::Size end = std::min(n, begin + m_parameters.batch_size);
+                    std::fill(m_gradient.begin(), m_gradient.end(), 0.0);
+                    np::float_ gradient_intercept{0};
+                    for (np::Size b = begin; b < end; ++b) {
+                        const DType *x = X.row(order[b]);
+                        np::float_ p = m_intercept;
+                        for (np::Size j = 0; j < n_features; ++j) {
+                            p += m_coef[j] * static_cast<np::float_>(x[j]);
+                        }
+                        sum_loss += internal::sgdLoss(m_parameters.loss, m_parameters.epsilon, y[order[b]], p);
+                        const auto dloss = std::clamp(internal::sgdDLoss(m_parameters.loss, m_parameters.epsilon, y[order[b]], p), -kMaxDLoss, kMaxDLoss);
+                        if (dloss != 0.0) {
+                            for (np::Size j = 0; j < n_features; ++j) {
+                                m_gradient[j] += dloss * static_cast<np::float_>(x[j]);
+                            }
+                            gradient_intercept += dloss;
+                        }
+                    }
+                    const auto eta = learningRate();
+                    const auto step = eta / static_cast<np::float_>(end - begin);
+                    // The L2 part shrinks the coefficients, the L1 part is applied below by truncation.
+                    const auto shrink = penalized ? std::max(0.0, 1.0 - (1.0 - l1_ratio) * eta * m_parameters.alpha) : 1.0;
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        m_coef[j] = shrink * m_coef[j] - step * m_gradient[j];
+                    }
+                    m_intercept -= step * gradient_intercept;
+                    if (penalized && l1_ratio > 0.0) {
+                        applyL1(l1_ratio * eta * m_parameters.alpha);
+                    }
+                    if (m_parameters.average > 0 && m_t >= static_cast<np::float_>(m_parameters.average)) {
+                        // Running mean of the coefficients after the updates since the average-th.
+                        ++m_nAveraged;
+                        const auto weight = 1.0 / static_cast<np::float_>(m_nAveraged);
+                        for (np::Size j = 0; j < n_features; ++j) {
+                            m_averageCoef[j] += weight * (m_coef[j] - m_averageCoef[j]);
+                        }
+                        m_averageIntercept += weight * (m_intercept - m_averageIntercept);
+                    }
+                    m_t += 1.0;
+                }
+                return sum_loss;
+            }
+
+            // Cumulative L1 penalty of Tsuruoka, Tsujii and Ananiadou (2009): every coefficient is moved towards zero by
+            // the total penalty so far minus what it already received, and stops at zero instead of crossing it.
+            void applyL1(np::float_ penalty) {
+                m_cumulativeL1 += penalty;
+                for (np::Size j = 0; j < m_coef.size(); ++j) {
+                    const auto w = m_coef[j];
+                    if (w > 0.0) {
+                        m_coef[j] = std::max(0.0, w - (m_cumulativeL1 + m_appliedL1[j]));
+                    } else if (w < 0.0) {
+                        m_coef[j] = std::min(0.0, w + (m_cumulativeL1 - m_appliedL1[j]));
+                    }
+                    m_appliedL1[j] += m_coef[j] - w;
+                }
+            }
+
+            // The R^2 score of the model coefficients on the rows order[0, n).
+            template<typename DType>
+            np::float_ validationScore(const utils::DenseMatrix<DType> &X, const np::float_ *y, const np::Size *order, np::Size n) const {
+                np::float_ mean{0};
+                for (np::Size i = 0; i < n; ++i) {
+                    mean += y[order[i]];
+                }
+                mean /= static_cast<np::float_>(n);
+                const auto &coef = modelCoef();
+                np::float_ residuals{0};
+                np::float_ total{0};
+                for (np::Size i = 0; i < n; ++i) {
+                    const DType *x = X.row(order[i]);
+                    np::float_ p = modelIntercept();
+                    for (np::Size j = 0; j < X.cols(); ++j) {
+                        p += coef[j] * static_cast<np::float_>(x[j]);
+                    }
+                    residuals += (y[order[i]] - p) * (y[order[i]] - p);
+                    total += (y[order[i]] - mean) * (y[order[i]] - mean);
+                }
+                if (total == 0.0) {
+                    return residuals == 0.0 ? 1.0 : 0.0;
+                }
+                return 1.0 - residuals / total;
             }
 
             SGDRegressorParameters m_parameters;
             bool m_fitted{false};
-            np::Array<np::float_> m_coeff;
+            std::vector<np::float_> m_coef;
             np::float_ m_intercept;
-
-            constexpr static const std::size_t m_iterations = 1000;
-            constexpr static const np::float_ m_learningRate = 0.001;
+            LinearPredictor m_predictor;
+            np::Size m_nIter{0};
+            // The state of the optimization, carried over by partial_fit: the update count, the adaptive learning rate,
+            // the cumulative L1 penalty and the part of it every coefficient received, the averages and the number of
+            // updates in them, the gradient of a batch and the shuffling generator.
+            np::float_ m_t{1.0};
+            np::float_ m_eta{0.0};
+            np::float_ m_cumulativeL1{0.0};
+            std::vector<np::float_> m_appliedL1;
+            std::vector<np::float_> m_averageCoef;
+            np::float_ m_averageIntercept{0.0};
+            np::Size m_nAveraged{0};
+            std::vector<np::float_> m_gradient;
+            std::mt19937 m_generator;
+            // Scratch buffers of partial_fit, reused from call to call.
+            std::vector<np::float_> m_targets;
+            std::vector<np::Size> m_order;
         };
 
     }// namespace linear_model
@@ -22,19 +22,58 @@ SOFTWARE.
 
 #pragma once
 
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <np/Array.hpp>
 
+#include <sklearn/utils/Accumulation.hpp>
+
 namespace sklearn {
     namespace metrics {
+        // The element type of the distances between the rows of ArrayX: float32 data give float32 distances, any other
+        // data np::float_ ones.
+        template<typename ArrayX>
+        using distance_t = utils::result_t<std::remove_cvref_t<decltype(std::declval<const ArrayX &>().get(0))>>;
+
+        namespace internal {
+            // The row-major distances summed in Acc as an array of T, moved if the types are the same.
+            template<typename T, typename Acc>
+            np::Array<T> toArray(std::vector<Acc> &&result, np::Shape shape) {
+                if constexpr (std::is_same_v<T, Acc>) {
+                    return np::Array<T>{std::move(result), shape};
+                } else {
+                    return np::Array<T>{std::vector<T>(result.cbegin(), result.cend()), shape};
+                }
+            }
+        }// namespace internal
+
+        // Pairwise distances between the rows of 2D arrays, of type distance_t<ArrayX>.
+        // accumulation - precision of the sums on float32 data, see utils::Accumulation.
         template<typename ArrayX, typename ArrayY = ArrayX>
         class Distance {
         public:
+            using DType = distance_t<ArrayX>;
+
+            explicit Distance(utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : m_accumulation{accumulation} {
+            }
+
             virtual ~Distance() = default;
-            virtual np::Array<np::float_> pairwise(const ArrayX &X) = 0;
-            virtual np::Array<np::float_> pairwise(const ArrayX &X, const ArrayY &Y) = 0;
+            virtual np::Array<DType> pairwise(const ArrayX &X) = 0;
+            virtual np::Array<DType> pairwise(const ArrayX &X, const ArrayY &Y) = 0;
+
+            [[nodiscard]] utils::Accumulation accumulation() const {
+                return m_accumulation;
+            }
+
+        private:
+            utils::Accumulation m_accumulation;
         };
 
         template<typename ArrayX, typename ArrayY = ArrayX>
         using DistancePtr = std::shared_ptr<Distance<ArrayX, ArrayY>>;
     }// namespace metrics
-}// namespace sklearn
\ No newline at end of file
+}// namespace sklearn
@@ -0,0 +1,248 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <np/Array.hpp>
+
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+
+namespace sklearn {
+    namespace metrics {
+        namespace internal {
+            // x^p for a positive integer p by repeated squaring and multiplication, exact where std::pow is slow.
+            template<typename T>
+            T powInt(T x, int p) {
+                T result{1};
+                while (p > 0) {
+                    if (p & 1) {
+                        result *= x;
+                    }
+                    x *= x;
+                    p >>= 1;
+                }
+                return result;
+            }
+
+            // Reduced distance functors, one per specialized form of the Minkowski metric.
+            // accumulate(rdist, delta) adds one coordinate difference to a reduced distance, in the type of its
+            // arguments, operator() reduces two rows in np::float_ and reduce<Acc> in Acc.
+            template<typename Derived>
+            struct Rdist {
+                template<typename Acc, typename DTypeX, typename DTypeY>
+                Acc reduce(const DTypeX *x, const DTypeY *y, np::Size size) const {
+                    Acc result{0};
+                    for (np::Size i = 0; i < size; ++i) {
+                        result = static_cast<const Derived &>(*this).accumulate(result, static_cast<Acc>(x[i]) - static_cast<Acc>(y[i]));
+                    }
+                    return result;
+                }
+
+                template<typename DTypeX, typename DTypeY>
+                np::float_ operator()(const DTypeX *x, const DTypeY *y, np::Size size) const {
+                    return reduce<np::float_>(x, y, size);
+                }
+            };
+
+            struct ManhattanRdist : Rdist<ManhattanRdist> {
+                template<typename T>
+                [[nodiscard]] T accumulate(T rdist, T delta) const {
+                    return rdist + std::abs(delta);
+                }
+            };
+
+            struct EuclideanRdist : Rdist<EuclideanRdist> {
+                template<typename T>
+                [[nodiscard]] T accumulate(T rdist, T delta) const {
+                    return rdist + delta * delta;
+                }
+            };
+
+            struct ChebyshevRdist : Rdist<ChebyshevRdist> {
+                template<typename T>
+                [[nodiscard]] T accumulate(T rdist, T delta) const {
+                    return std::max(rdist, std::abs(delta));
+                }
+            };
+
+            struct IntegerRdist : Rdist<IntegerRdist> {
+                explicit IntegerRdist(int p) : p{p} {
+                }
+
+                template<typename T>
+                [[nodiscard]] T accumulate(T rdist, T delta) const {
+                    return rdist + powInt(std::abs(delta), p);
+                }
+
+                int p;
+            };
+
+            struct GeneralRdist : Rdist<GeneralRdist> {
+                explicit GeneralRdist(np::float_ p) : p{p} {
+                }
+
+                template<typename T>
+                [[nodiscard]] T accumulate(T rdist, T delta) const {
+                    return rdist + static_cast<T>(std::pow(std::abs(delta), static_cast<T>(p)));
+                }
+
+                np::float_ p;
+            };
+        }// namespace internal
+
+        // Distance between two contiguous rows.
+        // Every supported metric belongs to the Minkowski family, so a kernel is fully described by the power p >= 1:
+        // p = 1 - manhattan, p = 2 - euclidean, p = inf - chebyshev, any other p - sum(|x - y|^p)^(1/p).
+        // rdist (reduced distance) is a cheaper rank-preserving form of the distance: sum(|x - y|^p) for finite p
+        // and max(|x - y|) for p = inf. Neighbor searches compare rdist values and convert only the final results.
+        // p = 1, 2 and inf have their own loops, other integer p are computed by multiplication, only fractional p
+        // call std::pow per coordinate.
+        // accumulation - precision of the tiled kernels (pairwise distances, brute force search) on float32 data,
+        // see pairwise_distances_reduction. Distances of single pairs (rdist, dist) are always summed in np::float_.
+        class DistanceKernel {
+        public:
+            explicit DistanceKernel(DistanceMetricType type = DistanceMetricType::kMinkowski, np::float_ p = 2, utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : m_accumulation{accumulation} {
+                switch (type) {
+                    case DistanceMetricType::kEuclidean:
+                        m_p = 2;
+                        break;
+                    case DistanceMetricType::kManhattan:
+                        m_p = 1;
+                        break;
+                    case DistanceMetricType::kChebyshev:
+                        m_p = std::numeric_limits<np::float_>::infinity();
+                        break;
+                    case DistanceMetricType::kMinkowski:
+                        if (!(p >= 1)) {
+                            throw std::runtime_error("p must be greater or equal to 1");
+                        }
+                        m_p = p;
+                        break;
+                    default:
+                        throw std::runtime_error("Unknown metric type");
+                }
+                if (m_p == 1) {
+                    m_kind = Kind::kManhattan;
+                } else if (m_p == 2) {
+                    m_kind = Kind::kEuclidean;
+                } else if (std::isinf(m_p)) {
+                    m_kind = Kind::kChebyshev;
+                } else if (m_p == std::floor(m_p) && m_p <= std::numeric_limits<int>::max()) {
+                    m_kind = Kind::kInteger;
+                } else {
+                    m_kind = Kind::kGeneral;
+                }
+            }
+
+            [[nodiscard]] np::float_ p() const {
+                return m_p;
+            }
+
+            [[nodiscard]] utils::Accumulation accumulation() const {
+                return m_accumulation;
+            }
+
+            // Calls f with the reduced distance functor specialized for p, rdist(x, y, size).
+            // Loops over many pairs should be written inside f, so that the choice is made once and not per pair.
+            template<typename F>
+            decltype(auto) visit(F &&f) const {
+                switch (m_kind) {
+                    case Kind::kManhattan:
+                        return f(internal::ManhattanRdist{});
+                    case Kind::kChebyshev:
+                        return f(internal::ChebyshevRdist{});
+                    case Kind::kInteger:
+                        return f(internal::IntegerRdist{static_cast<int>(m_p)});
+                    case Kind::kGeneral:
+                        return f(internal::GeneralRdist{m_p});
+                    case Kind::kEuclidean:
+                    default:
+                        return f(internal::EuclideanRdist{});
+                }
+            }
+
+            template<typename DTypeX, typename DTypeY>
+            np::float_ rdist(const DTypeX *x, const DTypeY *y, np::Size size) const {
+                return visit([x, y, size](const auto &rdist) { return rdist(x, y, size); });
+            }
+
+            template<typename DTypeX, typename DTypeY>
+            np::float_ dist(const DTypeX *x, const DTypeY *y, np::Size size) const {
+                return rdist_to_dist(rdist(x, y, size));
+            }
+
+            // Adds the contribution of one coordinate difference to a reduced distance accumulator.
+            [[nodiscard]] np::float_ accumulate(np::float_ rdist, np::float_ delta) const {
+                return visit([rdist, delta](const auto &reduction) { return reduction.accumulate(rdist, delta); });
+            }
+
+            [[nodiscard]] np::float_ rdist_to_dist(np::float_ rdist) const {
+                switch (m_kind) {
+                    case Kind::kManhattan:
+                    case Kind::kChebyshev:
+                        return rdist;
+                    case Kind::kEuclidean:
+                        return std::sqrt(rdist);
+                    case Kind::kInteger:
+                    case Kind::kGeneral:
+                        return std::pow(rdist, 1.0 / m_p);
+                }
+                return rdist;
+            }
+
+            [[nodiscard]] np::float_ dist_to_rdist(np::float_ dist) const {
+                switch (m_kind) {
+                    case Kind::kManhattan:
+                    case Kind::kChebyshev:
+                        return dist;
+                    case Kind::kEuclidean:
+                        return dist * dist;
+                    case Kind::kInteger:
+                        return internal::powInt(dist, static_cast<int>(m_p));
+                    case Kind::kGeneral:
+                        return std::pow(dist, m_p);
+                }
+                return dist;
+            }
+
+        private:
+            enum class Kind {
+                kManhattan,
+                kEuclidean,
+                kChebyshev,
+                kInteger,
+                kGeneral
+            };
+
+            np::float_ m_p{2};
+            Kind m_kind{Kind::kEuclidean};
+            utils::Accumulation m_accumulation;
+        };
+    }// namespace metrics
+}// namespace sklearn
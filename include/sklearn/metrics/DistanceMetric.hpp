@@ -28,22 +28,24 @@ SOFTWARE.
 #include <sklearn/metrics/EuclideanDistance.hpp>
 #include <sklearn/metrics/ManhattanDistance.hpp>
 #include <sklearn/metrics/MinkowskiDistance.hpp>
+#include <sklearn/utils/Accumulation.hpp>
 
 namespace sklearn {
     namespace metrics {
         template<typename ArrayX, typename ArrayY = ArrayX>
         class DistanceMetric {
         public:
-            static DistancePtr<ArrayX, ArrayY> get_metric(DistanceMetricType type, int p = 2) {
+            // accumulation - precision of the sums on float32 data, see utils::Accumulation.
+            static DistancePtr<ArrayX, ArrayY> get_metric(DistanceMetricType type, np::float_ p = 2, utils::Accumulation accumulation = utils::Accumulation::kFloat64) {
                 switch (type) {
                     case DistanceMetricType::kEuclidean:
-                        return std::make_shared<EuclideanDistance<ArrayX, ArrayY>>();
+                        return std::make_shared<EuclideanDistance<ArrayX, ArrayY>>(accumulation);
                     case DistanceMetricType::kManhattan:
-                        return std::make_shared<ManhattanDistance<ArrayX, ArrayY>>();
+                        return std::make_shared<ManhattanDistance<ArrayX, ArrayY>>(accumulation);
                     case DistanceMetricType::kChebyshev:
-                        return std::make_shared<ChebyshevDistance<ArrayX, ArrayY>>();
+                        return std::make_shared<ChebyshevDistance<ArrayX, ArrayY>>(accumulation);
                     case DistanceMetricType::kMinkowski:
-                        return std::make_shared<MinkowskiDistance<ArrayX, ArrayY>>(p);
+                        return std::make_shared<MinkowskiDistance<ArrayX, ArrayY>>(p, accumulation);
                     default:
                         throw std::runtime_error("Unknown metric type");
                         return nullptr;
@@ -22,47 +22,117 @@ SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <np/Array.hpp>
 
 #include <sklearn/metrics/Distance.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/extmath.hpp>
 
 namespace sklearn {
     namespace metrics {
+        // Row-major matrix of the distances between the rows of X and Y, computed as
+        // sqrt(||x||^2 - 2 * x.y + ||y||^2): the squared norms are computed once per row and all the dot products
+        // x.y at once, as a blocked matrix product. Round-off can make the expression slightly negative for
+        // (nearly) equal rows, so it is clamped at zero before the square root.
+        // squared - return the squared distances, skipping the square root.
+        // Everything is computed in Acc.
+        template<typename Acc = np::float_, typename DType>
+        std::vector<Acc> euclidean_distances(const utils::DenseMatrix<DType> &X, const utils::DenseMatrix<DType> &Y, bool squared = false) {
+            const auto x_norms = utils::row_norms<Acc>(X, true);
+            const auto y_norms = utils::row_norms<Acc>(Y, true);
+            std::vector<Acc> result(X.rows() * Y.rows());
+            utils::dot_transposed(X.data(), X.cols(), Y.data(), Y.cols(), X.rows(), Y.rows(), X.cols(), result.data(), Y.rows());
+            for (np::Size i = 0; i < X.rows(); ++i) {
+                auto *row = result.data() + i * Y.rows();
+                for (np::Size j = 0; j < Y.rows(); ++j) {
+                    const auto distance = std::max(x_norms[i] - 2 * row[j] + y_norms[j], Acc{0});
+                    row[j] = squared ? distance : std::sqrt(distance);
+                }
+            }
+            return result;
+        }
+
+        // Row-major matrix of the distances between the rows of X, computed as euclidean_distances does, but only for the
+        // square tiles on and above the diagonal; the result is mirrored and the diagonal is exactly zero.
+        // All the tiles have the same size, so they are distributed over the threads one by one.
+        template<typename Acc = np::float_, typename DType>
+        std::vector<Acc> euclidean_distances(const utils::DenseMatrix<DType> &X, bool squared = false) {
+            constexpr np::Size kTile = 64;
+            const np::Size n = X.rows();
+            const np::Size n_features = X.cols();
+            const auto norms = utils::row_norms<Acc>(X, true);
+            std::vector<Acc> result(n * n);
+            std::vector<std::pair<np::Size, np::Size>> tiles;
+            for (np::Size i0 = 0; i0 < n; i0 += kTile) {
+                for (np::Size j0 = i0; j0 < n; j0 += kTile) {
+                    tiles.emplace_back(i0, j0);
+                }
+            }
+            const auto n_tiles = static_cast<long>(tiles.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long tile = 0; tile < n_tiles; ++tile) {
+                const auto [i0, j0] = tiles[tile];
+                const np::Size i1 = std::min(i0 + kTile, n);
+                const np::Size j1 = std::min(j0 + kTile, n);
+                auto *block = result.data() + i0 * n + j0;
+                utils::dot_transposed(X.row(i0), n_features, X.row(j0), n_features, i1 - i0, j1 - j0, n_features, block, n);
+                for (np::Size i = i0; i < i1; ++i) {
+                    auto *row = result.data() + i * n;
+                    for (np::Size j = std::max(j0, i + 1); j < j1; ++j) {
+                        const auto distance = std::max(norms[i] - 2 * row[j] + norms[j], Acc{0});
+                        row[j] = squared ? distance : std::sqrt(distance);
+                    }
+                }
+            }
+            for (np::Size i = 0; i < n; ++i) {
+                result[i * n + i] = 0;
+            }
+            mirror_upper_triangle(result.data(), n);
+            return result;
+        }
+
         // sqrt(sum((x - y)^2))
         template<typename ArrayX, typename ArrayY = ArrayX>
         class EuclideanDistance : public Distance<ArrayX, ArrayY> {
         public:
-            virtual np::Array<np::float_> pairwise(const ArrayX &X) {
+            using typename Distance<ArrayX, ArrayY>::DType;
+
+            explicit EuclideanDistance(utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : Distance<ArrayX, ArrayY>{accumulation} {
+            }
+
+            virtual np::Array<DType> pairwise(const ArrayX &X) {
                 if (X.ndim() != 2) {
                     throw std::runtime_error("2D array expected");
                 }
-                np::Shape shape{X.shape()[0], X.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, std::sqrt(static_cast<np::float_>(X[i].dot(X[i])) - static_cast<np::float_>(X[i].dot(X[j])) * 2 + static_cast<np::float_>(X[j].dot(X[j]))));
-                    }
-                }
-                return result;
+                utils::DenseMatrix<DType> x{X};
+                return utils::visit_accumulator<DType>(this->accumulation(), [&x](auto zero) {
+                    return internal::toArray<DType>(euclidean_distances<decltype(zero)>(x), np::Shape{x.rows(), x.rows()});
+                });
             }
 
-            virtual np::Array<np::float_> pairwise(const ArrayX &X, const ArrayY &Y) {
+            virtual np::Array<DType> pairwise(const ArrayX &X, const ArrayY &Y) {
                 if (X.ndim() != 2 || Y.ndim() != 2) {
                     throw std::runtime_error("2D arrays expected");
                 }
                 if (X.shape()[1] != Y.shape()[1]) {
                     throw std::runtime_error("Number of features is different");
                 }
-                np::Shape shape{X.shape()[0], Y.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, std::sqrt(static_cast<np::float_>(X[i].dot(X[i])) - 2 * static_cast<np::float_>(X[i].dot(Y[j])) + static_cast<np::float_>(Y[j].dot(Y[j]))));
-                    }
-                }
-                return result;
+                utils::DenseMatrix<DType> x{X};
+                utils::DenseMatrix<DType> y{Y};
+                return utils::visit_accumulator<DType>(this->accumulation(), [&x, &y](auto zero) {
+                    return internal::toArray<DType>(euclidean_distances<decltype(zero)>(x, y), np::Shape{x.rows(), y.rows()});
+                });
             }
         };
 
@@ -27,6 +27,10 @@ SOFTWARE.
 #include <np/Array.hpp>
 
 #include <sklearn/metrics/Distance.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
 namespace sklearn {
     namespace metrics {
@@ -34,35 +38,34 @@ namespace sklearn {
         template<typename ArrayX, typename ArrayY = ArrayX>
         class ManhattanDistance : public Distance<ArrayX, ArrayY> {
         public:
-            virtual np::Array<np::float_> pairwise(const ArrayX &X) {
+            using typename Distance<ArrayX, ArrayY>::DType;
+
+            explicit ManhattanDistance(utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : Distance<ArrayX, ArrayY>{accumulation} {
+            }
+
+            virtual np::Array<DType> pairwise(const ArrayX &X) {
                 if (X.shape().size() != 2) {
                     throw std::runtime_error("2D array expected");
                 }
-                np::Shape shape{X.shape()[0], X.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, sum(abs(X[i].subtract(X[j]))));
-                    }
-                }
-                return result;
+                utils::DenseMatrix<DType> x{X};
+                return utils::visit_accumulator<DType>(this->accumulation(), [&x](auto zero) {
+                    return internal::toArray<DType>(symmetric_pairwise_distances<decltype(zero)>(x, internal::ManhattanRdist{}), np::Shape{x.rows(), x.rows()});
+                });
             }
 
-            virtual np::Array<np::float_> pairwise(const ArrayX &X, const ArrayY &Y) {
+            virtual np::Array<DType> pairwise(const ArrayX &X, const ArrayY &Y) {
                 if (X.shape().size() != 2 || Y.shape().size() != 2) {
                     throw std::runtime_error("2D arrays expected");
                 }
                 if (X.shape()[1] != Y.shape()[1]) {
                     throw std::runtime_error("Number of features is different");
                 }
-                np::Shape shape{X.shape()[0], Y.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, sum(abs(X[i].subtract(Y[j]))));
-                    }
-                }
-                return result;
+                utils::DenseMatrix<DType> x{X};
+                utils::DenseMatrix<DType> y{Y};
+                return utils::visit_accumulator<DType>(this->accumulation(), [&x, &y](auto zero) {
+                    return internal::toArray<DType>(pairwise_rdist<decltype(zero)>(internal::ManhattanRdist{}, x, y), np::Shape{x.rows(), y.rows()});
+                });
             }
         };
 
@@ -23,56 +23,110 @@ SOFTWARE.
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <np/Array.hpp>
 
 #include <sklearn/metrics/Distance.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/metrics/EuclideanDistance.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
 namespace sklearn {
     namespace metrics {
-        // sum(|x - y|^p)^(1/p)
+        // sum(|x - y|^p)^(1/p), p >= 1
+        // p = 2 is computed as EuclideanDistance does, p = 1, inf and other integer p with the specialized loops of
+        // DistanceKernel, fractional p with std::pow.
         template<typename ArrayX, typename ArrayY = ArrayX>
         class MinkowskiDistance : public Distance<ArrayX, ArrayY> {
         public:
-            explicit MinkowskiDistance(int p = 2) : m_p{p} {
-                if (p != 2) {
-                    throw std::runtime_error("Only p == 2 is currently supported");
-                }
+            using typename Distance<ArrayX, ArrayY>::DType;
+
+            explicit MinkowskiDistance(np::float_ p = 2, utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : Distance<ArrayX, ArrayY>{accumulation}, m_kernel{DistanceMetricType::kMinkowski, p, accumulation} {
+            }
+
+            virtual np::Array<DType> pairwise(const ArrayX &X) {
+                return compute(X, false);
+            }
+
+            virtual np::Array<DType> pairwise(const ArrayX &X, const ArrayY &Y) {
+                return compute(X, Y, false);
+            }
+
+            // Reduced distances sum(|x - y|^p) (max(|x - y|) for p = inf): the final root is skipped,
+            // which is enough when only the ranking of the distances matters.
+            np::Array<DType> reduced_pairwise(const ArrayX &X) {
+                return compute(X, true);
+            }
+
+            np::Array<DType> reduced_pairwise(const ArrayX &X, const ArrayY &Y) {
+                return compute(X, Y, true);
             }
 
-            virtual np::Array<np::float_> pairwise(const ArrayX &X) {
+            [[nodiscard]] np::float_ p() const {
+                return m_kernel.p();
+            }
+
+        private:
+            np::Array<DType> compute(const ArrayX &X, bool reduced) const {
                 if (X.shape().size() != 2) {
                     throw std::runtime_error("2D array expected");
                 }
-                np::Shape shape{X.shape()[0], X.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, std::sqrt(static_cast<np::float_>(X[i].dot(X[i])) - 2 * static_cast<np::float_>(X[i].dot(X[j])) + static_cast<np::float_>(X[j].dot(X[j]))));
+                utils::DenseMatrix<DType> x{X};
+                np::Shape shape{x.rows(), x.rows()};
+                return utils::visit_accumulator<DType>(m_kernel.accumulation(), [&](auto zero) {
+                    using Acc = decltype(zero);
+                    if (m_kernel.p() == 2) {
+                        return internal::toArray<DType>(euclidean_distances<Acc>(x, reduced), shape);
                     }
-                }
-                return result;
+                    auto result = m_kernel.visit([&x](const auto &rdist) {
+                        return symmetric_pairwise_distances<Acc>(x, rdist);
+                    });
+                    if (!reduced) {
+                        toDistances(result);
+                    }
+                    return internal::toArray<DType>(std::move(result), shape);
+                });
             }
 
-            virtual np::Array<np::float_> pairwise(const ArrayX &X, const ArrayY &Y) {
+            np::Array<DType> compute(const ArrayX &X, const ArrayY &Y, bool reduced) const {
                 if (X.shape().size() != 2 || Y.shape().size() != 2) {
                     throw std::runtime_error("2D arrays expected");
                 }
                 if (X.shape()[1] != Y.shape()[1]) {
                     throw std::runtime_error("Number of features is different");
                 }
-                np::Shape shape{X.shape()[0], Y.shape()[0]};
-                np::Array<np::float_> result{shape};
-                for (np::Size i = 0; i < shape[0]; ++i) {
-                    for (np::Size j = 0; j < shape[1]; ++j) {
-                        result.set(i * shape[1] + j, std::sqrt(static_cast<np::float_>(X[i].dot(X[i])) - 2 * static_cast<np::float_>(X[i].dot(Y[j])) + static_cast<np::float_>(Y[j].dot(Y[j]))));
+                utils::DenseMatrix<DType> x{X};
+                utils::DenseMatrix<DType> y{Y};
+                np::Shape shape{x.rows(), y.rows()};
+                return utils::visit_accumulator<DType>(m_kernel.accumulation(), [&](auto zero) {
+                    using Acc = decltype(zero);
+                    if (m_kernel.p() == 2) {
+                        return internal::toArray<DType>(euclidean_distances<Acc>(x, y, reduced), shape);
                     }
+                    auto result = m_kernel.visit([&x, &y](const auto &rdist) {
+                        return pairwise_rdist<Acc>(rdist, x, y);
+                    });
+                    if (!reduced) {
+                        toDistances(result);
+                    }
+                    return internal::toArray<DType>(std::move(result), shape);
+                });
+            }
+
+            template<typename Acc>
+            void toDistances(std::vector<Acc> &result) const {
+                for (auto &distance: result) {
+                    distance = static_cast<Acc>(m_kernel.rdist_to_dist(distance));
                 }
-                return result;
             }
 
-        private:
-            int m_p;
+            DistanceKernel m_kernel;
         };
 
         template<typename ArrayX, typename ArrayY = ArrayX>
@@ -0,0 +1,119 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/extmath.hpp>
+#include <sklearn/utils/parallel.hpp>
+
+namespace sklearn {
+    namespace metrics {
+        // Pairwise distances reduction: computes the reduced distances (see DistanceKernel) between the rows of X and
+        // the rows of Y one tile at a time and folds every tile into the caller's result, so that the n_X x n_Y
+        // distance matrix is never materialized. Peak memory is one chunk_size x chunk_size tile (512 KB for the
+        // default 256) plus whatever the reduction keeps, e.g. n_X * k for the k nearest neighbors.
+        //
+        // reduce(x_start, x_end, y_start, y_end, tile) is called for the rows [x_start, x_end) of X against the rows
+        // [y_start, y_end) of Y; tile is row-major, tile[(i - x_start) * (y_end - y_start) + (j - y_start)] is the
+        // reduced distance between X[i] and Y[j]. Tiles come in a fixed order: chunks of X in increasing order, and for
+        // each of them all the chunks of Y in increasing order, so a reduction knows that the rows of X are complete
+        // once y_end == Y.rows().
+        // With n_jobs other than 1 (see utils::effective_n_jobs) the chunks of X are spread over threads, each with
+        // its own tile: the order above holds within every chunk of X, and reduce must only write the state of the
+        // rows of its chunk. Every tile is computed the same way whatever the thread, so the result is deterministic.
+        // Euclidean tiles are computed as ||x||^2 - 2 * x.y + ||y||^2 with a blocked matrix product for the dot products
+        // (see utils::dot_transposed) and the row norms computed once, other metrics with rdist_tile.
+        // Tiles hold the type the distances are summed in: float for float32 data with kernel.accumulation() ==
+        // utils::Accumulation::kFloat32, np::float_ otherwise, so reduce must accept a pointer to either.
+        template<typename DataType, typename Reduce>
+        void pairwise_distances_reduction(const utils::DenseMatrix<DataType> &X, const utils::DenseMatrix<DataType> &Y, const DistanceKernel &kernel, Reduce &&reduce, np::Size chunk_size = 256, int n_jobs = 1) {
+            if (X.cols() != Y.cols()) {
+                throw std::runtime_error("Number of features is different");
+            }
+            if (chunk_size == 0) {
+                throw std::runtime_error("chunk_size must be positive");
+            }
+            utils::visit_accumulator<DataType>(kernel.accumulation(), [&](auto zero) {
+                using Acc = decltype(zero);
+                const np::Size n_features = X.cols();
+                const bool euclidean = kernel.p() == 2;
+                std::vector<Acc> x_norms;
+                std::vector<Acc> y_norms;
+                if (euclidean) {
+                    x_norms = utils::row_norms<Acc>(X, true);
+                    y_norms = utils::row_norms<Acc>(Y, true);
+                }
+                const auto reduceChunk = [&](np::Size x_start, std::vector<Acc> &tile) {
+                    const np::Size x_end = std::min(x_start + chunk_size, X.rows());
+                    for (np::Size y_start = 0; y_start < Y.rows(); y_start += chunk_size) {
+                        const np::Size y_end = std::min(y_start + chunk_size, Y.rows());
+                        const np::Size tile_cols = y_end - y_start;
+                        if (euclidean) {
+                            utils::dot_transposed(X.row(x_start), n_features, Y.row(y_start), n_features, x_end - x_start, tile_cols, n_features, tile.data(), tile_cols);
+                            for (np::Size i = x_start; i < x_end; ++i) {
+                                auto *tile_row = tile.data() + (i - x_start) * tile_cols;
+                                for (np::Size j = y_start; j < y_end; ++j) {
+                                    tile_row[j - y_start] = std::max(x_norms[i] - 2 * tile_row[j - y_start] + y_norms[j], Acc{0});
+                                }
+                            }
+                        } else {
+                            kernel.visit([&](const auto &rdist) {
+                                rdist_tile(rdist, X, x_start, x_end, Y, y_start, y_end, tile.data(), tile_cols);
+                            });
+                        }
+                        reduce(x_start, x_end, y_start, y_end, static_cast<const Acc *>(tile.data()));
+                    }
+                };
+                const np::Size tile_size = std::min(chunk_size, X.rows()) * std::min(chunk_size, Y.rows());
+                const auto n_chunks = static_cast<long>((X.rows() + chunk_size - 1) / chunk_size);
+                const auto n_threads = static_cast<int>(std::min<long>(utils::effective_n_jobs(n_jobs), n_chunks));
+                if (n_threads <= 1) {
+                    std::vector<Acc> tile(tile_size);
+                    for (long chunk = 0; chunk < n_chunks; ++chunk) {
+                        reduceChunk(static_cast<np::Size>(chunk) * chunk_size, tile);
+                    }
+                    return;
+                }
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads)
+                {
+                    std::vector<Acc> tile(tile_size);
+#pragma omp for schedule(dynamic)
+                    for (long chunk = 0; chunk < n_chunks; ++chunk) {
+                        reduceChunk(static_cast<np::Size>(chunk) * chunk_size, tile);
+                    }
+                }
+#endif
+            });
+        }
+    }// namespace metrics
+}// namespace sklearn
@@ -0,0 +1,163 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <np/Array.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/extmath.hpp>
+
+namespace sklearn {
+    namespace metrics {
+        // Number of blocks the work of a parallel loop is split into: a few per thread, so that a thread that finishes
+        // early can pick up another block.
+        inline np::Size parallel_blocks() {
+#ifdef _OPENMP
+            return static_cast<np::Size>(omp_get_max_threads()) * 4;
+#else
+            return 1;
+#endif
+        }
+
+        // Splits the rows [0, n) of the strict upper triangle of an n x n matrix into at most n_blocks consecutive
+        // ranges holding about the same number of pairs i < j. Row i holds n - 1 - i pairs, so equal row counts would
+        // give the first block almost all the work. Returns the n_ranges + 1 boundaries.
+        inline std::vector<np::Size> triangular_row_blocks(np::Size n, np::Size n_blocks) {
+            std::vector<np::Size> bounds{0};
+            if (n < 2) {
+                bounds.push_back(n);
+                return bounds;
+            }
+            const np::Size n_pairs = n * (n - 1) / 2;
+            n_blocks = std::max(np::Size{1}, std::min(n_blocks, n - 1));
+            np::Size pairs = 0;
+            for (np::Size i = 0; i < n; ++i) {
+                pairs += n - 1 - i;
+                // the block ends once it has reached its share of the pairs
+                if (pairs * n_blocks >= n_pairs * bounds.size() && bounds.size() < n_blocks) {
+                    bounds.push_back(i + 1);
+                }
+            }
+            if (bounds.back() != n) {
+                bounds.push_back(n);
+            }
+            return bounds;
+        }
+
+        namespace internal {
+            struct RdistTile {
+                template<typename Rdist, typename DType, typename Acc>
+                SKLEARN_ALWAYS_INLINE static void run(const Rdist &rdist, const utils::DenseMatrix<DType> &X, np::Size x_start, np::Size x_end, const utils::DenseMatrix<DType> &Y, np::Size y_start, np::Size y_end, Acc *result, np::Size ld) {
+                    utils::internal::foldPairs([&rdist](Acc acc, Acc x, Acc y) { return rdist.accumulate(acc, x - y); },
+                                               X.row(x_start), X.cols(), Y.row(y_start), Y.cols(), x_end - x_start, y_end - y_start, X.cols(), result, ld);
+                }
+            };
+        }// namespace internal
+
+        // Reduced distances between the rows [x_start, x_end) of X and [y_start, y_end) of Y, written to the row-major
+        // result with the row stride ld: result[(i - x_start) * ld + j - y_start] = rdist(X.row(i), Y.row(j)).
+        // rdist is one of the functors of DistanceKernel::visit. Pairs are processed in register tiles of 4 rows of X
+        // against a packed panel of 16 rows of Y (see utils::internal::foldPairs), vectorized across the rows of Y for the
+        // instruction set chosen by utils::cpu_dispatch. The distances are summed in the element type of result.
+        // Nothing is allocated on the heap.
+        template<typename Rdist, typename DType, typename Acc>
+        void rdist_tile(const Rdist &rdist, const utils::DenseMatrix<DType> &X, np::Size x_start, np::Size x_end, const utils::DenseMatrix<DType> &Y, np::Size y_start, np::Size y_end, Acc *result, np::Size ld) {
+            utils::cpu_dispatch<internal::RdistTile>(rdist, X, x_start, x_end, Y, y_start, y_end, result, ld);
+        }
+
+        // Row-major X.rows() x Y.rows() matrix of the reduced distances between the rows of X and Y, computed by
+        // rdist_tile on blocks of 64 rows of X against 256 rows of Y, which stay in cache, in parallel over the blocks of X.
+        // The distances are summed in Acc.
+        template<typename Acc = np::float_, typename Rdist, typename DType>
+        std::vector<Acc> pairwise_rdist(const Rdist &rdist, const utils::DenseMatrix<DType> &X, const utils::DenseMatrix<DType> &Y) {
+            constexpr np::Size kBlockRows = 64;
+            constexpr np::Size kBlockCols = 256;
+            std::vector<Acc> result(X.rows() * Y.rows());
+            const auto n_blocks = static_cast<long>((X.rows() + kBlockRows - 1) / kBlockRows);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long block = 0; block < n_blocks; ++block) {
+                const np::Size x_start = static_cast<np::Size>(block) * kBlockRows;
+                const np::Size x_end = std::min(x_start + kBlockRows, X.rows());
+                for (np::Size y_start = 0; y_start < Y.rows(); y_start += kBlockCols) {
+                    const np::Size y_end = std::min(y_start + kBlockCols, Y.rows());
+                    rdist_tile(rdist, X, x_start, x_end, Y, y_start, y_end, result.data() + x_start * Y.rows() + y_start, Y.rows());
+                }
+            }
+            return result;
+        }
+
+        // Copies the strict upper triangle of the row-major n x n matrix into the lower one.
+        template<typename T>
+        void mirror_upper_triangle(T *result, np::Size n) {
+            const auto bounds = triangular_row_blocks(n, parallel_blocks());
+            const auto n_ranges = static_cast<long>(bounds.size() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long block = 0; block < n_ranges; ++block) {
+                // the columns of the rows of the block, that is the mirrored rows, hold the same number of pairs
+                for (np::Size j = bounds[block]; j < bounds[block + 1]; ++j) {
+                    for (np::Size i = j + 1; i < n; ++i) {
+                        result[i * n + j] = result[j * n + i];
+                    }
+                }
+            }
+        }
+
+        // Row-major n x n matrix of the reduced distances rdist.reduce<Acc>(X.row(i), X.row(j), n_features) between
+        // the rows of X, rdist being one of the functors of DistanceKernel::visit.
+        // The matrix is symmetric with a zero diagonal, so only the pairs i < j are computed, in parallel over row
+        // blocks with the same number of pairs, and then mirrored.
+        template<typename Acc = np::float_, typename DType, typename Rdist>
+        std::vector<Acc> symmetric_pairwise_distances(const utils::DenseMatrix<DType> &X, const Rdist &rdist) {
+            const np::Size n = X.rows();
+            std::vector<Acc> result(n * n);
+            const auto bounds = triangular_row_blocks(n, parallel_blocks());
+            const auto n_ranges = static_cast<long>(bounds.size() - 1);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+            for (long block = 0; block < n_ranges; ++block) {
+                for (np::Size i = bounds[block]; i < bounds[block + 1]; ++i) {
+                    auto *row = result.data() + i * n;
+                    for (np::Size j = i + 1; j < n; ++j) {
+                        row[j] = rdist.template reduce<Acc>(X.row(i), X.row(j), X.cols());
+                    }
+                }
+            }
+            mirror_upper_triangle(result.data(), n);
+            return result;
+        }
+    }// namespace metrics
+}// namespace sklearn
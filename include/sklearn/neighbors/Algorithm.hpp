@@ -22,25 +22,241 @@ SOFTWARE.
 
 #pragma once
 
-#include <sklearn/metrics/ChebyshevDistance.hpp>
+#include <cmath>
+#include <memory>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
 #include <sklearn/metrics/DistanceMetricType.hpp>
-#include <sklearn/metrics/MinkowskiDistance.hpp>
+#include <sklearn/neighbors/AlgorithmType.hpp>
 #include <sklearn/neighbors/BallTree.hpp>
+#include <sklearn/neighbors/BinaryTree.hpp>
+#include <sklearn/neighbors/BruteForce.hpp>
+#include <sklearn/neighbors/Hnsw.hpp>
+#include <sklearn/neighbors/IvfPq.hpp>
 #include <sklearn/neighbors/KdTree.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
 namespace sklearn {
     namespace neighbors {
-        template<typename DType>
-        AlgorithmPtr<DType> get_algorithm(AlgorithmType type) {
+        // Nearest neighbors index built by fit.
+        template<typename DataType>
+        class Algorithm {
+        public:
+            virtual ~Algorithm() = default;
+
+            [[nodiscard]] virtual AlgorithmType type() const = 0;
+
+            [[nodiscard]] virtual const metrics::DistanceKernel &kernel() const = 0;
+
+            // The k nearest neighbors of every row of X, as a sorted heap of reduced distances.
+            // n_jobs - number of threads the rows of X are spread over (see utils::effective_n_jobs), the result does
+            // not depend on it.
+            [[nodiscard]] virtual NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k, int n_jobs = 1) const = 0;
+
+            // The heap.k() nearest neighbors of one point into the row of the heap, sorted, as query does for one row,
+            // but on the calling thread and without allocating once the search buffers of the thread have grown.
+            // The row of the heap must be empty (see NeighborsHeap::reset), point must hold the features of a sample
+            // and heap.k() must not exceed the number of samples: neither is checked.
+            virtual void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const = 0;
+
+            // The neighbors within the radius r of every row of X, with true distances.
+            // n_jobs - as for query.
+            [[nodiscard]] virtual RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &X, np::float_ r, bool sort_results, int n_jobs = 1) const = 0;
+        };
+
+        template<typename DataType>
+        using AlgorithmPtr = std::shared_ptr<const Algorithm<DataType>>;
+
+        template<typename DataType, typename Tree, AlgorithmType Type>
+        class TreeAlgorithm : public Algorithm<DataType> {
+        public:
+            TreeAlgorithm(utils::DenseMatrix<DataType> X, int leaf_size, metrics::DistanceMetricType metric, np::float_ p)
+                : m_tree{std::move(X), leaf_size, metric, p} {
+            }
+
+            [[nodiscard]] AlgorithmType type() const override {
+                return Type;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const override {
+                return m_tree.kernel();
+            }
+
+            [[nodiscard]] NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k, int n_jobs = 1) const override {
+                return m_tree.query(X, k, n_jobs);
+            }
+
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const override {
+                m_tree.query_point(point, heap, row);
+            }
+
+            [[nodiscard]] RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &X, np::float_ r, bool sort_results, int n_jobs = 1) const override {
+                return m_tree.query_radius(X, r, sort_results, n_jobs);
+            }
+
+        private:
+            Tree m_tree;
+        };
+
+        // Exhaustive search over the training data, tile by tile (see metrics::pairwise_distances_reduction).
+        template<typename DataType>
+        class BruteForceAlgorithm : public Algorithm<DataType> {
+        public:
+            BruteForceAlgorithm(utils::DenseMatrix<DataType> X, metrics::DistanceMetricType metric, np::float_ p, utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                : m_data{std::move(X)}, m_kernel{metric, p, accumulation} {
+                if (m_data.empty()) {
+                    throw std::runtime_error("X must not be empty");
+                }
+            }
+
+            [[nodiscard]] AlgorithmType type() const override {
+                return AlgorithmType::kBruteForce;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const override {
+                return m_kernel;
+            }
+
+            [[nodiscard]] NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k, int n_jobs = 1) const override {
+                return brute_force_query(X, m_data, m_kernel, k, 256, n_jobs);
+            }
+
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const override {
+                brute_force_query_point(point, m_data, m_kernel, heap, row);
+            }
+
+            [[nodiscard]] RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &X, np::float_ r, bool sort_results, int n_jobs = 1) const override {
+                return brute_force_query_radius(X, m_data, m_kernel, r, sort_results, 256, n_jobs);
+            }
+
+        private:
+            const utils::DenseMatrix<DataType> m_data;
+            metrics::DistanceKernel m_kernel;
+        };
+
+        template<typename DataType>
+        class HnswAlgorithm : public Algorithm<DataType> {
+        public:
+            HnswAlgorithm(utils::DenseMatrix<DataType> X, const HnswParameters &parameters, metrics::DistanceMetricType metric, np::float_ p)
+                : m_index{std::move(X), parameters, metric, p} {
+            }
+
+            [[nodiscard]] AlgorithmType type() const override {
+                return AlgorithmType::kHnsw;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const override {
+                return m_index.kernel();
+            }
+
+            [[nodiscard]] NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k, int n_jobs = 1) const override {
+                return m_index.query(X, k, n_jobs);
+            }
+
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const override {
+                m_index.query_point(point, heap, row);
+            }
+
+            [[nodiscard]] RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &, np::float_, bool, int = 1) const override {
+                throw std::runtime_error("Radius queries are not supported by the approximate kHnsw algorithm");
+            }
+
+        private:
+            Hnsw<DataType> m_index;
+        };
+
+        template<typename DataType>
+        class IvfPqAlgorithm : public Algorithm<DataType> {
+        public:
+            IvfPqAlgorithm(utils::DenseMatrix<DataType> X, const IvfPqParameters &parameters, metrics::DistanceMetricType metric, np::float_ p)
+                : m_index{std::move(X), parameters, metric, p} {
+            }
+
+            [[nodiscard]] AlgorithmType type() const override {
+                return AlgorithmType::kIvfPq;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const override {
+                return m_index.kernel();
+            }
+
+            [[nodiscard]] NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k, int n_jobs = 1) const override {
+                return m_index.query(X, k, n_jobs);
+            }
+
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const override {
+                m_index.query_point(point, heap, row);
+            }
+
+            [[nodiscard]] RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &, np::float_, bool, int = 1) const override {
+                throw std::runtime_error("Radius queries are not supported by the approximate kIvfPq algorithm");
+            }
+
+        private:
+            IvfPq<DataType> m_index;
+        };
+
+        // Chooses the search algorithm for AlgorithmType::kAuto.
+        // The thresholds come from single-threaded measurements of 200 queries with k = 5,
+        // on uniformly distributed data (the worst case for trees) and on clustered data (typical for real features):
+        // - with k >= n_samples / 2 almost every node has to be visited, so trees cannot prune anything;
+        // - below ~1000 samples trees and brute force are within 2x of each other and brute force needs no build.
+        //   Minkowski metrics with p other than 1, 2 or inf pay a pow() (integer p: several multiplications) per
+        //   feature, and trees, evaluating fewer distances, won 3-10x from 250 samples on;
+        // - up to 15 features KdTree was the fastest in every run (e.g. 50000 x 8: KdTree 28 ms, BallTree 49 ms,
+        //   brute force 64 ms on uniform data);
+        // - from 16 features on, boxes stop pruning and BallTree is the better tree. On uniform data no tree beats
+        //   brute force there, on clustered data BallTree wins from ~10000 samples (50000 x 64: 690 ms against
+        //   1400 ms, 50000 x 128: 950 ms against 3040 ms);
+        // - above 128 features nothing was measured, so brute force with its predictable cost is kept.
+        inline AlgorithmType select_algorithm(np::Size n_samples, np::Size n_features, np::Size n_neighbors, metrics::DistanceMetricType metric, np::float_ p = 2) {
+            constexpr np::Size kMinTreeSamples = 1000;
+            constexpr np::Size kMinTreeSamplesExpensiveMetric = 250;
+            constexpr np::Size kMaxKdTreeFeatures = 15;
+            constexpr np::Size kMinBallTreeSamples = 10000;
+            constexpr np::Size kMaxBallTreeFeatures = 128;
+
+            if (n_neighbors >= n_samples / 2) {
+                return AlgorithmType::kBruteForce;
+            }
+            const bool expensive_metric = metric == metrics::DistanceMetricType::kMinkowski && p != 1 && p != 2 && !std::isinf(p);
+            if (n_samples < (expensive_metric ? kMinTreeSamplesExpensiveMetric : kMinTreeSamples)) {
+                return AlgorithmType::kBruteForce;
+            }
+            if (n_features <= kMaxKdTreeFeatures) {
+                return AlgorithmType::kKdTree;
+            }
+            if (n_features <= kMaxBallTreeFeatures && (expensive_metric || n_samples >= kMinBallTreeSamples)) {
+                return AlgorithmType::kBallTree;
+            }
+            return AlgorithmType::kBruteForce;
+        }
+
+        // Builds the index for the algorithm.
+        // hnsw - graph parameters for kHnsw
+        // ivf_pq - index parameters for kIvfPq
+        // accumulation - precision of the distance tiles of kBruteForce on float32 data, see utils::Accumulation
+        template<typename DataType>
+        AlgorithmPtr<DataType> get_algorithm(AlgorithmType type, utils::DenseMatrix<DataType> X, int leaf_size = 30, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2,
+                                             const HnswParameters &hnsw = {}, const IvfPqParameters &ivf_pq = {},
+                                             utils::Accumulation accumulation = utils::Accumulation::kFloat64) {
             switch (type) {
                 case AlgorithmType::kAuto:
-                    return EuclideanDistancePtr<DType>{};
+                    // n_neighbors is not known here, assume a small one
+                    return get_algorithm(select_algorithm(X.rows(), X.cols(), 1, metric, p), std::move(X), leaf_size, metric, p, hnsw, ivf_pq, accumulation);
                 case AlgorithmType::kBallTree:
-                    return ManhattanDistancePtr<DType>{};
+                    return std::make_shared<const TreeAlgorithm<DataType, BallTree<DataType>, AlgorithmType::kBallTree>>(std::move(X), leaf_size, metric, p);
                 case AlgorithmType::kKdTree:
-                    return ChebyshevDistancePtr<DType>{};
-                case AlgorithmType::kBrute:
-                    return MinkowskiDistancePtr<DType>{};
+                    return std::make_shared<const TreeAlgorithm<DataType, KdTree<DataType>, AlgorithmType::kKdTree>>(std::move(X), leaf_size, metric, p);
+                case AlgorithmType::kBruteForce:
+                    return std::make_shared<const BruteForceAlgorithm<DataType>>(std::move(X), metric, p, accumulation);
+                case AlgorithmType::kHnsw:
+                    return std::make_shared<const HnswAlgorithm<DataType>>(std::move(X), hnsw, metric, p);
+                case AlgorithmType::kIvfPq:
+                    return std::make_shared<const IvfPqAlgorithm<DataType>>(std::move(X), ivf_pq, metric, p);
                 default:
                     throw std::runtime_error("Unknown algorithm type");
                     return nullptr;
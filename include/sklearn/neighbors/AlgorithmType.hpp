@@ -28,7 +28,11 @@ namespace sklearn {
             kAuto,
             kBallTree,
             kKdTree,
-            kBruteForce
+            kBruteForce,
+            // approximate search on a Hnsw graph, never chosen by kAuto
+            kHnsw,
+            // approximate search on an IvfPq compressed index, never chosen by kAuto
+            kIvfPq
         };
     }
 }// namespace sklearn
@@ -22,23 +22,85 @@ SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
 #include <np/Array.hpp>
 #include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/BinaryTree.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
 namespace sklearn {
     namespace neighbors {
-        // @param Xarray-like of shape (n_samples, n_features)
-        // @param n_samples is the number of points in the data set, and n_features is the dimension of the parameter space. Note: if X is a C-contiguous array of doubles then data will not be copied. Otherwise, an internal copy will be made.
+        // BallTree for fast generalized N-point problems.
+        // Unlike KdTree, whose box bounds lose their pruning power as the dimension grows, every node is bounded by
+        // a ball (centroid and radius), which keeps the search efficient on wide feature vectors.
+
+        // @param X array-like of shape (n_samples, n_features)
+        // @param n_samples is the number of points in the data set, and n_features is the dimension of the parameter space. An array or an owning utils::DenseMatrix is copied (or moved) into an internal row-major buffer once, on construction. A utils::DenseMatrix::view of caller-owned data is borrowed without a copy and has to stay alive and unchanged for as long as the tree or any copy of it is in use, see utils::DenseMatrix.
 
         // @param leaf_size positive int, default=40
         // @param Number of points at which to switch to brute-force. Changing leaf_size will not affect the results of a query, but can significantly impact the speed of a query and the memory required to store the constructed tree. The amount of memory needed to store the tree scales as approximately n_samples / leaf_size. For a specified leaf_size, a leaf node is guaranteed to satisfy leaf_size <= n_points <= 2 * leaf_size, except in the case that n_samples < leaf_size.
 
-        // @param metric str or DistanceMetric object
-        // @param The distance metric to use for the tree. Default=’minkowski’ with p=2 (that is, a euclidean metric). See the documentation of the DistanceMetric class for a list of available metrics. ball_tree.valid_metrics gives a list of the metrics which are valid for BallTree.
-        template<typename DataType, np::Size Samples, np::Size Features>
-        class BallTree {
+        // @param metric DistanceMetricType
+        // @param The distance metric to use for the tree. Default=kMinkowski with p=2 (that is, a euclidean metric). All the metrics of DistanceMetricType are valid for BallTree.
+
+        // @param p np::float_, default=2
+        // @param Power parameter for the Minkowski metric, any p >= 1.
+        template<typename DataType = np::float_>
+        class BallTree : public BinaryTree<BallTree<DataType>, DataType> {
+            using Base = BinaryTree<BallTree<DataType>, DataType>;
+            friend Base;
+
         public:
-            BallTree(const np::Array<DataType, Samples, Features> &X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski);
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            explicit BallTree(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : BallTree(utils::DenseMatrix<DataType>{X}, leaf_size, metric, p) {
+            }
+
+            explicit BallTree(utils::DenseMatrix<DataType> X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : Base(std::move(X), leaf_size, metric, p) {
+                this->build();
+            }
+
+        private:
+            // Every node is bounded by the ball centered at the mean of its points.
+            void allocateNodes(np::Size n_nodes) {
+                m_centroids.resize(n_nodes * this->m_data.cols());
+                m_radius.resize(n_nodes);
+            }
+
+            void initNode(np::Size i_node) {
+                const np::Size n_features = this->m_data.cols();
+                const auto &node = this->m_nodes[i_node];
+                auto *centroid = m_centroids.data() + i_node * n_features;
+                std::fill(centroid, centroid + n_features, np::float_{0});
+                for (np::Size i = node.idx_start; i < node.idx_end; ++i) {
+                    const auto *point = this->m_data.row(this->m_idx[i]);
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        centroid[j] += static_cast<np::float_>(point[j]);
+                    }
+                }
+                const auto n_points = static_cast<np::float_>(node.idx_end - node.idx_start);
+                for (np::Size j = 0; j < n_features; ++j) {
+                    centroid[j] /= n_points;
+                }
+                np::float_ rdist_max{0};
+                for (np::Size i = node.idx_start; i < node.idx_end; ++i) {
+                    rdist_max = std::max(rdist_max, this->m_kernel.rdist(centroid, this->m_data.row(this->m_idx[i]), n_features));
+                }
+                m_radius[i_node] = this->m_kernel.rdist_to_dist(rdist_max);
+            }
+
+            // Reduced distance from the point to the ball of the node, by the triangle inequality.
+            np::float_ minRdist(np::Size i_node, const DataType *point) const {
+                const np::Size n_features = this->m_data.cols();
+                const auto dist = this->m_kernel.dist(point, m_centroids.data() + i_node * n_features, n_features);
+                return this->m_kernel.dist_to_rdist(std::max(np::float_{0}, dist - m_radius[i_node]));
+            }
+
+            std::vector<np::float_> m_centroids;
+            std::vector<np::float_> m_radius;
         };
     }// namespace neighbors
 }// namespace sklearn
@@ -0,0 +1,352 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/parallel.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        // Result of a radius query in compressed sparse row layout:
+        // the neighbors of query i are indices[offsets[i]:offsets[i + 1]], with the matching distances.
+        struct RadiusNeighbors {
+            np::Array<np::Size> offsets;
+            np::Array<np::Size> indices;
+            np::Array<np::float_> distances;
+        };
+
+        namespace internal {
+            // Sorts the neighbors [begin, end) of a query by increasing distance, ties by index.
+            inline void sortNeighbors(std::vector<np::Size> &indices, std::vector<np::float_> &distances, np::Size begin, np::Size end) {
+                std::vector<std::pair<np::float_, np::Size>> pairs;
+                pairs.reserve(end - begin);
+                for (np::Size i = begin; i < end; ++i) {
+                    pairs.emplace_back(distances[i], indices[i]);
+                }
+                std::sort(pairs.begin(), pairs.end());
+                for (np::Size i = begin; i < end; ++i) {
+                    distances[i] = pairs[i - begin].first;
+                    indices[i] = pairs[i - begin].second;
+                }
+            }
+
+            // The neighbors within the radius of a block of consecutive queries, in the layout of RadiusNeighbors:
+            // counts[i] neighbors of the i-th query of the block, stored one query after another.
+            // Blocks are filled independently, e.g. on different threads, and concatenated in query order.
+            struct RadiusBlock {
+                std::vector<np::Size> counts;
+                std::vector<np::Size> indices;
+                std::vector<np::float_> distances;
+            };
+
+            // Concatenates the blocks in order, releasing every block once it is copied.
+            inline RadiusNeighbors concatenateRadiusBlocks(std::vector<RadiusBlock> &blocks) {
+                np::Size n_queries = 0;
+                np::Size n_neighbors = 0;
+                for (const auto &block: blocks) {
+                    n_queries += block.counts.size();
+                    n_neighbors += block.indices.size();
+                }
+                std::vector<np::Size> offsets;
+                std::vector<np::Size> indices;
+                std::vector<np::float_> distances;
+                offsets.reserve(n_queries + 1);
+                indices.reserve(n_neighbors);
+                distances.reserve(n_neighbors);
+                offsets.push_back(0);
+                for (auto &block: blocks) {
+                    for (auto count: block.counts) {
+                        offsets.push_back(offsets.back() + count);
+                    }
+                    indices.insert(indices.end(), block.indices.cbegin(), block.indices.cend());
+                    distances.insert(distances.end(), block.distances.cbegin(), block.distances.cend());
+                    block = RadiusBlock{};
+                }
+                return RadiusNeighbors{np::Array<np::Size>{std::move(offsets), np::Shape{n_queries + 1}},
+                                       np::Array<np::Size>{std::move(indices), np::Shape{n_neighbors}},
+                                       np::Array<np::float_>{std::move(distances), np::Shape{n_neighbors}}};
+            }
+        }// namespace internal
+
+        // Common part of KdTree and BallTree.
+        // The tree is a complete binary tree stored in flat arrays: the children of node i are 2 * i + 1 and 2 * i + 2,
+        // and every node owns the range [idx_start, idx_end) of the index permutation. Nodes are split at the median
+        // of the dimension of the largest spread. Derived trees only describe the node bounds:
+        // allocateNodes(n_nodes) - reserve storage for the bounds of n_nodes nodes,
+        // initNode(i_node) - compute the bounds of the node from its points,
+        // minRdist(i_node, point) - lower bound of the reduced distance from the point to any point of the node.
+        template<typename Derived, typename DataType>
+        class BinaryTree {
+        public:
+            // Query the tree for the k nearest neighbors.
+            // X - query points of shape (n_queries, n_features)
+            // k - number of nearest neighbors to return
+            // Returns distances and indices of the neighbors, both of shape (n_queries, k), sorted by increasing distance.
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            std::pair<np::Array<np::float_>, np::Array<np::Size>> query(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, np::Size k = 1) const {
+                auto heap = query(utils::DenseMatrix<DataType>{X}, k);
+                heap.transform([this](np::float_ rdist) { return m_kernel.rdist_to_dist(rdist); });
+                np::Shape shape{heap.n_queries(), k};
+                return {np::Array<np::float_>{heap.distances(), shape}, np::Array<np::Size>{heap.indices(), shape}};
+            }
+
+            // Query the tree for the k nearest neighbors.
+            // Returns the sorted heap of reduced distances, see metrics::DistanceKernel.
+            // n_jobs - number of threads the queries are spread over, see utils::effective_n_jobs. Every query only
+            // writes its own heap, so the result does not depend on it.
+            NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k = 1, int n_jobs = 1) const {
+                checkFeatures(X);
+                if (k < 1 || k > m_data.rows()) {
+                    throw std::runtime_error("k must be in range [1, n_samples]");
+                }
+                NeighborsHeap heap{X.rows(), k};
+                const auto n_rows = static_cast<long>(X.rows());
+                [[maybe_unused]] const int n_threads = utils::effective_n_jobs(n_jobs);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(n_threads) if (n_threads > 1)
+#endif
+                for (long row = 0; row < n_rows; ++row) {
+                    const DataType *point = X.row(static_cast<np::Size>(row));
+                    querySingle(0, point, static_cast<np::Size>(row), heap, derived().minRdist(0, point));
+                }
+                heap.sort();
+                return heap;
+            }
+
+            // The heap.k() nearest neighbors of one point of n_features() features into the row of the heap, which
+            // must be empty (see NeighborsHeap::reset), sorted. The search recurses on the stack and allocates nothing.
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const {
+                querySingle(0, point, row, heap, derived().minRdist(0, point));
+                heap.sort(row);
+            }
+
+            // Query the tree for neighbors within the radius r.
+            // X - query points of shape (n_queries, n_features)
+            // sort_results - if true, the neighbors of every query are sorted by increasing distance
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            RadiusNeighbors query_radius(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, np::float_ r, bool sort_results = false) const {
+                return query_radius(utils::DenseMatrix<DataType>{X}, r, sort_results);
+            }
+
+            // n_jobs - number of threads the queries are spread over, see utils::effective_n_jobs. Queries are
+            // processed in blocks, each filling its own buffers, and the blocks are concatenated in order, so the
+            // result does not depend on it.
+            RadiusNeighbors query_radius(const utils::DenseMatrix<DataType> &X, np::float_ r, bool sort_results = false, int n_jobs = 1) const {
+                checkFeatures(X);
+                if (r < 0) {
+                    throw std::runtime_error("r must be non-negative");
+                }
+                constexpr np::Size kBlockRows = 64;
+                const auto rdist_bound = m_kernel.dist_to_rdist(r);
+                const auto n_blocks = static_cast<long>((X.rows() + kBlockRows - 1) / kBlockRows);
+                std::vector<internal::RadiusBlock> blocks(static_cast<np::Size>(n_blocks));
+                [[maybe_unused]] const int n_threads = utils::effective_n_jobs(n_jobs);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(n_threads) if (n_threads > 1)
+#endif
+                for (long b = 0; b < n_blocks; ++b) {
+                    auto &block = blocks[static_cast<np::Size>(b)];
+                    const np::Size start = static_cast<np::Size>(b) * kBlockRows;
+                    const np::Size end = std::min(start + kBlockRows, X.rows());
+                    for (np::Size row = start; row < end; ++row) {
+                        const np::Size begin = block.indices.size();
+                        queryRadiusSingle(0, X.row(row), rdist_bound, block.indices, block.distances);
+                        if (sort_results) {
+                            internal::sortNeighbors(block.indices, block.distances, begin, block.indices.size());
+                        }
+                        block.counts.push_back(block.indices.size() - begin);
+                    }
+                    for (auto &distance: block.distances) {
+                        distance = m_kernel.rdist_to_dist(distance);
+                    }
+                }
+                return internal::concatenateRadiusBlocks(blocks);
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const {
+                return m_kernel;
+            }
+
+            [[nodiscard]] np::Size n_samples() const {
+                return m_data.rows();
+            }
+
+            [[nodiscard]] np::Size n_features() const {
+                return m_data.cols();
+            }
+
+        protected:
+            struct NodeData {
+                np::Size idx_start{0};
+                np::Size idx_end{0};
+                bool is_leaf{false};
+            };
+
+            BinaryTree(utils::DenseMatrix<DataType> X, int leaf_size, metrics::DistanceMetricType metric, np::float_ p)
+                : m_data{std::move(X)}, m_kernel{metric, p} {
+                if (m_data.empty()) {
+                    throw std::runtime_error("X must not be empty");
+                }
+                if (leaf_size < 1) {
+                    throw std::runtime_error("leaf_size must be greater or equal to 1");
+                }
+                m_leafSize = static_cast<np::Size>(leaf_size);
+            }
+
+            // Builds the tree. Called by the derived constructors.
+            void build() {
+                const np::Size n_samples = m_data.rows();
+                np::Size n_levels = 1;
+                for (np::Size ratio = std::max<np::Size>(1, (n_samples - 1) / m_leafSize); ratio > 1; ratio /= 2) {
+                    ++n_levels;
+                }
+                m_nodes.resize((np::Size{1} << n_levels) - 1);
+                derived().allocateNodes(m_nodes.size());
+                m_idx.resize(n_samples);
+                std::iota(m_idx.begin(), m_idx.end(), np::Size{0});
+                recursiveBuild(0, 0, n_samples);
+            }
+
+            // read-only: the tree may be built on a view of the caller's data
+            const utils::DenseMatrix<DataType> m_data;
+            metrics::DistanceKernel m_kernel;
+            std::vector<np::Size> m_idx;
+            std::vector<NodeData> m_nodes;
+
+        private:
+            const Derived &derived() const {
+                return static_cast<const Derived &>(*this);
+            }
+
+            Derived &derived() {
+                return static_cast<Derived &>(*this);
+            }
+
+            void checkFeatures(const utils::DenseMatrix<DataType> &X) const {
+                if (X.cols() != m_data.cols()) {
+                    throw std::runtime_error("Number of features is different");
+                }
+            }
+
+            void recursiveBuild(np::Size i_node, np::Size idx_start, np::Size idx_end) {
+                auto &node = m_nodes[i_node];
+                node.idx_start = idx_start;
+                node.idx_end = idx_end;
+                node.is_leaf = 2 * i_node + 1 >= m_nodes.size() || idx_end - idx_start < 2;
+                derived().initNode(i_node);
+                if (node.is_leaf) {
+                    return;
+                }
+
+                const np::Size split_dim = findSplitDim(idx_start, idx_end);
+                const np::Size idx_mid = idx_start + (idx_end - idx_start) / 2;
+                std::nth_element(m_idx.begin() + idx_start, m_idx.begin() + idx_mid, m_idx.begin() + idx_end, [this, split_dim](np::Size a, np::Size b) {
+                    const auto va = m_data.row(a)[split_dim];
+                    const auto vb = m_data.row(b)[split_dim];
+                    return va < vb || (va == vb && a < b);
+                });
+                recursiveBuild(2 * i_node + 1, idx_start, idx_mid);
+                recursiveBuild(2 * i_node + 2, idx_mid, idx_end);
+            }
+
+            // The dimension of the largest spread of the points in the range.
+            np::Size findSplitDim(np::Size idx_start, np::Size idx_end) const {
+                np::Size split_dim = 0;
+                np::float_ max_spread = -1;
+                for (np::Size j = 0; j < m_data.cols(); ++j) {
+                    auto min_val = static_cast<np::float_>(m_data.row(m_idx[idx_start])[j]);
+                    auto max_val = min_val;
+                    for (np::Size i = idx_start + 1; i < idx_end; ++i) {
+                        const auto val = static_cast<np::float_>(m_data.row(m_idx[i])[j]);
+                        min_val = std::min(min_val, val);
+                        max_val = std::max(max_val, val);
+                    }
+                    if (max_val - min_val > max_spread) {
+                        max_spread = max_val - min_val;
+                        split_dim = j;
+                    }
+                }
+                return split_dim;
+            }
+
+            void querySingle(np::Size i_node, const DataType *point, np::Size row, NeighborsHeap &heap, np::float_ rdist_lower_bound) const {
+                if (rdist_lower_bound > heap.largest(row)) {
+                    return;
+                }
+                const auto &node = m_nodes[i_node];
+                if (node.is_leaf) {
+                    for (np::Size i = node.idx_start; i < node.idx_end; ++i) {
+                        const auto idx = m_idx[i];
+                        heap.push(row, m_kernel.rdist(point, m_data.row(idx), m_data.cols()), idx);
+                    }
+                    return;
+                }
+                // visit the closer child first to tighten the bound as early as possible
+                const np::Size i1 = 2 * i_node + 1;
+                const np::Size i2 = i1 + 1;
+                const auto rdist1 = derived().minRdist(i1, point);
+                const auto rdist2 = derived().minRdist(i2, point);
+                if (rdist1 <= rdist2) {
+                    querySingle(i1, point, row, heap, rdist1);
+                    querySingle(i2, point, row, heap, rdist2);
+                } else {
+                    querySingle(i2, point, row, heap, rdist2);
+                    querySingle(i1, point, row, heap, rdist1);
+                }
+            }
+
+            void queryRadiusSingle(np::Size i_node, const DataType *point, np::float_ rdist_bound, std::vector<np::Size> &indices, std::vector<np::float_> &distances) const {
+                if (derived().minRdist(i_node, point) > rdist_bound) {
+                    return;
+                }
+                const auto &node = m_nodes[i_node];
+                if (node.is_leaf) {
+                    for (np::Size i = node.idx_start; i < node.idx_end; ++i) {
+                        const auto idx = m_idx[i];
+                        const auto rdist = m_kernel.rdist(point, m_data.row(idx), m_data.cols());
+                        if (rdist <= rdist_bound) {
+                            indices.push_back(idx);
+                            distances.push_back(rdist);
+                        }
+                    }
+                    return;
+                }
+                queryRadiusSingle(2 * i_node + 1, point, rdist_bound, indices, distances);
+                queryRadiusSingle(2 * i_node + 2, point, rdist_bound, indices, distances);
+            }
+
+            np::Size m_leafSize{40};
+        };
+    }// namespace neighbors
+}// namespace sklearn
@@ -0,0 +1,155 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/PairwiseDistancesReduction.hpp>
+#include <sklearn/neighbors/BinaryTree.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        // Exhaustive k nearest neighbors search of the rows of X among the rows of Y.
+        // Returns the sorted heap of reduced distances, the same result as BinaryTree::query.
+        // n_jobs - number of threads the chunks of X are spread over, see utils::effective_n_jobs.
+        template<typename DataType>
+        NeighborsHeap brute_force_query(const utils::DenseMatrix<DataType> &X, const utils::DenseMatrix<DataType> &Y, const metrics::DistanceKernel &kernel, np::Size k, np::Size chunk_size = 256, int n_jobs = 1) {
+            if (k < 1 || k > Y.rows()) {
+                throw std::runtime_error("k must be in range [1, n_samples]");
+            }
+            NeighborsHeap heap{X.rows(), k};
+            metrics::pairwise_distances_reduction(
+                    X, Y, kernel,
+                    [&heap](np::Size x_start, np::Size x_end, np::Size y_start, np::Size y_end, const auto *tile) {
+                        for (np::Size i = x_start; i < x_end; ++i) {
+                            auto largest = heap.largest(i);
+                            for (np::Size j = y_start; j < y_end; ++j, ++tile) {
+                                if (*tile <= largest && heap.push(i, *tile, j)) {
+                                    largest = heap.largest(i);
+                                }
+                            }
+                        }
+                    },
+                    chunk_size, n_jobs);
+            heap.sort();
+            return heap;
+        }
+
+        // Exhaustive search of the heap.k() nearest rows of Y to one point into the row of the heap, which must be
+        // empty (see NeighborsHeap::reset), sorted. For single queries of a serving path: the reduced distances are
+        // computed pair by pair, with no tile to allocate, so Euclidean distances may differ from the expanded ones of
+        // brute_force_query in the last bits and neighbors at near-equal distances may come in another order.
+        template<typename DataType>
+        void brute_force_query_point(const DataType *point, const utils::DenseMatrix<DataType> &Y, const metrics::DistanceKernel &kernel, NeighborsHeap &heap, np::Size row = 0) {
+            kernel.visit([&](const auto &rdist) {
+                auto largest = heap.largest(row);
+                for (np::Size j = 0; j < Y.rows(); ++j) {
+                    const np::float_ distance = rdist(point, Y.row(j), Y.cols());
+                    if (distance <= largest && heap.push(row, distance, j)) {
+                        largest = heap.largest(row);
+                    }
+                }
+            });
+            heap.sort(row);
+        }
+
+        // Exhaustive search of the rows of Y within the radius r of every row of X, the same result as BinaryTree::query_radius.
+        // Every chunk of X collects its neighbors in flat buffers, grouped by query once its last tile is reduced, and
+        // the chunks are concatenated in order (see internal::RadiusBlock), so the neighbors of a query are in
+        // increasing order of index unless sort_results is set, and the result does not depend on n_jobs.
+        template<typename DataType>
+        RadiusNeighbors brute_force_query_radius(const utils::DenseMatrix<DataType> &X, const utils::DenseMatrix<DataType> &Y, const metrics::DistanceKernel &kernel, np::float_ r, bool sort_results = false, np::Size chunk_size = 256, int n_jobs = 1) {
+            if (Y.empty()) {
+                throw std::runtime_error("Y must not be empty");
+            }
+            if (r < 0) {
+                throw std::runtime_error("r must be non-negative");
+            }
+            if (chunk_size == 0) {
+                throw std::runtime_error("chunk_size must be positive");
+            }
+            const auto rdist_bound = kernel.dist_to_rdist(r);
+            const np::Size n_chunks = (X.rows() + chunk_size - 1) / chunk_size;
+            std::vector<internal::RadiusBlock> blocks(n_chunks);
+            // the query of every neighbor found so far in the chunk, in the order of the tiles
+            std::vector<std::vector<np::Size>> rows(n_chunks);
+            metrics::pairwise_distances_reduction(
+                    X, Y, kernel,
+                    [&](np::Size x_start, np::Size x_end, np::Size y_start, np::Size y_end, const auto *tile) {
+                        auto &block = blocks[x_start / chunk_size];
+                        auto &block_rows = rows[x_start / chunk_size];
+                        for (np::Size i = x_start; i < x_end; ++i) {
+                            for (np::Size j = y_start; j < y_end; ++j, ++tile) {
+                                if (*tile <= rdist_bound) {
+                                    block_rows.push_back(i - x_start);
+                                    block.indices.push_back(j);
+                                    block.distances.push_back(*tile);
+                                }
+                            }
+                        }
+                        if (y_end < Y.rows()) {
+                            return;
+                        }
+                        // stable counting sort by query: the neighbors of a query stay in increasing order of index
+                        block.counts.assign(x_end - x_start, 0);
+                        for (auto row: block_rows) {
+                            ++block.counts[row];
+                        }
+                        std::vector<np::Size> starts(block.counts.size() + 1, 0);
+                        for (np::Size row = 0; row < block.counts.size(); ++row) {
+                            starts[row + 1] = starts[row] + block.counts[row];
+                        }
+                        std::vector<np::Size> indices(block.indices.size());
+                        std::vector<np::float_> distances(block.distances.size());
+                        for (np::Size n = 0; n < block_rows.size(); ++n) {
+                            const auto position = starts[block_rows[n]]++;
+                            indices[position] = block.indices[n];
+                            distances[position] = block.distances[n];
+                        }
+                        block.indices = std::move(indices);
+                        block.distances = std::move(distances);
+                        std::vector<np::Size>{}.swap(block_rows);
+                        if (sort_results) {
+                            np::Size begin = 0;
+                            for (auto count: block.counts) {
+                                internal::sortNeighbors(block.indices, block.distances, begin, begin + count);
+                                begin += count;
+                            }
+                        }
+                        for (auto &distance: block.distances) {
+                            distance = kernel.rdist_to_dist(distance);
+                        }
+                    },
+                    chunk_size, n_jobs);
+            return internal::concatenateRadiusBlocks(blocks);
+        }
+    }// namespace neighbors
+}// namespace sklearn
@@ -0,0 +1,455 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/parallel.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        /// Parameters of the HNSW graph, see Hnsw.
+        struct HnswParameters {
+            /// The number of links of a node on the upper layers, 2 * M on the bottom layer. A larger M improves the
+            /// recall on high-dimensional data at the cost of memory and build time.
+            np::Size M{16};
+            /// The size of the candidate list when inserting a node. A larger value builds a better graph, slower.
+            np::Size ef_construction{200};
+            /// The size of the candidate list when searching, at least the number of neighbors. A larger value improves
+            /// the recall, slower.
+            np::Size ef{50};
+            /// Seed of the generator of the node levels: for a given seed and insertion order the graph is the same.
+            unsigned random_state{42};
+        };
+
+        // Approximate nearest neighbors on a hierarchical navigable small world graph (Malkov, Yashunin, 2016).
+        // Every node gets a random level with an exponentially decaying distribution and is linked to its nearest
+        // nodes, chosen by the neighbor selection heuristic, on every layer up to its level. A query descends greedily
+        // from the top layer and runs a best-first search with ef candidates on the bottom layer, so its cost grows
+        // roughly with log(n_samples) instead of n_samples, at the price of an occasionally missed neighbor.
+        // The graph is stored in flat arrays: the bottom layer has a block of 1 + 2 * M links (count first) per node,
+        // the upper layers of a node are consecutive blocks of 1 + M links in a shared array. Nodes can be added after
+        // the construction, queries are const and can run concurrently.
+        // Distances are the reduced distances of metrics::DistanceKernel, so every metric of DistanceMetricType works.
+        // X - initial points of shape (n_samples, n_features), may be a utils::DenseMatrix::view (added points are
+        // always copied)
+        template<typename DataType = np::float_>
+        class Hnsw {
+        public:
+            using Link = std::uint32_t;
+
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            explicit Hnsw(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, HnswParameters parameters = {}, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : Hnsw(utils::DenseMatrix<DataType>{X}, parameters, metric, p) {
+            }
+
+            explicit Hnsw(utils::DenseMatrix<DataType> X, HnswParameters parameters = {}, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : m_parameters{parameters}, m_kernel{metric, p}, m_data{std::move(X)}, m_nFeatures{m_data.cols()},
+                  m_maxLinks0{2 * parameters.M}, m_levelMultiplier{1 / std::log(static_cast<np::float_>(std::max<np::Size>(parameters.M, 2)))},
+                  m_generator{parameters.random_state} {
+                if (m_data.empty()) {
+                    throw std::runtime_error("X must not be empty");
+                }
+                if (m_parameters.M < 2) {
+                    throw std::runtime_error("M must be greater or equal to 2");
+                }
+                if (m_parameters.ef_construction < 1 || m_parameters.ef < 1) {
+                    throw std::runtime_error("ef_construction and ef must be positive");
+                }
+                for (np::Size i = 0; i < m_data.rows(); ++i) {
+                    insert();
+                }
+            }
+
+            // Inserts the rows of X into the graph, with the indices n_samples(), n_samples() + 1, ...
+            void add(const utils::DenseMatrix<DataType> &X) {
+                checkFeatures(X);
+                m_added.insert(m_added.end(), X.data(), X.data() + X.rows() * X.cols());
+                for (np::Size i = 0; i < X.rows(); ++i) {
+                    insert();
+                }
+            }
+
+            // Sets the size of the candidate list of the following queries.
+            void set_ef(np::Size ef) {
+                if (ef < 1) {
+                    throw std::runtime_error("ef must be positive");
+                }
+                m_parameters.ef = ef;
+            }
+
+            // Query the graph for the approximate k nearest neighbors.
+            // X - query points of shape (n_queries, n_features)
+            // k - number of nearest neighbors to return
+            // Returns distances and indices of the neighbors, both of shape (n_queries, k), sorted by increasing distance.
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            std::pair<np::Array<np::float_>, np::Array<np::Size>> query(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, np::Size k = 1) const {
+                auto heap = query(utils::DenseMatrix<DataType>{X}, k);
+                heap.transform([this](np::float_ rdist) { return m_kernel.rdist_to_dist(rdist); });
+                np::Shape shape{heap.n_queries(), k};
+                auto [distances, indices] = heap.release();
+                return {np::Array<np::float_>{std::move(distances), shape}, np::Array<np::Size>{std::move(indices), shape}};
+            }
+
+            // The approximate k nearest neighbors of every row of X.
+            // Returns the sorted heap of reduced distances, see metrics::DistanceKernel.
+            // n_jobs - number of threads the queries are spread over, see utils::effective_n_jobs. Every query is
+            // searched on its own, so the result does not depend on it.
+            NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k = 1, int n_jobs = 1) const {
+                checkFeatures(X);
+                if (k < 1 || k > n_samples()) {
+                    throw std::runtime_error("k must be in range [1, n_samples]");
+                }
+                const np::Size ef = std::max(m_parameters.ef, k);
+                NeighborsHeap heap{X.rows(), k};
+                const auto n_rows = static_cast<long>(X.rows());
+                [[maybe_unused]] const int n_threads = utils::effective_n_jobs(n_jobs);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+                {
+                    Scratch scratch;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+                    for (long row = 0; row < n_rows; ++row) {
+                        querySingle(X.row(static_cast<np::Size>(row)), static_cast<np::Size>(row), ef, heap, scratch);
+                    }
+                }
+                heap.sort();
+                return heap;
+            }
+
+            // The approximate heap.k() nearest neighbors of one point of n_features() features into the row of the
+            // heap, which must be empty (see NeighborsHeap::reset), sorted. The search buffers are kept by the calling
+            // thread, so once they have grown to the index the search allocates nothing.
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const {
+                thread_local Scratch scratch;
+                querySingle(point, row, std::max(m_parameters.ef, heap.k()), heap, scratch);
+                heap.sort(row);
+            }
+
+            [[nodiscard]] np::Size n_samples() const {
+                return m_levels.size();
+            }
+
+            [[nodiscard]] np::Size n_features() const {
+                return m_nFeatures;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const {
+                return m_kernel;
+            }
+
+        private:
+            using Candidate = std::pair<np::float_, Link>;
+
+            // Marks of the nodes visited by a search, reset in O(1) by incrementing the epoch.
+            struct VisitedList {
+                std::vector<std::uint32_t> marks;
+                std::uint32_t epoch{0};
+
+                void reset(np::Size n) {
+                    if (marks.size() < n) {
+                        marks.resize(n, 0);
+                    }
+                    if (++epoch == 0) {
+                        std::fill(marks.begin(), marks.end(), 0);
+                        epoch = 1;
+                    }
+                }
+
+                // Marks the node, returns false if it was already marked.
+                bool visit(Link node) {
+                    if (marks[node] == epoch) {
+                        return false;
+                    }
+                    marks[node] = epoch;
+                    return true;
+                }
+            };
+
+            // Buffers of a search, kept by every thread for all its queries.
+            struct Scratch {
+                VisitedList visited;
+                // entry points of a layer search
+                std::vector<Candidate> entries;
+                // min-heap of the nodes to expand
+                std::vector<Candidate> candidates;
+                // max-heap of the ef nearest nodes found
+                std::vector<Candidate> top;
+            };
+
+            void checkFeatures(const utils::DenseMatrix<DataType> &X) const {
+                if (X.cols() != m_nFeatures) {
+                    throw std::runtime_error("Number of features is different");
+                }
+            }
+
+            [[nodiscard]] const DataType *sample(np::Size node) const {
+                return node < m_data.rows() ? m_data.row(node) : m_added.data() + (node - m_data.rows()) * m_nFeatures;
+            }
+
+            // The link block of the node on the level: the number of links followed by the links.
+            [[nodiscard]] const Link *links(Link node, int level) const {
+                if (level == 0) {
+                    return m_links0.data() + static_cast<np::Size>(node) * (m_maxLinks0 + 1);
+                }
+                return m_upperLinks.data() + m_upperOffsets[node] + static_cast<np::Size>(level - 1) * (m_parameters.M + 1);
+            }
+
+            Link *links(Link node, int level) {
+                return const_cast<Link *>(std::as_const(*this).links(node, level));
+            }
+
+            // The ef nearest nodes of the graph to the point pushed into the row of the heap. The pruned one-way links
+            // may leave nodes unreachable from the entry point: if the search reached fewer than ef nodes, the nodes it
+            // did not reach are scanned, so that the row always gets min(ef, n_samples()) >= k neighbors.
+            void querySingle(const DataType *point, np::Size row, np::Size ef, NeighborsHeap &heap, Scratch &scratch) const {
+                m_kernel.visit([&](const auto &rdist) {
+                    const Link entry = descend(rdist, point, 0);
+                    scratch.entries.assign(1, {rdist(point, sample(entry), m_nFeatures), entry});
+                    searchLayer(rdist, point, ef, 0, scratch);
+                    if (scratch.top.size() < std::min(ef, n_samples())) {
+                        scanUnreached(rdist, point, ef, scratch);
+                    }
+                });
+                for (const auto &[distance, node]: scratch.top) {
+                    heap.push(row, distance, node);
+                }
+            }
+
+            // Greedy search from the entry point of the graph down to the layer above the level.
+            template<typename Rdist>
+            Link descend(const Rdist &rdist, const DataType *point, int level) const {
+                Link current = m_entryPoint;
+                np::float_ distance = rdist(point, sample(current), m_nFeatures);
+                for (int layer = m_maxLevel; layer > level; --layer) {
+                    for (bool changed = true; changed;) {
+                        changed = false;
+                        const Link *block = links(current, layer);
+                        for (Link i = 1; i <= block[0]; ++i) {
+                            const np::float_ d = rdist(point, sample(block[i]), m_nFeatures);
+                            if (d < distance) {
+                                distance = d;
+                                current = block[i];
+                                changed = true;
+                            }
+                        }
+                    }
+                }
+                return current;
+            }
+
+            // Best-first search of the ef nearest nodes on the layer from scratch.entries, found in scratch.top.
+            template<typename Rdist>
+            void searchLayer(const Rdist &rdist, const DataType *point, np::Size ef, int level, Scratch &scratch) const {
+                auto &[visited, entries, candidates, top] = scratch;
+                visited.reset(n_samples());
+                candidates.clear();
+                top.clear();
+                for (const auto &entry: entries) {
+                    visited.visit(entry.second);
+                    candidates.push_back(entry);
+                    top.push_back(entry);
+                }
+                std::make_heap(candidates.begin(), candidates.end(), std::greater<>{});
+                std::make_heap(top.begin(), top.end());
+                while (top.size() > ef) {
+                    std::pop_heap(top.begin(), top.end());
+                    top.pop_back();
+                }
+                while (!candidates.empty()) {
+                    std::pop_heap(candidates.begin(), candidates.end(), std::greater<>{});
+                    const Candidate nearest = candidates.back();
+                    candidates.pop_back();
+                    if (nearest.first > top.front().first && top.size() >= ef) {
+                        break;
+                    }
+                    const Link *block = links(nearest.second, level);
+                    for (Link i = 1; i <= block[0]; ++i) {
+                        const Link node = block[i];
+                        if (!visited.visit(node)) {
+                            continue;
+                        }
+                        const np::float_ d = rdist(point, sample(node), m_nFeatures);
+                        if (top.size() < ef || d < top.front().first) {
+                            candidates.emplace_back(d, node);
+                            std::push_heap(candidates.begin(), candidates.end(), std::greater<>{});
+                            top.emplace_back(d, node);
+                            std::push_heap(top.begin(), top.end());
+                            if (top.size() > ef) {
+                                std::pop_heap(top.begin(), top.end());
+                                top.pop_back();
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Adds the nodes not visited by the last searchLayer to the ef nearest nodes of scratch.top.
+            template<typename Rdist>
+            void scanUnreached(const Rdist &rdist, const DataType *point, np::Size ef, Scratch &scratch) const {
+                auto &[visited, entries, candidates, top] = scratch;
+                for (np::Size node = 0; node < n_samples(); ++node) {
+                    if (!visited.visit(static_cast<Link>(node))) {
+                        continue;
+                    }
+                    const np::float_ d = rdist(point, sample(node), m_nFeatures);
+                    if (top.size() < ef || d < top.front().first) {
+                        top.emplace_back(d, static_cast<Link>(node));
+                        std::push_heap(top.begin(), top.end());
+                        if (top.size() > ef) {
+                            std::pop_heap(top.begin(), top.end());
+                            top.pop_back();
+                        }
+                    }
+                }
+            }
+
+            // Keeps at most max_links of the sorted candidates, skipping a candidate closer to an already kept one
+            // than to the base point, so that links point in diverse directions (the heuristic of the paper).
+            template<typename Rdist>
+            void selectNeighbors(const Rdist &rdist, std::vector<Candidate> &candidates, np::Size max_links) const {
+                std::sort(candidates.begin(), candidates.end());
+                np::Size kept = 0;
+                for (np::Size i = 0; i < candidates.size() && kept < max_links; ++i) {
+                    const auto &[distance, node] = candidates[i];
+                    bool diverse = true;
+                    for (np::Size j = 0; j < kept && diverse; ++j) {
+                        diverse = rdist(sample(node), sample(candidates[j].second), m_nFeatures) >= distance;
+                    }
+                    if (diverse) {
+                        candidates[kept++] = candidates[i];
+                    }
+                }
+                candidates.resize(kept);
+            }
+
+            // Links the node to the new neighbor on the level, shrinking its links with the heuristic when full.
+            template<typename Rdist>
+            void connect(const Rdist &rdist, Link node, Link neighbor, int level) {
+                const np::Size max_links = level == 0 ? m_maxLinks0 : m_parameters.M;
+                Link *block = links(node, level);
+                if (block[0] < max_links) {
+                    block[++block[0]] = neighbor;
+                    return;
+                }
+                auto &candidates = m_scratch.candidates;
+                candidates.clear();
+                const DataType *base = sample(node);
+                for (Link i = 1; i <= block[0]; ++i) {
+                    candidates.emplace_back(rdist(base, sample(block[i]), m_nFeatures), block[i]);
+                }
+                candidates.emplace_back(rdist(base, sample(neighbor), m_nFeatures), neighbor);
+                selectNeighbors(rdist, candidates, max_links);
+                block[0] = static_cast<Link>(candidates.size());
+                for (np::Size i = 0; i < candidates.size(); ++i) {
+                    block[i + 1] = candidates[i].second;
+                }
+            }
+
+            int randomLevel() {
+                std::uniform_real_distribution<np::float_> distribution{0, 1};
+                return static_cast<int>(-std::log(1 - distribution(m_generator)) * m_levelMultiplier);
+            }
+
+            // Inserts the next stored vector into the graph.
+            void insert() {
+                const np::Size index = m_levels.size();
+                if (index >= std::numeric_limits<Link>::max()) {
+                    throw std::runtime_error("Too many samples for Hnsw");
+                }
+                const auto node = static_cast<Link>(index);
+                const int level = randomLevel();
+                m_levels.push_back(level);
+                m_links0.resize(m_links0.size() + m_maxLinks0 + 1, 0);
+                m_upperOffsets.push_back(m_upperLinks.size());
+                m_upperLinks.resize(m_upperLinks.size() + static_cast<np::Size>(level) * (m_parameters.M + 1), 0);
+                if (node == 0) {
+                    m_entryPoint = 0;
+                    m_maxLevel = level;
+                    return;
+                }
+                const DataType *point = sample(node);
+                m_kernel.visit([&](const auto &rdist) {
+                    const Link entry = descend(rdist, point, level);
+                    m_scratch.entries.assign(1, {rdist(point, sample(entry), m_nFeatures), entry});
+                    for (int layer = std::min(level, m_maxLevel); layer >= 0; --layer) {
+                        searchLayer(rdist, point, m_parameters.ef_construction, layer, m_scratch);
+                        // the candidates found are the entry points of the next layer
+                        m_scratch.entries = m_scratch.top;
+                        auto &neighbors = m_scratch.top;
+                        selectNeighbors(rdist, neighbors, m_parameters.M);
+                        Link *block = links(node, layer);
+                        block[0] = static_cast<Link>(neighbors.size());
+                        for (np::Size i = 0; i < neighbors.size(); ++i) {
+                            block[i + 1] = neighbors[i].second;
+                        }
+                        // connect may reuse the scratch buffers
+                        m_selected.assign(block + 1, block + 1 + block[0]);
+                        for (const Link neighbor: m_selected) {
+                            connect(rdist, neighbor, node, layer);
+                        }
+                    }
+                });
+                if (level > m_maxLevel) {
+                    m_entryPoint = node;
+                    m_maxLevel = level;
+                }
+            }
+
+            HnswParameters m_parameters;
+            metrics::DistanceKernel m_kernel;
+            // the initial points, the points added later follow in m_added
+            const utils::DenseMatrix<DataType> m_data;
+            std::vector<DataType> m_added;
+            np::Size m_nFeatures;
+            np::Size m_maxLinks0;
+            np::float_ m_levelMultiplier;
+            std::mt19937 m_generator;
+            std::vector<int> m_levels;
+            std::vector<Link> m_links0;
+            std::vector<np::Size> m_upperOffsets;
+            std::vector<Link> m_upperLinks;
+            Link m_entryPoint{0};
+            int m_maxLevel{0};
+            // buffers of the insertion
+            Scratch m_scratch;
+            std::vector<Link> m_selected;
+        };
+    }// namespace neighbors
+}// namespace sklearn
@@ -0,0 +1,464 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/parallel.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        /// Parameters of the IvfPq index, see IvfPq.
+        struct IvfPqParameters {
+            /// The number of inverted lists, the coarse k-means centroids.
+            np::Size n_lists{256};
+            /// The number of sub-vectors a residual is split into, each encoded in one byte. Must divide n_features.
+            np::Size n_subquantizers{8};
+            /// The number of lists searched by a query. More lists improve the recall, slower.
+            np::Size n_probe{8};
+            /// The number of candidates re-ranked with exact distances on the original vectors, 0 - no re-ranking.
+            /// The original vectors are kept by the index only if re-ranking is enabled.
+            np::Size rerank{0};
+            /// The number of iterations of k-means training the coarse centroids and the codebooks.
+            np::Size max_iter{20};
+            /// The number of samples, randomly chosen, the centroids and the codebooks are trained on, at least n_lists.
+            /// k-means needs some tens of samples per centroid, the training time grows linearly with it.
+            np::Size max_train{16384};
+            /// Seed of the training sample and of the k-means initialization.
+            unsigned random_state{42};
+        };
+
+        namespace internal {
+            // Lloyd's k-means of the n rows of data (row-major, d columns) into k clusters, assigning the rows by the
+            // reduced distance of the kernel. Initialized with k distinct random rows, empty clusters are re-seeded
+            // with a random row. Returns the k centroids, row-major.
+            inline std::vector<np::float_> kmeans(const metrics::DistanceKernel &kernel, const std::vector<np::float_> &data, np::Size n, np::Size d, np::Size k, np::Size max_iter, std::mt19937 &generator) {
+                std::vector<np::float_> centroids(k * d);
+                std::vector<np::Size> seeds(k);
+                std::ranges::sample(std::views::iota(np::Size{0}, n), seeds.begin(), static_cast<long>(k), generator);
+                for (np::Size c = 0; c < k; ++c) {
+                    std::copy_n(data.begin() + static_cast<long>(seeds[c] * d), d, centroids.begin() + static_cast<long>(c * d));
+                }
+                std::vector<np::Size> assignment(n, k);
+                std::vector<np::Size> counts(k);
+                std::uniform_int_distribution<np::Size> random_row{0, n - 1};
+                kernel.visit([&](const auto &rdist) {
+                    for (np::Size iter = 0; iter < max_iter; ++iter) {
+                        bool changed = false;
+                        for (np::Size i = 0; i < n; ++i) {
+                            const np::float_ *x = data.data() + i * d;
+                            np::Size best = 0;
+                            np::float_ best_rdist = std::numeric_limits<np::float_>::infinity();
+                            for (np::Size c = 0; c < k; ++c) {
+                                const np::float_ r = rdist(x, centroids.data() + c * d, d);
+                                if (r < best_rdist) {
+                                    best_rdist = r;
+                                    best = c;
+                                }
+                            }
+                            changed |= assignment[i] != best;
+                            assignment[i] = best;
+                        }
+                        if (!changed) {
+                            break;
+                        }
+                        std::fill(centroids.begin(), centroids.end(), np::float_{0});
+                        std::fill(counts.begin(), counts.end(), np::Size{0});
+                        for (np::Size i = 0; i < n; ++i) {
+                            ++counts[assignment[i]];
+                            for (np::Size j = 0; j < d; ++j) {
+                                centroids[assignment[i] * d + j] += data[i * d + j];
+                            }
+                        }
+                        for (np::Size c = 0; c < k; ++c) {
+                            if (counts[c] == 0) {
+                                std::copy_n(data.begin() + static_cast<long>(random_row(generator) * d), d, centroids.begin() + static_cast<long>(c * d));
+                                continue;
+                            }
+                            for (np::Size j = 0; j < d; ++j) {
+                                centroids[c * d + j] /= static_cast<np::float_>(counts[c]);
+                            }
+                        }
+                    }
+                });
+                return centroids;
+            }
+
+            // Asymmetric distance computation: the reduced distances of n_codes codes of n_subspaces bytes to a query,
+            // summed (or for Chebyshev, maximized) from its lookup table of n_subspaces x ksub partial distances.
+            // The loop runs over the codes in the inner loop, so every level vectorizes it with gathers.
+            struct AdcScan {
+                SKLEARN_ALWAYS_INLINE static void run(const np::float_ *table, np::Size n_subspaces, np::Size ksub, const std::uint8_t *codes, np::Size n_codes, bool use_max, np::float_ *out) {
+                    std::fill(out, out + n_codes, np::float_{0});
+                    for (np::Size s = 0; s < n_subspaces; ++s) {
+                        const np::float_ *partial = table + s * ksub;
+                        const std::uint8_t *code = codes + s;
+                        if (use_max) {
+                            for (np::Size i = 0; i < n_codes; ++i) {
+                                out[i] = std::max(out[i], partial[code[i * n_subspaces]]);
+                            }
+                        } else {
+                            for (np::Size i = 0; i < n_codes; ++i) {
+                                out[i] += partial[code[i * n_subspaces]];
+                            }
+                        }
+                    }
+                }
+            };
+        }// namespace internal
+
+        // Compressed approximate nearest neighbors: an inverted file with product-quantized residuals (Jegou et al.,
+        // 2011). The samples are split into n_lists lists by coarse k-means centroids; the residual of a sample to its
+        // centroid is split into n_subquantizers sub-vectors, each replaced by the one-byte index of its nearest
+        // codeword of a per-subspace codebook of up to 256 codewords. The index keeps n_subquantizers bytes of code and
+        // a 4-byte id per sample instead of the n_features values, in flat arrays ordered by list.
+        // A query ranks the centroids, then scans the codes of the n_probe nearest lists with a lookup table of the
+        // partial distances of its residual to the codewords, so a code costs n_subquantizers additions.
+        // With rerank > 0 the best rerank candidates are re-ranked with exact distances on the original vectors,
+        // which the index then keeps (pass a utils::DenseMatrix::view to keep them without a copy).
+        // Distances are the reduced distances of metrics::DistanceKernel, every metric of DistanceMetricType works.
+        template<typename DataType = np::float_>
+        class IvfPq {
+        public:
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            explicit IvfPq(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, IvfPqParameters parameters = {}, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : IvfPq(utils::DenseMatrix<DataType>{X}, parameters, metric, p) {
+            }
+
+            explicit IvfPq(utils::DenseMatrix<DataType> X, IvfPqParameters parameters = {}, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : m_parameters{parameters}, m_kernel{metric, p}, m_nSamples{X.rows()}, m_nFeatures{X.cols()} {
+                if (X.empty()) {
+                    throw std::runtime_error("X must not be empty");
+                }
+                if (m_nSamples > std::numeric_limits<std::uint32_t>::max()) {
+                    throw std::runtime_error("Too many samples for IvfPq");
+                }
+                if (m_parameters.n_lists < 1 || m_parameters.n_lists > m_nSamples) {
+                    throw std::runtime_error("n_lists must be in range [1, n_samples]");
+                }
+                if (m_parameters.n_subquantizers < 1 || m_nFeatures % m_parameters.n_subquantizers != 0) {
+                    throw std::runtime_error("n_subquantizers must divide n_features");
+                }
+                if (m_parameters.n_probe < 1) {
+                    throw std::runtime_error("n_probe must be positive");
+                }
+                m_subDim = m_nFeatures / m_parameters.n_subquantizers;
+                train(X);
+                encode(X);
+                if (m_parameters.rerank > 0) {
+                    m_data = std::move(X);
+                }
+            }
+
+            // Sets the number of lists searched by the following queries.
+            void set_n_probe(np::Size n_probe) {
+                if (n_probe < 1) {
+                    throw std::runtime_error("n_probe must be positive");
+                }
+                m_parameters.n_probe = n_probe;
+            }
+
+            // Query the index for the approximate k nearest neighbors.
+            // X - query points of shape (n_queries, n_features)
+            // k - number of nearest neighbors to return
+            // Returns distances and indices of the neighbors, both of shape (n_queries, k), sorted by increasing distance.
+            // Distances are exact for re-ranked candidates and approximated from the codes otherwise.
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            std::pair<np::Array<np::float_>, np::Array<np::Size>> query(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, np::Size k = 1) const {
+                auto heap = query(utils::DenseMatrix<DataType>{X}, k);
+                heap.transform([this](np::float_ rdist) { return m_kernel.rdist_to_dist(rdist); });
+                np::Shape shape{heap.n_queries(), k};
+                auto [distances, indices] = heap.release();
+                return {np::Array<np::float_>{std::move(distances), shape}, np::Array<np::Size>{std::move(indices), shape}};
+            }
+
+            // The approximate k nearest neighbors of every row of X.
+            // Returns the sorted heap of reduced distances, see metrics::DistanceKernel. Lists are scanned until at
+            // least n_probe lists and k (or rerank) samples have been seen.
+            // n_jobs - number of threads the queries are spread over, see utils::effective_n_jobs. Every query is
+            // searched on its own, so the result does not depend on it.
+            NeighborsHeap query(const utils::DenseMatrix<DataType> &X, np::Size k = 1, int n_jobs = 1) const {
+                if (X.cols() != m_nFeatures) {
+                    throw std::runtime_error("Number of features is different");
+                }
+                if (k < 1 || k > m_nSamples) {
+                    throw std::runtime_error("k must be in range [1, n_samples]");
+                }
+                const np::Size n_candidates = m_parameters.rerank > 0 ? std::max(m_parameters.rerank, k) : k;
+                NeighborsHeap heap{X.rows(), k};
+                const auto n_rows = static_cast<long>(X.rows());
+                [[maybe_unused]] const int n_threads = utils::effective_n_jobs(n_jobs);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+                {
+                    Scratch scratch;
+                    scratch.resize(m_parameters.n_lists, m_nFeatures, m_parameters.n_subquantizers * m_ksub);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+                    for (long row = 0; row < n_rows; ++row) {
+                        querySingle(X.row(static_cast<np::Size>(row)), static_cast<np::Size>(row), n_candidates, heap, scratch);
+                    }
+                }
+                heap.sort();
+                return heap;
+            }
+
+            // The approximate heap.k() nearest neighbors of one point of n_features() features into the row of the
+            // heap, which must be empty (see NeighborsHeap::reset), sorted. The lookup tables and the candidates are
+            // kept by the calling thread, so once they have grown to the index the search allocates nothing.
+            void query_point(const DataType *point, NeighborsHeap &heap, np::Size row = 0) const {
+                thread_local Scratch scratch;
+                scratch.resize(m_parameters.n_lists, m_nFeatures, m_parameters.n_subquantizers * m_ksub);
+                const np::Size n_candidates = m_parameters.rerank > 0 ? std::max(m_parameters.rerank, heap.k()) : heap.k();
+                scratch.candidates.reserve(n_candidates);
+                querySingle(point, row, n_candidates, heap, scratch);
+                heap.sort(row);
+            }
+
+            [[nodiscard]] np::Size n_samples() const {
+                return m_nSamples;
+            }
+
+            [[nodiscard]] np::Size n_features() const {
+                return m_nFeatures;
+            }
+
+            [[nodiscard]] const metrics::DistanceKernel &kernel() const {
+                return m_kernel;
+            }
+
+            // Bytes held by the compressed index: codes, ids, list offsets, centroids and codebooks, without the
+            // original vectors kept for re-ranking.
+            [[nodiscard]] np::Size index_size() const {
+                return m_codes.size() * sizeof(std::uint8_t) + m_ids.size() * sizeof(std::uint32_t) + m_listOffsets.size() * sizeof(np::Size) +
+                       (m_centroids.size() + m_codebooks.size()) * sizeof(np::float_);
+            }
+
+        private:
+            using Candidate = std::pair<np::float_, np::Size>;
+            static constexpr np::Size kMaxCodewords = 256;
+            static constexpr np::Size kScanBlock = 256;
+
+            // Buffers of a query, kept by every thread for all its queries.
+            struct Scratch {
+                // Sizes the buffers for an index, reusing their storage.
+                void resize(np::Size n_lists, np::Size n_features, np::Size table_size) {
+                    lists.resize(n_lists);
+                    residual.resize(n_features);
+                    table.resize(table_size);
+                    distances.resize(kScanBlock);
+                }
+
+                std::vector<Candidate> lists;
+                std::vector<np::float_> residual;
+                std::vector<np::float_> table;
+                std::vector<np::float_> distances;
+                // max-heap of the candidates to re-rank
+                std::vector<Candidate> candidates;
+            };
+
+            // Copies the row into the training buffer as np::float_.
+            void appendRow(const DataType *x, std::vector<np::float_> &buffer) const {
+                for (np::Size j = 0; j < m_nFeatures; ++j) {
+                    buffer.push_back(static_cast<np::float_>(x[j]));
+                }
+            }
+
+            // The nearest of the n centroids of dimension d to x.
+            template<typename Rdist, typename DType>
+            static np::Size nearest(const Rdist &rdist, const DType *x, const np::float_ *centroids, np::Size n, np::Size d) {
+                np::Size best = 0;
+                np::float_ best_rdist = std::numeric_limits<np::float_>::infinity();
+                for (np::Size c = 0; c < n; ++c) {
+                    const np::float_ r = rdist(x, centroids + c * d, d);
+                    if (r < best_rdist) {
+                        best_rdist = r;
+                        best = c;
+                    }
+                }
+                return best;
+            }
+
+            // Trains the coarse centroids and the codebooks of the residuals on a random sample of X.
+            void train(const utils::DenseMatrix<DataType> &X) {
+                std::mt19937 generator{m_parameters.random_state};
+                const np::Size n_train = std::min(m_nSamples, std::max(m_parameters.max_train, m_parameters.n_lists));
+                std::vector<np::Size> rows(n_train);
+                std::ranges::sample(std::views::iota(np::Size{0}, m_nSamples), rows.begin(), static_cast<long>(n_train), generator);
+                std::vector<np::float_> sample;
+                sample.reserve(n_train * m_nFeatures);
+                for (auto row: rows) {
+                    appendRow(X.row(row), sample);
+                }
+                m_centroids = internal::kmeans(m_kernel, sample, n_train, m_nFeatures, m_parameters.n_lists, m_parameters.max_iter, generator);
+
+                // residuals of the sample, then one codebook per subspace
+                m_kernel.visit([&](const auto &rdist) {
+                    for (np::Size i = 0; i < n_train; ++i) {
+                        np::float_ *x = sample.data() + i * m_nFeatures;
+                        const np::float_ *centroid = m_centroids.data() + nearest(rdist, x, m_centroids.data(), m_parameters.n_lists, m_nFeatures) * m_nFeatures;
+                        for (np::Size j = 0; j < m_nFeatures; ++j) {
+                            x[j] -= centroid[j];
+                        }
+                    }
+                });
+                m_ksub = std::min(kMaxCodewords, n_train);
+                const np::Size n_subspaces = m_parameters.n_subquantizers;
+                m_codebooks.resize(n_subspaces * m_ksub * m_subDim);
+                std::vector<np::float_> subvectors(n_train * m_subDim);
+                for (np::Size s = 0; s < n_subspaces; ++s) {
+                    for (np::Size i = 0; i < n_train; ++i) {
+                        std::copy_n(sample.begin() + static_cast<long>(i * m_nFeatures + s * m_subDim), m_subDim, subvectors.begin() + static_cast<long>(i * m_subDim));
+                    }
+                    const auto codebook = internal::kmeans(m_kernel, subvectors, n_train, m_subDim, m_ksub, m_parameters.max_iter, generator);
+                    std::copy(codebook.cbegin(), codebook.cend(), m_codebooks.begin() + static_cast<long>(s * m_ksub * m_subDim));
+                }
+            }
+
+            // Assigns every sample to its list and encodes its residual, then lays the lists out one after another.
+            void encode(const utils::DenseMatrix<DataType> &X) {
+                const np::Size n_subspaces = m_parameters.n_subquantizers;
+                std::vector<std::uint32_t> lists(m_nSamples);
+                std::vector<std::uint8_t> codes(m_nSamples * n_subspaces);
+                std::vector<np::float_> residual(m_nFeatures);
+                m_kernel.visit([&](const auto &rdist) {
+                    for (np::Size i = 0; i < m_nSamples; ++i) {
+                        const DataType *x = X.row(i);
+                        const np::Size list = nearest(rdist, x, m_centroids.data(), m_parameters.n_lists, m_nFeatures);
+                        lists[i] = static_cast<std::uint32_t>(list);
+                        for (np::Size j = 0; j < m_nFeatures; ++j) {
+                            residual[j] = static_cast<np::float_>(x[j]) - m_centroids[list * m_nFeatures + j];
+                        }
+                        for (np::Size s = 0; s < n_subspaces; ++s) {
+                            const np::float_ *codebook = m_codebooks.data() + s * m_ksub * m_subDim;
+                            codes[i * n_subspaces + s] = static_cast<std::uint8_t>(nearest(rdist, residual.data() + s * m_subDim, codebook, m_ksub, m_subDim));
+                        }
+                    }
+                });
+                // counting sort by list, stable so that ids stay increasing within a list
+                m_listOffsets.assign(m_parameters.n_lists + 1, 0);
+                for (auto list: lists) {
+                    ++m_listOffsets[list + 1];
+                }
+                for (np::Size l = 0; l < m_parameters.n_lists; ++l) {
+                    m_listOffsets[l + 1] += m_listOffsets[l];
+                }
+                std::vector<np::Size> position(m_listOffsets.cbegin(), m_listOffsets.cend() - 1);
+                m_ids.resize(m_nSamples);
+                m_codes.resize(m_nSamples * n_subspaces);
+                for (np::Size i = 0; i < m_nSamples; ++i) {
+                    const np::Size to = position[lists[i]]++;
+                    m_ids[to] = static_cast<std::uint32_t>(i);
+                    std::copy_n(codes.begin() + static_cast<long>(i * n_subspaces), n_subspaces, m_codes.begin() + static_cast<long>(to * n_subspaces));
+                }
+            }
+
+            void querySingle(const DataType *point, np::Size row, np::Size n_candidates, NeighborsHeap &heap, Scratch &scratch) const {
+                const np::Size n_subspaces = m_parameters.n_subquantizers;
+                const bool use_max = std::isinf(m_kernel.p());
+                const bool rerank = m_parameters.rerank > 0;
+                auto &[lists, residual, table, distances, candidates] = scratch;
+                candidates.clear();
+                m_kernel.visit([&](const auto &rdist) {
+                    for (np::Size l = 0; l < m_parameters.n_lists; ++l) {
+                        lists[l] = {rdist(point, m_centroids.data() + l * m_nFeatures, m_nFeatures), l};
+                    }
+                    std::sort(lists.begin(), lists.end());
+                    np::Size scanned = 0;
+                    for (np::Size probe = 0; probe < lists.size() && (probe < m_parameters.n_probe || scanned < n_candidates); ++probe) {
+                        const np::Size list = lists[probe].second;
+                        const np::Size begin = m_listOffsets[list];
+                        const np::Size end = m_listOffsets[list + 1];
+                        if (begin == end) {
+                            continue;
+                        }
+                        for (np::Size j = 0; j < m_nFeatures; ++j) {
+                            residual[j] = static_cast<np::float_>(point[j]) - m_centroids[list * m_nFeatures + j];
+                        }
+                        for (np::Size s = 0; s < n_subspaces; ++s) {
+                            const np::float_ *codebook = m_codebooks.data() + s * m_ksub * m_subDim;
+                            for (np::Size c = 0; c < m_ksub; ++c) {
+                                table[s * m_ksub + c] = rdist(residual.data() + s * m_subDim, codebook + c * m_subDim, m_subDim);
+                            }
+                        }
+                        for (np::Size block = begin; block < end; block += kScanBlock) {
+                            const np::Size n_codes = std::min(kScanBlock, end - block);
+                            utils::cpu_dispatch<internal::AdcScan>(table.data(), n_subspaces, m_ksub, m_codes.data() + block * n_subspaces, n_codes, use_max, distances.data());
+                            for (np::Size i = 0; i < n_codes; ++i) {
+                                const Candidate candidate{distances[i], m_ids[block + i]};
+                                if (!rerank) {
+                                    heap.push(row, candidate.first, candidate.second);
+                                } else if (candidates.size() < n_candidates) {
+                                    candidates.push_back(candidate);
+                                    std::push_heap(candidates.begin(), candidates.end());
+                                } else if (candidate < candidates.front()) {
+                                    std::pop_heap(candidates.begin(), candidates.end());
+                                    candidates.back() = candidate;
+                                    std::push_heap(candidates.begin(), candidates.end());
+                                }
+                            }
+                        }
+                        scanned += end - begin;
+                    }
+                    for (const auto &[distance, id]: candidates) {
+                        heap.push(row, rdist(point, m_data.row(id), m_nFeatures), id);
+                    }
+                });
+            }
+
+            IvfPqParameters m_parameters;
+            metrics::DistanceKernel m_kernel;
+            np::Size m_nSamples;
+            np::Size m_nFeatures;
+            np::Size m_subDim{0};
+            // the number of codewords of every codebook
+            np::Size m_ksub{0};
+            // n_lists x n_features
+            std::vector<np::float_> m_centroids;
+            // n_subquantizers x ksub x (n_features / n_subquantizers)
+            std::vector<np::float_> m_codebooks;
+            // the samples of list l are [m_listOffsets[l], m_listOffsets[l + 1]) of m_ids and m_codes
+            std::vector<np::Size> m_listOffsets;
+            std::vector<std::uint32_t> m_ids;
+            std::vector<std::uint8_t> m_codes;
+            // the original vectors, for re-ranking only
+            utils::DenseMatrix<DataType> m_data;
+        };
+    }// namespace neighbors
+}// namespace sklearn
@@ -22,15 +22,18 @@ SOFTWARE.
 
 #pragma once
 
+#include <algorithm>
 #include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include <np/Array.hpp>
-#include <scipy/stats/mode.hpp>
-#include <sklearn/metrics/Distance.hpp>
-#include <sklearn/metrics/DistanceMetric.hpp>
 #include <sklearn/metrics/DistanceMetricType.hpp>
 #include <sklearn/neighbors/AlgorithmType.hpp>
+#include <sklearn/neighbors/NeighborsBase.hpp>
 #include <sklearn/neighbors/WeightsType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
 
 namespace sklearn {
     namespace neighbors {
@@ -39,18 +42,163 @@ namespace sklearn {
         template<typename DType = np::DTypeDefault, Size SizeT = np::SIZE_DEFAULT>
         using Array = np::Array<DType, SizeT>;
 
-        using namespace scipy::stats;
-
         /// Classifier implementing the k-nearest neighbors vote.
         struct KNeighborsClassifierParameters {
             np::Size n_neighbors{5};
+            /// Weight function used in prediction:
+            /// kUniform - all points in each neighborhood are weighted equally;
+            /// kDistance - points are weighted by the inverse of their distance, closer neighbors of a query point
+            /// have a greater influence than neighbors which are further away;
+            /// kCallable - points are weighted by weights_callable of their distance.
             WeightsType weights{WeightsType::kUniform};
             AlgorithmType algorithm{AlgorithmType::kAuto};
             int leaf_size{30};
-            int p{2};
+            np::float_ p{2};
             metrics::DistanceMetricType metric{metrics::DistanceMetricType::kMinkowski};
+            /// The number of parallel jobs to run for neighbors search and voting. -1 means using all processors,
+            /// see utils::effective_n_jobs. Predictions do not depend on it.
+            int n_jobs{1};
+            /// The weight of a neighbor as a function of its distance, used with weights = kCallable.
+            WeightsCallable weights_callable{};
+            /// Graph parameters for algorithm = kHnsw, the approximate search.
+            HnswParameters hnsw{};
+            /// Index parameters for algorithm = kIvfPq, the approximate search on compressed vectors.
+            IvfPqParameters ivf_pq{};
+            /// Precision of the brute force distances on float32 data (DataType = float), see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
         };
 
+        namespace internal {
+            // The search and the votes of the classifiers over arrays and over data frames, on dense matrices of
+            // features and class labels of type Label.
+            // Every public method runs one search of the n_neighbors nearest neighbors of the queries. predict and
+            // predict_proba vote directly on its result, and predict_proba also accepts the result of kneighbors, so
+            // that ids and probabilities of the same queries cost a single search.
+            template<typename DataType, typename Label>
+            class KNeighborsClassifierImpl {
+            public:
+                explicit KNeighborsClassifierImpl(KNeighborsClassifierParameters parameters)
+                    : m_parameters{std::move(parameters)},
+                      m_base{m_parameters.algorithm, m_parameters.leaf_size, m_parameters.metric, m_parameters.p, m_parameters.n_jobs, m_parameters.hnsw, m_parameters.ivf_pq, m_parameters.accumulation} {
+                    checkWeights(m_parameters.weights, m_parameters.weights_callable);
+                }
+
+                void fit(utils::DenseMatrix<DataType> X, const std::vector<Label> &labels) {
+                    m_base.fit(std::move(X), labels.size(), m_parameters.n_neighbors);
+                    m_classes = encodeLabels(labels, m_codes);
+                }
+
+                [[nodiscard]] KNeighbors kneighbors(const utils::DenseMatrix<DataType> &X, std::optional<np::Size> n_neighbors, bool return_distance) const {
+                    return m_base.kneighbors(X, n_neighbors.value_or(m_parameters.n_neighbors), return_distance);
+                }
+
+                [[nodiscard]] std::vector<Label> predict(const utils::DenseMatrix<DataType> &X) const {
+                    const np::Size k = m_parameters.n_neighbors;
+                    const auto heap = m_base.kneighborsHeap(X, k, needDistances());
+                    Predictions<Label> pred(heap.n_queries());
+                    m_base.forEachQuery(
+                            heap.n_queries(), [&] { return Vote{m_classes.size(), k}; },
+                            [&](np::Size sample, Vote &vote) {
+                                vote.accumulate(m_parameters.weights, m_parameters.weights_callable, m_codes, heap.indices(sample), heap.distances(sample), k);
+                                pred[sample] = m_classes[vote.best(m_codes, heap.indices(sample), k)];
+                                vote.clear(m_codes, heap.indices(sample), k);
+                            });
+                    return labelsOf<Label>(std::move(pred));
+                }
+
+                // Predicts the labels of the n_samples row-major samples of X into out, spread over n_jobs threads.
+                // Every thread searches and votes in buffers it keeps for all its calls (see threadScratch), so once
+                // they have grown nothing is allocated, unless copying a Label does.
+                void predictInto(const DataType *X, np::Size n_samples, np::Size n_features, Label *out) const {
+                    const np::Size k = m_parameters.n_neighbors;
+                    m_base.checkQuery(n_features, k);
+                    m_base.forEachQuery(
+                            n_samples, [] { return &threadScratch<PointScratch>(); },
+                            [&](np::Size sample, PointScratch *scratch) {
+                                auto &[heap, vote] = *scratch;
+                                m_base.kneighborsPoint(X + sample * n_features, k, needDistances(), heap);
+                                vote.reserve(m_classes.size(), k);
+                                vote.accumulate(m_parameters.weights, m_parameters.weights_callable, m_codes, heap.indices(0), heap.distances(0), k);
+                                out[sample] = m_classes[vote.best(m_codes, heap.indices(0), k)];
+                                vote.clear(m_codes, heap.indices(0), k);
+                            });
+                }
+
+                [[nodiscard]] np::Array<np::float_> predict_proba(const utils::DenseMatrix<DataType> &X) const {
+                    const auto heap = m_base.kneighborsHeap(X, m_parameters.n_neighbors, needDistances());
+                    return probabilities(heap.n_queries(), heap.k(), heap.indices().data(), heap.distances().data());
+                }
+
+                [[nodiscard]] np::Array<np::float_> predict_proba(const KNeighbors &neighbors) const {
+                    m_base.checkFitted();
+                    const auto &[distances, indices] = neighbors;
+                    if (indices.ndim() != 2) {
+                        throw std::runtime_error("Neighbor indices must be 2-dimensional");
+                    }
+                    if (needDistances() && distances.size() != indices.size()) {
+                        throw std::runtime_error("Neighbor distances are required for weights other than Uniform");
+                    }
+                    std::vector<np::Size> index(indices.size());
+                    for (np::Size i = 0; i < index.size(); ++i) {
+                        index[i] = indices.get(i);
+                        if (index[i] >= m_codes.size()) {
+                            throw std::runtime_error("Neighbor index out of range");
+                        }
+                    }
+                    std::vector<np::float_> distance(needDistances() ? distances.size() : 0);
+                    for (np::Size i = 0; i < distance.size(); ++i) {
+                        distance[i] = distances.get(i);
+                    }
+                    return probabilities(indices.shape()[0], indices.shape()[1], index.data(), needDistances() ? distance.data() : nullptr);
+                }
+
+                [[nodiscard]] const std::vector<Label> &classes() const {
+                    return m_classes;
+                }
+
+                [[nodiscard]] AlgorithmType fitMethod() const {
+                    return m_base.fitMethod();
+                }
+
+            private:
+                // The buffers of predictInto kept by every thread.
+                struct PointScratch {
+                    NeighborsHeap heap;
+                    Vote vote{0, 0};
+                };
+
+                [[nodiscard]] bool needDistances() const {
+                    return m_parameters.weights != WeightsType::kUniform;
+                }
+
+                // Normalized class weights of the queries with k neighbors each, row-major indices and distances.
+                [[nodiscard]] np::Array<np::float_> probabilities(np::Size n_queries, np::Size k, const np::Size *indices, const np::float_ *distances) const {
+                    const np::Size n_classes = m_classes.size();
+                    std::vector<np::float_> proba(n_queries * n_classes);
+                    m_base.forEachQuery(
+                            n_queries, [&] { return Vote{n_classes, k}; },
+                            [&](np::Size row, Vote &vote) {
+                                const np::Size *neighbors = indices + row * k;
+                                const auto &histogram = vote.accumulate(m_parameters.weights, m_parameters.weights_callable, m_codes, neighbors,
+                                                                        distances == nullptr ? nullptr : distances + row * k, k);
+                                auto normalizer = std::accumulate(histogram.cbegin(), histogram.cend(), np::float_{0});
+                                if (normalizer == 0) {
+                                    normalizer = 1;
+                                }
+                                std::transform(histogram.cbegin(), histogram.cend(), proba.begin() + static_cast<long>(row * n_classes), [normalizer](np::float_ w) { return w / normalizer; });
+                                vote.clear(m_codes, neighbors, k);
+                            });
+                    return np::Array<np::float_>{std::move(proba), np::Shape{n_queries, n_classes}};
+                }
+
+                KNeighborsClassifierParameters m_parameters;
+                NeighborsBase<DataType> m_base;
+                std::vector<Label> m_classes;
+                // the index in m_classes of the label of every training sample
+                std::vector<np::Size> m_codes;
+            };
+        }// namespace internal
+
         template<typename DataType, typename TargetType = DataType>
         class KNeighborsClassifier;
 
@@ -58,13 +206,7 @@ namespace sklearn {
         class KNeighborsClassifier {
         public:
             explicit KNeighborsClassifier(KNeighborsClassifierParameters parameters = {})
-                : m_parameters{parameters} {
-                if (m_parameters.algorithm != AlgorithmType::kAuto && m_parameters.algorithm != AlgorithmType::kBruteForce) {
-                    throw std::runtime_error("Only BruteForce algorithm is currently implemented");
-                }
-                if (m_parameters.weights != WeightsType::kUniform) {
-                    throw std::runtime_error("Only Uniform weights are currently implemented");
-                }
+                : m_impl{std::move(parameters)} {
             }
 
             KNeighborsClassifier(const KNeighborsClassifier &) = default;
@@ -78,64 +220,92 @@ namespace sklearn {
             // y - target values
             template<typename ArrayDataType, typename ArrayTargetType>
             void fit(const ArrayDataType &X, const ArrayTargetType &y) {
-                m_X = X.copy();
-                m_y = y.copy();
-                m_fitted = true;
+                fit(utils::DenseMatrix<DataType>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            template<typename ArrayTargetType>
+            void fit(utils::DenseMatrix<DataType> X, const ArrayTargetType &y) {
+                std::vector<TargetType> labels(y.size());
+                for (np::Size i = 0; i < labels.size(); ++i) {
+                    labels[i] = y.get(i);
+                }
+                m_impl.fit(std::move(X), labels);
             }
 
             // Predict the class labels for the provided data.
             // X - test samples.
             template<typename ArrayPredictType>
             Array<TargetType> predict(const ArrayPredictType &X) {
-                if (!m_fitted) {
-                    throw std::runtime_error("This KNeighborsClassifier instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
-                }
-                auto metric = metrics::DistanceMetric<ArrayPredictType, Array<DataType>>::get_metric(m_parameters.metric, m_parameters.p);
-                auto distances = metric->pairwise(X, m_X);
-                np::Size totalSamples = X.shape()[0];
-                Array<TargetType> pred{np::Shape{totalSamples}};
+                auto pred = m_impl.predict(utils::DenseMatrix<DataType>{X});
+                const np::Size n_queries = pred.size();
+                return Array<TargetType>{std::move(pred), np::Shape{n_queries}};
+            }
 
-                for (np::Size sample = 0; sample < totalSamples; ++sample) {
-                    pred.set(sample, predictSample(distances[sample]));
-                }
-                return pred;
+            // Predict the class label of one sample without allocating, for low-latency serving.
+            // row - the n_features features of the sample
+            // out - where the label is written
+            // Only the first call on a thread allocates, to grow the search buffers the thread keeps (see
+            // Algorithm::query_point), and the label is the one predict returns, up to the order of neighbors at
+            // equal distance with algorithm = kBruteForce (see brute_force_query_point).
+            void predict_into(const DataType *row, np::Size n_features, TargetType *out) const {
+                m_impl.predictInto(row, 1, n_features, out);
             }
 
-        private:
-            template<typename DerivedX_fit, typename StorageD>
-            TargetType predictSample(const np::ndarray::internal::NDArrayBase<DataType, DerivedX_fit, StorageD> &distance) const {
-                std::priority_queue<std::pair<DataType, TargetType>, std::vector<std::pair<DataType, TargetType>>, std::greater<std::pair<DataType, TargetType>>> distances;
-                for (np::Size j = 0; j < m_X.shape()[0]; ++j) {
-                    auto p = std::make_pair(distance.get(j), m_y.get(j));
-                    distances.push(p);
-                }
-                std::vector<TargetType> v;
-                for (np::Size i = 0; i < m_parameters.n_neighbors; ++i) {
-                    v.push_back(distances.top().second);
-                    distances.pop();
-                }
-                np::Shape shape{m_parameters.n_neighbors};
-                Array<TargetType> neighbors{std::move(v), shape};
-                return mode<TargetType>(neighbors).first.get(0);
+            // Predict the class labels of n_samples samples into a caller-provided buffer, without allocating once the
+            // threads have run a first prediction, see predict_into for one sample.
+            // X - the row-major samples, n_samples x n_features
+            // out - n_samples labels
+            void predict_into(const DataType *X, np::Size n_samples, np::Size n_features, TargetType *out) const {
+                m_impl.predictInto(X, n_samples, n_features, out);
+            }
+
+            // Return probability estimates for the test data X.
+            // Returns an array of shape (n_queries, n_classes): the weights of the classes among the neighbors of every
+            // query, normalized to sum to 1. Classes are ordered as in classes_().
+            template<typename ArrayPredictType>
+            np::Array<np::float_> predict_proba(const ArrayPredictType &X) const {
+                return m_impl.predict_proba(utils::DenseMatrix<DataType>{X});
+            }
+
+            // Probability estimates from the neighbors found by kneighbors(X), without searching them again.
+            // Distances must have been returned unless weights are kUniform.
+            np::Array<np::float_> predict_proba(const KNeighbors &neighbors) const {
+                return m_impl.predict_proba(neighbors);
             }
 
-            KNeighborsClassifierParameters m_parameters;
-            Array<DataType> m_X;
-            Array<TargetType> m_y;
-            bool m_fitted{false};
+            // Find the K-neighbors of a point.
+            // X - query points
+            // n_neighbors - number of neighbors, the n_neighbors parameter by default
+            // return_distance - whether or not to return the distances
+            // Returns distances and indices of the neighbors in the training data, both of shape (n_queries, n_neighbors)
+            // and sorted by increasing distance. Distances are empty if return_distance is false.
+            template<typename ArrayPredictType>
+            KNeighbors kneighbors(const ArrayPredictType &X, std::optional<np::Size> n_neighbors = std::nullopt, bool return_distance = true) const {
+                return m_impl.kneighbors(utils::DenseMatrix<DataType>{X}, n_neighbors, return_distance);
+            }
+
+            // The class labels known to the classifier, sorted.
+            [[nodiscard]] Array<TargetType> classes_() const {
+                return Array<TargetType>{m_impl.classes(), np::Shape{m_impl.classes().size()}};
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::KNeighborsClassifierImpl<DataType, TargetType> m_impl;
         };
 
         template<>
         class KNeighborsClassifier<pd::DataFrame> {
         public:
             explicit KNeighborsClassifier(KNeighborsClassifierParameters parameters = {})
-                : m_parameters{parameters} {
-                if (m_parameters.algorithm != AlgorithmType::kAuto && m_parameters.algorithm != AlgorithmType::kBruteForce) {
-                    throw std::runtime_error("Only BruteForce algorithm is currently implemented");
-                }
-                if (m_parameters.weights != WeightsType::kUniform) {
-                    throw std::runtime_error("Only Uniform weights are currently implemented");
-                }
+                : m_impl{std::move(parameters)} {
             }
 
             KNeighborsClassifier(const KNeighborsClassifier &) = default;
@@ -148,52 +318,55 @@ namespace sklearn {
             // X - training data
             // y - target values
             void fit(const pd::DataFrame &X, const pd::DataFrame &y) {
-                m_X = X;
-                m_y = y;
-                m_fitted = true;
+                fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            void fit(utils::DenseMatrix<np::float_> X, const pd::DataFrame &y) {
+                std::vector<pd::internal::Value> labels(y.shape()[0]);
+                for (np::Size i = 0; i < labels.size(); ++i) {
+                    labels[i] = y.at(i, 0);
+                }
+                m_impl.fit(std::move(X), labels);
             }
 
             // Predict the class labels for the provided data.
             // X - test samples.
             pd::DataFrame predict(const pd::DataFrame &X) {
-                if (!m_fitted) {
-                    throw std::runtime_error("This KNeighborsClassifier instance is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
-                }
-                auto metric = metrics::DistanceMetric<pd::DataFrame, pd::DataFrame>::get_metric(m_parameters.metric, m_parameters.p);
-                auto distances = metric->pairwise(X, m_X);
+                auto pred = m_impl.predict(utils::DenseMatrix<np::float_>{X});
+                const np::Size n_queries = pred.size();
+                return pd::DataFrame{np::Array<pd::internal::Value>{std::move(pred), np::Shape{n_queries}}};
+            }
 
-                np::Size totalSamples = X.shape()[0];
-                np::Array<pd::internal::Value> array{np::Shape{totalSamples}};
-                for (np::Size sample = 0; sample < totalSamples; ++sample) {
-                    array.set(sample, predictSample(distances[sample]));
-                }
-                return pd::DataFrame{array};
+            // Return probability estimates for the test data X, see KNeighborsClassifier::predict_proba.
+            np::Array<np::float_> predict_proba(const pd::DataFrame &X) const {
+                return m_impl.predict_proba(utils::DenseMatrix<np::float_>{X});
             }
 
-        private:
-            template<typename DerivedX_fit, typename StorageD>
-            [[nodiscard]] pd::internal::Value predictSample(const np::ndarray::internal::NDArrayBase<np::float_, DerivedX_fit, StorageD> &distance) const {
-                std::priority_queue<std::pair<np::float_, pd::internal::Value>, std::vector<std::pair<np::float_, pd::internal::Value>>, std::greater<std::pair<np::float_, pd::internal::Value>>> distances;
-                for (np::Size j = 0; j < m_X.shape()[0]; ++j) {
-                    auto p = std::make_pair(distance.get(j), m_y.at(j, 0));
-                    distances.push(p);
-                }
+            // Probability estimates from the neighbors found by kneighbors(X), without searching them again.
+            np::Array<np::float_> predict_proba(const KNeighbors &neighbors) const {
+                return m_impl.predict_proba(neighbors);
+            }
 
-                std::vector<pd::internal::Value> v;
-                for (np::Size i = 0; i < m_parameters.n_neighbors; ++i) {
-                    v.push_back(distances.top().second);
-                    distances.pop();
-                }
+            // Find the K-neighbors of a point, see KNeighborsClassifier::kneighbors.
+            KNeighbors kneighbors(const pd::DataFrame &X, std::optional<np::Size> n_neighbors = std::nullopt, bool return_distance = true) const {
+                return m_impl.kneighbors(utils::DenseMatrix<np::float_>{X}, n_neighbors, return_distance);
+            }
+
+            // The class labels known to the classifier, sorted, as a single column: the columns of predict_proba.
+            [[nodiscard]] pd::DataFrame classes_() const {
+                return pd::DataFrame{np::Array<pd::internal::Value>{m_impl.classes(), np::Shape{m_impl.classes().size()}}};
+            }
 
-                np::Shape shape{m_parameters.n_neighbors};
-                Array<pd::internal::Value> neighbors{v, shape};
-                return mode<pd::internal::Value>(neighbors).first.get(0);
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
             }
 
-            KNeighborsClassifierParameters m_parameters;
-            pd::DataFrame m_X;
-            pd::DataFrame m_y;
-            bool m_fitted{false};
+        private:
+            internal::KNeighborsClassifierImpl<np::float_, pd::internal::Value> m_impl;
         };
 
     }// namespace neighbors
@@ -0,0 +1,237 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <pd/core/frame/DataFrame/DataFrame.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/AlgorithmType.hpp>
+#include <sklearn/neighbors/NeighborsBase.hpp>
+#include <sklearn/neighbors/WeightsType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        /// Regression based on k-nearest neighbors: the target is predicted by the (weighted) mean of the targets of
+        /// the nearest neighbors in the training set.
+        struct KNeighborsRegressorParameters {
+            np::Size n_neighbors{5};
+            /// Weight function used in prediction, see KNeighborsClassifierParameters::weights.
+            WeightsType weights{WeightsType::kUniform};
+            AlgorithmType algorithm{AlgorithmType::kAuto};
+            int leaf_size{30};
+            np::float_ p{2};
+            metrics::DistanceMetricType metric{metrics::DistanceMetricType::kMinkowski};
+            /// The number of parallel jobs to run for neighbors search and averaging. -1 means using all processors,
+            /// see utils::effective_n_jobs. Predictions do not depend on it.
+            int n_jobs{1};
+            /// The weight of a neighbor as a function of its distance, used with weights = kCallable.
+            WeightsCallable weights_callable{};
+            /// Graph parameters for algorithm = kHnsw, the approximate search.
+            HnswParameters hnsw{};
+            /// Index parameters for algorithm = kIvfPq, the approximate search on compressed vectors.
+            IvfPqParameters ivf_pq{};
+            /// Precision of the brute force distances on float32 data (DataType = float), see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
+        };
+
+        namespace internal {
+            // The search and the averaging of the regressors over arrays and over data frames.
+            template<typename DataType>
+            class KNeighborsRegressorImpl {
+            public:
+                explicit KNeighborsRegressorImpl(KNeighborsRegressorParameters parameters)
+                    : m_parameters{std::move(parameters)},
+                      m_base{m_parameters.algorithm, m_parameters.leaf_size, m_parameters.metric, m_parameters.p, m_parameters.n_jobs, m_parameters.hnsw, m_parameters.ivf_pq, m_parameters.accumulation} {
+                    checkWeights(m_parameters.weights, m_parameters.weights_callable);
+                }
+
+                void fit(utils::DenseMatrix<DataType> X, std::vector<np::float_> targets) {
+                    m_base.fit(std::move(X), targets.size(), m_parameters.n_neighbors);
+                    m_targets = std::move(targets);
+                }
+
+                [[nodiscard]] KNeighbors kneighbors(const utils::DenseMatrix<DataType> &X, std::optional<np::Size> n_neighbors, bool return_distance) const {
+                    return m_base.kneighbors(X, n_neighbors.value_or(m_parameters.n_neighbors), return_distance);
+                }
+
+                [[nodiscard]] std::vector<np::float_> predict(const utils::DenseMatrix<DataType> &X) const {
+                    const np::Size k = m_parameters.n_neighbors;
+                    const auto heap = m_base.kneighborsHeap(X, k, m_parameters.weights != WeightsType::kUniform);
+                    std::vector<np::float_> pred(heap.n_queries());
+                    m_base.forEachQuery(
+                            heap.n_queries(), [k] { return Average{k}; },
+                            [&](np::Size sample, Average &average) {
+                                pred[sample] = average(m_parameters.weights, m_parameters.weights_callable, m_targets, heap.indices(sample), heap.distances(sample), k);
+                            });
+                    return pred;
+                }
+
+                // Predicts the targets of the n_samples row-major samples of X into out, spread over n_jobs threads,
+                // in buffers every thread keeps for all its calls, see KNeighborsClassifierImpl::predictInto.
+                template<typename Out>
+                void predictInto(const DataType *X, np::Size n_samples, np::Size n_features, Out *out) const {
+                    const np::Size k = m_parameters.n_neighbors;
+                    m_base.checkQuery(n_features, k);
+                    m_base.forEachQuery(
+                            n_samples, [] { return &threadScratch<PointScratch>(); },
+                            [&](np::Size sample, PointScratch *scratch) {
+                                auto &[heap, average] = *scratch;
+                                m_base.kneighborsPoint(X + sample * n_features, k, m_parameters.weights != WeightsType::kUniform, heap);
+                                out[sample] = static_cast<Out>(average(m_parameters.weights, m_parameters.weights_callable, m_targets, heap.indices(0), heap.distances(0), k));
+                            });
+                }
+
+                [[nodiscard]] AlgorithmType fitMethod() const {
+                    return m_base.fitMethod();
+                }
+
+            private:
+                // The buffers of predictInto kept by every thread.
+                struct PointScratch {
+                    NeighborsHeap heap;
+                    Average average{0};
+                };
+
+                KNeighborsRegressorParameters m_parameters;
+                NeighborsBase<DataType> m_base;
+                std::vector<np::float_> m_targets;
+            };
+        }// namespace internal
+
+        template<typename DataType>
+        class KNeighborsRegressor {
+        public:
+            explicit KNeighborsRegressor(KNeighborsRegressorParameters parameters = {})
+                : m_impl{std::move(parameters)} {
+            }
+
+            // Fit the k-nearest neighbors regressor from the training dataset.
+            // X - training data
+            // y - target values, one per sample
+            template<typename ArrayDataType, typename ArrayTargetType>
+            void fit(const ArrayDataType &X, const ArrayTargetType &y) {
+                fit(utils::DenseMatrix<DataType>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            template<typename ArrayTargetType>
+            void fit(utils::DenseMatrix<DataType> X, const ArrayTargetType &y) {
+                std::vector<np::float_> targets(y.size());
+                for (np::Size i = 0; i < targets.size(); ++i) {
+                    targets[i] = static_cast<np::float_>(y.get(i));
+                }
+                m_impl.fit(std::move(X), std::move(targets));
+            }
+
+            // Predict the target for the provided data.
+            // X - test samples.
+            template<typename ArrayPredictType>
+            np::Array<np::float_> predict(const ArrayPredictType &X) const {
+                auto pred = m_impl.predict(utils::DenseMatrix<DataType>{X});
+                const np::Size n_queries = pred.size();
+                return np::Array<np::float_>{std::move(pred), np::Shape{n_queries}};
+            }
+
+            // Predict the target of one sample into out without allocating, see KNeighborsClassifier::predict_into.
+            template<typename Out>
+            void predict_into(const DataType *row, np::Size n_features, Out *out) const {
+                m_impl.predictInto(row, 1, n_features, out);
+            }
+
+            // Predict the targets of the n_samples row-major samples of X into the n_samples values of out without
+            // allocating, see KNeighborsClassifier::predict_into.
+            template<typename Out>
+            void predict_into(const DataType *X, np::Size n_samples, np::Size n_features, Out *out) const {
+                m_impl.predictInto(X, n_samples, n_features, out);
+            }
+
+            // Find the K-neighbors of a point, see KNeighborsClassifier::kneighbors.
+            template<typename ArrayPredictType>
+            KNeighbors kneighbors(const ArrayPredictType &X, std::optional<np::Size> n_neighbors = std::nullopt, bool return_distance = true) const {
+                return m_impl.kneighbors(utils::DenseMatrix<DataType>{X}, n_neighbors, return_distance);
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::KNeighborsRegressorImpl<DataType> m_impl;
+        };
+
+        template<>
+        class KNeighborsRegressor<pd::DataFrame> {
+        public:
+            explicit KNeighborsRegressor(KNeighborsRegressorParameters parameters = {})
+                : m_impl{std::move(parameters)} {
+            }
+
+            // Fit the k-nearest neighbors regressor from the training dataset.
+            // X - training data
+            // y - target values, a single column
+            void fit(const pd::DataFrame &X, const pd::DataFrame &y) {
+                fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            void fit(utils::DenseMatrix<np::float_> X, const pd::DataFrame &y) {
+                std::vector<np::float_> targets(y.shape()[0]);
+                for (np::Size i = 0; i < targets.size(); ++i) {
+                    targets[i] = static_cast<np::float_>(y.at(i, 0));
+                }
+                m_impl.fit(std::move(X), std::move(targets));
+            }
+
+            // Predict the target for the provided data.
+            // X - test samples.
+            pd::DataFrame predict(const pd::DataFrame &X) const {
+                const auto pred = m_impl.predict(utils::DenseMatrix<np::float_>{X});
+                std::vector<pd::internal::Value> values(pred.cbegin(), pred.cend());
+                return pd::DataFrame{np::Array<pd::internal::Value>{std::move(values), np::Shape{pred.size()}}};
+            }
+
+            // Find the K-neighbors of a point, see KNeighborsClassifier::kneighbors.
+            KNeighbors kneighbors(const pd::DataFrame &X, std::optional<np::Size> n_neighbors = std::nullopt, bool return_distance = true) const {
+                return m_impl.kneighbors(utils::DenseMatrix<np::float_>{X}, n_neighbors, return_distance);
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::KNeighborsRegressorImpl<np::float_> m_impl;
+        };
+    }// namespace neighbors
+}// namespace sklearn
@@ -20,25 +20,90 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include <np/Array.hpp>
 #include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/BinaryTree.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
 
 namespace sklearn {
     namespace neighbors {
-        // @param Xarray-like of shape (n_samples, n_features)
-        // @param n_samples is the number of points in the data set, and n_features is the dimension of the parameter space. Note: if X is a C-contiguous array of doubles then data will not be copied. Otherwise, an internal copy will be made.
+        // KdTree for fast generalized N-point problems.
+
+        // @param X array-like of shape (n_samples, n_features)
+        // @param n_samples is the number of points in the data set, and n_features is the dimension of the parameter space. An array or an owning utils::DenseMatrix is copied (or moved) into an internal row-major buffer once, on construction. A utils::DenseMatrix::view of caller-owned data is borrowed without a copy and has to stay alive and unchanged for as long as the tree or any copy of it is in use, see utils::DenseMatrix.
 
         // @param leaf_size positive int, default=40
         // @param Number of points at which to switch to brute-force. Changing leaf_size will not affect the results of a query, but can significantly impact the speed of a query and the memory required to store the constructed tree. The amount of memory needed to store the tree scales as approximately n_samples / leaf_size. For a specified leaf_size, a leaf node is guaranteed to satisfy leaf_size <= n_points <= 2 * leaf_size, except in the case that n_samples < leaf_size.
 
-        // @param metric str or DistanceMetric object
-        // @param The distance metric to use for the tree. Default=’minkowski’ with p=2 (that is, a euclidean metric). See the documentation of the DistanceMetric class for a list of available metrics. ball_tree.valid_metrics gives a list of the metrics which are valid for BallTree.
-        template<typename DataType, np::Size Samples, np::Size Features>
-        class KdTree {
+        // @param metric DistanceMetricType
+        // @param The distance metric to use for the tree. Default=kMinkowski with p=2 (that is, a euclidean metric). All the metrics of DistanceMetricType are valid for KdTree.
+
+        // @param p np::float_, default=2
+        // @param Power parameter for the Minkowski metric, any p >= 1.
+        template<typename DataType = np::float_>
+        class KdTree : public BinaryTree<KdTree<DataType>, DataType> {
+            using Base = BinaryTree<KdTree<DataType>, DataType>;
+            friend Base;
+
         public:
-            KdTree(const np::Array<DataType, Samples, Features> &X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski);
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            explicit KdTree(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : KdTree(utils::DenseMatrix<DataType>{X}, leaf_size, metric, p) {
+            }
+
+            explicit KdTree(utils::DenseMatrix<DataType> X, int leaf_size = 40, metrics::DistanceMetricType metric = metrics::DistanceMetricType::kMinkowski, np::float_ p = 2)
+                : Base(std::move(X), leaf_size, metric, p) {
+                this->build();
+            }
+
+        private:
+            // Every node is bounded by the axis-aligned box of its points.
+            void allocateNodes(np::Size n_nodes) {
+                m_lowerBounds.resize(n_nodes * this->m_data.cols());
+                m_upperBounds.resize(n_nodes * this->m_data.cols());
+            }
+
+            void initNode(np::Size i_node) {
+                const np::Size n_features = this->m_data.cols();
+                const auto &node = this->m_nodes[i_node];
+                auto *lower = m_lowerBounds.data() + i_node * n_features;
+                auto *upper = m_upperBounds.data() + i_node * n_features;
+                std::fill(lower, lower + n_features, std::numeric_limits<np::float_>::infinity());
+                std::fill(upper, upper + n_features, -std::numeric_limits<np::float_>::infinity());
+                for (np::Size i = node.idx_start; i < node.idx_end; ++i) {
+                    const auto *point = this->m_data.row(this->m_idx[i]);
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        lower[j] = std::min(lower[j], static_cast<np::float_>(point[j]));
+                        upper[j] = std::max(upper[j], static_cast<np::float_>(point[j]));
+                    }
+                }
+            }
+
+            // Reduced distance from the point to the bounding box of the node.
+            np::float_ minRdist(np::Size i_node, const DataType *point) const {
+                const np::Size n_features = this->m_data.cols();
+                const auto *lower = m_lowerBounds.data() + i_node * n_features;
+                const auto *upper = m_upperBounds.data() + i_node * n_features;
+                // The metric is dispatched once per node, not per coordinate.
+                return this->m_kernel.visit([&](const auto &reduction) {
+                    np::float_ rdist{0};
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        const auto x = static_cast<np::float_>(point[j]);
+                        rdist = reduction.accumulate(rdist, std::max({np::float_{0}, lower[j] - x, x - upper[j]}));
+                    }
+                    return rdist;
+                });
+            }
+
+            std::vector<np::float_> m_lowerBounds;
+            std::vector<np::float_> m_upperBounds;
         };
     }// namespace neighbors
 }// namespace sklearn
@@ -0,0 +1,372 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/Algorithm.hpp>
+#include <sklearn/neighbors/AlgorithmType.hpp>
+#include <sklearn/neighbors/NeighborsHeap.hpp>
+#include <sklearn/neighbors/WeightsType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+#include <sklearn/utils/parallel.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        // Distances and indices of the k nearest neighbors of every query, both of shape (n_queries, k) and sorted by
+        // increasing distance, as returned by the kneighbors methods of the estimators. Distances are empty if they
+        // were not requested.
+        using KNeighbors = std::pair<np::Array<np::float_>, np::Array<np::Size>>;
+
+        // The weight of a neighbor as a function of its distance, for WeightsType::kCallable.
+        using WeightsCallable = std::function<np::float_(np::float_)>;
+
+        namespace internal {
+            inline void checkWeights(WeightsType weights, const WeightsCallable &weights_callable) {
+                if (weights == WeightsType::kCallable && !weights_callable) {
+                    throw std::runtime_error("weights_callable must be set for Callable weights");
+                }
+            }
+
+            // The radius estimators need the radius queries of the exact algorithms, reject the approximate ones before
+            // fit builds an index that predict could not use.
+            inline void checkRadiusAlgorithm(AlgorithmType algorithm) {
+                if (algorithm == AlgorithmType::kHnsw || algorithm == AlgorithmType::kIvfPq) {
+                    throw std::runtime_error("Radius neighbors estimators do not support the approximate kHnsw and kIvfPq algorithms");
+                }
+            }
+
+            // Writes the weights of n neighbors with the distances to weights. distances are not read for kUniform.
+            inline void neighborWeights(WeightsType type, const WeightsCallable &weights_callable, const np::float_ *distances, np::Size n, np::float_ *weights) {
+                switch (type) {
+                    case WeightsType::kUniform:
+                        std::fill(weights, weights + n, np::float_{1});
+                        return;
+                    case WeightsType::kDistance: {
+                        // as in scikit-learn, if a neighbor coincides with the query, the neighbors at distance 0
+                        // get the weight 1 and all others 0
+                        const bool exact_match = std::any_of(distances, distances + n, [](np::float_ d) { return d == 0; });
+                        for (np::Size i = 0; i < n; ++i) {
+                            weights[i] = exact_match ? (distances[i] == 0 ? 1 : 0) : 1 / distances[i];
+                        }
+                        return;
+                    }
+                    case WeightsType::kCallable:
+                        for (np::Size i = 0; i < n; ++i) {
+                            weights[i] = weights_callable(distances[i]);
+                        }
+                        return;
+                }
+            }
+
+            // Weighted vote of the neighbors of a query over classes encoded as 0, ..., n_classes - 1.
+            // The weights are summed in a dense histogram with one bin per class, so a vote allocates nothing once the
+            // weight buffer has grown to the largest neighborhood: every thread keeps one Vote for all its queries.
+            class Vote {
+            public:
+                Vote(np::Size n_classes, np::Size n_neighbors)
+                    : m_histogram(n_classes), m_weights(n_neighbors) {
+                }
+
+                // Grows the buffers to n_classes bins and n_neighbors weights, for a Vote reused across estimators.
+                void reserve(np::Size n_classes, np::Size n_neighbors) {
+                    if (m_histogram.size() < n_classes) {
+                        m_histogram.resize(n_classes);
+                    }
+                    if (m_weights.size() < n_neighbors) {
+                        m_weights.resize(n_neighbors);
+                    }
+                }
+
+                // Adds the weights of the n neighbors of a query to the histogram.
+                // codes - class codes of the training samples
+                // neighbors, distances - indices and distances of the neighbors, distances are not read for kUniform
+                const std::vector<np::float_> &accumulate(WeightsType weights, const WeightsCallable &weights_callable, const std::vector<np::Size> &codes,
+                                                          const np::Size *neighbors, const np::float_ *distances, np::Size n) {
+                    if (m_weights.size() < n) {
+                        m_weights.resize(n);
+                    }
+                    neighborWeights(weights, weights_callable, distances, n, m_weights.data());
+                    for (np::Size i = 0; i < n; ++i) {
+                        m_histogram[codes[neighbors[i]]] += m_weights[i];
+                    }
+                    return m_histogram;
+                }
+
+                // The code of the class with the largest total weight among the n accumulated neighbors, the smallest
+                // code on ties (for uniform weights the smallest of the most frequent classes, as scipy.stats.mode).
+                [[nodiscard]] np::Size best(const std::vector<np::Size> &codes, const np::Size *neighbors, np::Size n) const {
+                    np::Size best = codes[neighbors[0]];
+                    for (np::Size i = 1; i < n; ++i) {
+                        const np::Size code = codes[neighbors[i]];
+                        if (m_histogram[code] > m_histogram[best] || (m_histogram[code] == m_histogram[best] && code < best)) {
+                            best = code;
+                        }
+                    }
+                    return best;
+                }
+
+                // Resets the bins of the n neighbors, the only ones accumulate touched.
+                void clear(const std::vector<np::Size> &codes, const np::Size *neighbors, np::Size n) {
+                    for (np::Size i = 0; i < n; ++i) {
+                        m_histogram[codes[neighbors[i]]] = 0;
+                    }
+                }
+
+            private:
+                std::vector<np::float_> m_histogram;
+                std::vector<np::float_> m_weights;
+            };
+
+            // Weighted mean of the targets of the n neighbors of a query, NaN without neighbors. Every thread keeps one
+            // Average, the weight buffer only grows.
+            class Average {
+            public:
+                explicit Average(np::Size n_neighbors)
+                    : m_weights(n_neighbors) {
+                }
+
+                np::float_ operator()(WeightsType weights, const WeightsCallable &weights_callable, const std::vector<np::float_> &targets,
+                                      const np::Size *neighbors, const np::float_ *distances, np::Size n) {
+                    if (m_weights.size() < n) {
+                        m_weights.resize(n);
+                    }
+                    neighborWeights(weights, weights_callable, distances, n, m_weights.data());
+                    np::float_ sum{0};
+                    np::float_ total{0};
+                    for (np::Size i = 0; i < n; ++i) {
+                        sum += m_weights[i] * targets[neighbors[i]];
+                        total += m_weights[i];
+                    }
+                    return sum / total;
+                }
+
+            private:
+                std::vector<np::float_> m_weights;
+            };
+
+            // The neighbors of one query of a RadiusNeighbors result, copied to contiguous buffers for Vote and Average.
+            // Every thread keeps one RadiusRow, the buffers only grow.
+            struct RadiusRow {
+                std::vector<np::Size> indices;
+                std::vector<np::float_> distances;
+
+                // Copies the neighbors of the query, and their distances if requested, and returns their number.
+                np::Size load(const RadiusNeighbors &neighbors, np::Size query, bool with_distances) {
+                    const np::Size begin = neighbors.offsets.get(query);
+                    const np::Size n = neighbors.offsets.get(query + 1) - begin;
+                    if (indices.size() < n) {
+                        indices.resize(n);
+                        distances.resize(n);
+                    }
+                    for (np::Size i = 0; i < n; ++i) {
+                        indices[i] = neighbors.indices.get(begin + i);
+                    }
+                    if (with_distances) {
+                        for (np::Size i = 0; i < n; ++i) {
+                            distances[i] = neighbors.distances.get(begin + i);
+                        }
+                    }
+                    return n;
+                }
+            };
+
+            // The T of the calling thread, the same for all its calls: the buffers of the allocation-free predict_into
+            // methods, grown by the first calls and reused afterwards.
+            template<typename T>
+            T &threadScratch() {
+                thread_local T scratch;
+                return scratch;
+            }
+
+            // The sorted distinct labels and the code of every label, its index among them.
+            template<typename Label>
+            std::vector<Label> encodeLabels(const std::vector<Label> &labels, std::vector<np::Size> &codes) {
+                std::vector<Label> classes{labels};
+                std::sort(classes.begin(), classes.end());
+                classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+                codes.resize(labels.size());
+                for (np::Size i = 0; i < labels.size(); ++i) {
+                    codes[i] = static_cast<np::Size>(std::lower_bound(classes.begin(), classes.end(), labels[i]) - classes.begin());
+                }
+                return classes;
+            }
+
+            // The predicted labels of the queries, written one sample at a time from the threads of forEachQuery.
+            // std::vector<bool> packs bits, so writing neighbouring samples from different threads would race: bool
+            // labels are stored one byte each, see labelsOf.
+            template<typename Label>
+            using Predictions = std::vector<std::conditional_t<std::is_same_v<Label, bool>, unsigned char, Label>>;
+
+            template<typename Label>
+            std::vector<Label> labelsOf(Predictions<Label> &&pred) {
+                if constexpr (std::is_same_v<Label, bool>) {
+                    return std::vector<bool>(pred.cbegin(), pred.cend());
+                } else {
+                    return std::move(pred);
+                }
+            }
+
+            // The neighbor search shared by all the neighbors estimators: builds the index on fit and answers k nearest
+            // and radius queries on it, spreading the queries over n_jobs threads. The estimators only turn the
+            // neighbors into predictions, with forEachQuery for per-thread scratch buffers.
+            template<typename DataType>
+            class NeighborsBase {
+            public:
+                NeighborsBase(AlgorithmType algorithm, int leaf_size, metrics::DistanceMetricType metric, np::float_ p, int n_jobs, HnswParameters hnsw = {}, IvfPqParameters ivf_pq = {},
+                              utils::Accumulation accumulation = utils::Accumulation::kFloat64)
+                    : m_algorithmType{algorithm}, m_leafSize{leaf_size}, m_metric{metric}, m_p{p}, m_nJobs{n_jobs}, m_hnsw{hnsw}, m_ivfPq{ivf_pq}, m_accumulation{accumulation} {
+                    utils::effective_n_jobs(m_nJobs);// throws for n_jobs == 0
+                }
+
+                // Builds the index on X. n_neighbors is the number of neighbors the estimator will look for, used to
+                // resolve AlgorithmType::kAuto.
+                void fit(utils::DenseMatrix<DataType> X, np::Size n_samples_y, np::Size n_neighbors) {
+                    if (n_samples_y != X.rows()) {
+                        throw std::runtime_error("Found input variables with inconsistent numbers of samples");
+                    }
+                    m_nSamples = X.rows();
+                    m_nFeatures = X.cols();
+                    m_fitMethod = m_algorithmType;
+                    if (m_fitMethod == AlgorithmType::kAuto) {
+                        m_fitMethod = select_algorithm(X.rows(), X.cols(), n_neighbors, m_metric, m_p);
+                    }
+                    m_algorithm = get_algorithm(m_fitMethod, std::move(X), m_leafSize, m_metric, m_p, m_hnsw, m_ivfPq, m_accumulation);
+                }
+
+                // The k nearest neighbors of the rows of X, with true distances if requested (reduced ones otherwise).
+                [[nodiscard]] NeighborsHeap kneighborsHeap(const utils::DenseMatrix<DataType> &X, np::Size k, bool distances) const {
+                    checkFitted();
+                    auto heap = m_algorithm->query(X, k, m_nJobs);
+                    if (distances) {
+                        const auto &kernel = m_algorithm->kernel();
+                        heap.transform([&kernel](np::float_ rdist) { return kernel.rdist_to_dist(rdist); });
+                    }
+                    return heap;
+                }
+
+                [[nodiscard]] KNeighbors kneighbors(const utils::DenseMatrix<DataType> &X, np::Size k, bool return_distance) const {
+                    auto heap = kneighborsHeap(X, k, return_distance);
+                    const np::Shape shape{heap.n_queries(), k};
+                    auto [distances, indices] = heap.release();
+                    return {return_distance ? np::Array<np::float_>{std::move(distances), shape} : np::Array<np::float_>{},
+                            np::Array<np::Size>{std::move(indices), shape}};
+                }
+
+                // Checks that samples of n_features features can be queried for k neighbors with kneighborsPoint.
+                void checkQuery(np::Size n_features, np::Size k) const {
+                    checkFitted();
+                    if (n_features != m_nFeatures) {
+                        throw std::runtime_error("X has " + std::to_string(n_features) + " features, but the estimator is expecting " + std::to_string(m_nFeatures) + " features as input");
+                    }
+                    if (k < 1 || k > m_nSamples) {
+                        throw std::runtime_error("k must be in range [1, n_samples]");
+                    }
+                }
+
+                // The k nearest neighbors of one sample into heap, reset to a single query, with true distances if
+                // requested (reduced ones otherwise). Nothing is checked (see checkQuery) and nothing is allocated once
+                // the heap and the search buffers of the thread have grown, see Algorithm::query_point.
+                void kneighborsPoint(const DataType *point, np::Size k, bool distances, NeighborsHeap &heap) const {
+                    heap.reset(1, k);
+                    m_algorithm->query_point(point, heap);
+                    if (distances) {
+                        const auto &kernel = m_algorithm->kernel();
+                        heap.transform([&kernel](np::float_ rdist) { return kernel.rdist_to_dist(rdist); });
+                    }
+                }
+
+                // The neighbors within the radius r of the rows of X, in compressed sparse row layout.
+                [[nodiscard]] RadiusNeighbors radius_neighbors(const utils::DenseMatrix<DataType> &X, np::float_ r, bool return_distance, bool sort_results) const {
+                    checkFitted();
+                    auto result = m_algorithm->query_radius(X, r, sort_results, m_nJobs);
+                    if (!return_distance) {
+                        result.distances = np::Array<np::float_>{};
+                    }
+                    return result;
+                }
+
+                // Calls f(query, scratch) for the queries [0, n_queries) on n_jobs threads, scratch being make() of the
+                // thread. Every query is processed on its own, so the result does not depend on the number of threads.
+                // A single thread runs the queries in place, without a parallel region.
+                template<typename Make, typename F>
+                void forEachQuery(np::Size n_queries, Make &&make, F &&f) const {
+                    const auto n = static_cast<long>(n_queries);
+                    const int n_threads = utils::effective_n_jobs(m_nJobs);
+                    if (n_threads == 1 || n_queries <= 1) {
+                        auto scratch = make();
+                        for (np::Size query = 0; query < n_queries; ++query) {
+                            f(query, scratch);
+                        }
+                        return;
+                    }
+#ifdef _OPENMP
+#pragma omp parallel num_threads(n_threads) if (n_threads > 1)
+#endif
+                    {
+                        auto scratch = make();
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+                        for (long query = 0; query < n; ++query) {
+                            f(static_cast<np::Size>(query), scratch);
+                        }
+                    }
+                }
+
+                [[nodiscard]] AlgorithmType fitMethod() const {
+                    return m_fitMethod;
+                }
+
+                void checkFitted() const {
+                    if (!m_algorithm) {
+                        throw std::runtime_error("This estimator is not fitted yet. Call 'fit' with appropriate arguments before using this estimator.");
+                    }
+                }
+
+            private:
+                AlgorithmType m_algorithmType;
+                int m_leafSize;
+                metrics::DistanceMetricType m_metric;
+                np::float_ m_p;
+                int m_nJobs;
+                HnswParameters m_hnsw;
+                IvfPqParameters m_ivfPq;
+                utils::Accumulation m_accumulation;
+                AlgorithmType m_fitMethod{AlgorithmType::kAuto};
+                np::Size m_nSamples{0};
+                np::Size m_nFeatures{0};
+                AlgorithmPtr<DataType> m_algorithm;
+            };
+        }// namespace internal
+    }// namespace neighbors
+}// namespace sklearn
@@ -0,0 +1,163 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        // A set of fixed-capacity max-heaps, one per query point, each keeping the k smallest (distance, index) pairs
+        // pushed so far. Storage is two flat arrays of n_queries * k elements, so pushing never allocates.
+        // Pairs are ordered lexicographically, so ties in distance are resolved in favour of the smaller index and
+        // the result does not depend on the order in which candidates are visited.
+        class NeighborsHeap {
+        public:
+            NeighborsHeap() = default;
+
+            NeighborsHeap(np::Size n_queries, np::Size k)
+                : m_queries{n_queries}, m_k{k},
+                  m_distances(n_queries * k, std::numeric_limits<np::float_>::infinity()),
+                  m_indices(n_queries * k, std::numeric_limits<np::Size>::max()) {
+            }
+
+            // Empties the heaps and resizes them to n_queries * k pairs. The storage only grows, so a heap reused for
+            // queries of the same or a smaller size never allocates.
+            void reset(np::Size n_queries, np::Size k) {
+                m_queries = n_queries;
+                m_k = k;
+                m_distances.assign(n_queries * k, std::numeric_limits<np::float_>::infinity());
+                m_indices.assign(n_queries * k, std::numeric_limits<np::Size>::max());
+            }
+
+            [[nodiscard]] np::Size n_queries() const {
+                return m_queries;
+            }
+
+            [[nodiscard]] np::Size k() const {
+                return m_k;
+            }
+
+            // The largest distance kept for the query, infinity until k pairs have been pushed.
+            [[nodiscard]] np::float_ largest(np::Size row) const {
+                return m_distances[row * m_k];
+            }
+
+            // Offers a candidate to the heap of the query. Returns true if it was kept.
+            bool push(np::Size row, np::float_ distance, np::Size index) {
+                auto *distances = m_distances.data() + row * m_k;
+                auto *indices = m_indices.data() + row * m_k;
+                if (!less(distance, index, distances[0], indices[0])) {
+                    return false;
+                }
+                distances[0] = distance;
+                indices[0] = index;
+                siftDown(distances, indices, 0, m_k);
+                return true;
+            }
+
+            // Sorts every heap in ascending order of distance (heap order is lost).
+            void sort() {
+                for (np::Size row = 0; row < m_queries; ++row) {
+                    sort(row);
+                }
+            }
+
+            // Sorts the heap of the query in ascending order of distance (its heap order is lost).
+            void sort(np::Size row) {
+                auto *distances = m_distances.data() + row * m_k;
+                auto *indices = m_indices.data() + row * m_k;
+                for (np::Size size = m_k; size > 1; --size) {
+                    std::swap(distances[0], distances[size - 1]);
+                    std::swap(indices[0], indices[size - 1]);
+                    siftDown(distances, indices, 0, size - 1);
+                }
+            }
+
+            // Rewrites every distance with f(distance), e.g. to convert reduced distances into true distances.
+            template<typename F>
+            void transform(F f) {
+                for (auto &distance: m_distances) {
+                    distance = f(distance);
+                }
+            }
+
+            [[nodiscard]] const np::float_ *distances(np::Size row) const {
+                return m_distances.data() + row * m_k;
+            }
+
+            [[nodiscard]] const np::Size *indices(np::Size row) const {
+                return m_indices.data() + row * m_k;
+            }
+
+            [[nodiscard]] const std::vector<np::float_> &distances() const {
+                return m_distances;
+            }
+
+            [[nodiscard]] const std::vector<np::Size> &indices() const {
+                return m_indices;
+            }
+
+            // Moves the distances and the indices out, e.g. into arrays returned to the caller, and leaves the heap empty.
+            std::pair<std::vector<np::float_>, std::vector<np::Size>> release() {
+                m_queries = 0;
+                m_k = 0;
+                return {std::move(m_distances), std::move(m_indices)};
+            }
+
+        private:
+            static bool less(np::float_ distance1, np::Size index1, np::float_ distance2, np::Size index2) {
+                return distance1 < distance2 || (distance1 == distance2 && index1 < index2);
+            }
+
+            static void siftDown(np::float_ *distances, np::Size *indices, np::Size i, np::Size size) {
+                while (true) {
+                    np::Size left = 2 * i + 1;
+                    np::Size right = left + 1;
+                    np::Size largest = i;
+                    if (left < size && less(distances[largest], indices[largest], distances[left], indices[left])) {
+                        largest = left;
+                    }
+                    if (right < size && less(distances[largest], indices[largest], distances[right], indices[right])) {
+                        largest = right;
+                    }
+                    if (largest == i) {
+                        return;
+                    }
+                    std::swap(distances[i], distances[largest]);
+                    std::swap(indices[i], indices[largest]);
+                    i = largest;
+                }
+            }
+
+            np::Size m_queries{0};
+            np::Size m_k{0};
+            std::vector<np::float_> m_distances;
+            std::vector<np::Size> m_indices;
+        };
+    }// namespace neighbors
+}// namespace sklearn
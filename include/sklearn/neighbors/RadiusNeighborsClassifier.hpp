@@ -0,0 +1,308 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <pd/core/frame/DataFrame/DataFrame.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/AlgorithmType.hpp>
+#include <sklearn/neighbors/NeighborsBase.hpp>
+#include <sklearn/neighbors/WeightsType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        /// Classifier implementing a vote among neighbors within a given radius. The label of outliers, the samples
+        /// without neighbors within the radius, is a constructor argument of the type of the labels.
+        struct RadiusNeighborsClassifierParameters {
+            /// Range of parameter space to use by default for radius_neighbors queries.
+            np::float_ radius{1.0};
+            /// Weight function used in prediction, see KNeighborsClassifierParameters::weights.
+            WeightsType weights{WeightsType::kUniform};
+            AlgorithmType algorithm{AlgorithmType::kAuto};
+            int leaf_size{30};
+            np::float_ p{2};
+            metrics::DistanceMetricType metric{metrics::DistanceMetricType::kMinkowski};
+            /// The number of parallel jobs to run for neighbors search and voting. -1 means using all processors,
+            /// see utils::effective_n_jobs. Predictions do not depend on it.
+            int n_jobs{1};
+            /// The weight of a neighbor as a function of its distance, used with weights = kCallable.
+            WeightsCallable weights_callable{};
+            /// Precision of the brute force distances on float32 data (DataType = float), see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
+        };
+
+        namespace internal {
+            // The search and the votes of the radius classifiers over arrays and over data frames.
+            // The neighbors of all queries are kept in one RadiusNeighbors, so the memory of a prediction is bounded by
+            // the number of neighbors found, however they are spread over the queries.
+            template<typename DataType, typename Label>
+            class RadiusNeighborsClassifierImpl {
+            public:
+                RadiusNeighborsClassifierImpl(RadiusNeighborsClassifierParameters parameters, std::optional<Label> outlier_label)
+                    : m_parameters{std::move(parameters)}, m_outlierLabel{std::move(outlier_label)},
+                      m_base{m_parameters.algorithm, m_parameters.leaf_size, m_parameters.metric, m_parameters.p, m_parameters.n_jobs, {}, {}, m_parameters.accumulation} {
+                    checkRadiusAlgorithm(m_parameters.algorithm);
+                    checkWeights(m_parameters.weights, m_parameters.weights_callable);
+                }
+
+                void fit(utils::DenseMatrix<DataType> X, const std::vector<Label> &labels) {
+                    m_base.fit(std::move(X), labels.size(), 1);
+                    m_classes = encodeLabels(labels, m_codes);
+                }
+
+                [[nodiscard]] RadiusNeighbors radius_neighbors(const utils::DenseMatrix<DataType> &X, std::optional<np::float_> radius, bool return_distance, bool sort_results) const {
+                    return m_base.radius_neighbors(X, radius.value_or(m_parameters.radius), return_distance, sort_results);
+                }
+
+                [[nodiscard]] std::vector<Label> predict(const utils::DenseMatrix<DataType> &X) const {
+                    const bool distances = needDistances();
+                    const auto neighbors = m_base.radius_neighbors(X, m_parameters.radius, distances, false);
+                    const np::Size n_queries = neighbors.offsets.size() - 1;
+                    checkOutliers(neighbors, n_queries);
+                    Predictions<Label> pred(n_queries);
+                    m_base.forEachQuery(
+                            n_queries, [this] { return std::make_pair(Vote{m_classes.size(), 0}, RadiusRow{}); },
+                            [&](np::Size sample, std::pair<Vote, RadiusRow> &scratch) {
+                                auto &[vote, row] = scratch;
+                                const np::Size n = row.load(neighbors, sample, distances);
+                                if (n == 0) {
+                                    pred[sample] = *m_outlierLabel;
+                                    return;
+                                }
+                                vote.accumulate(m_parameters.weights, m_parameters.weights_callable, m_codes, row.indices.data(), row.distances.data(), n);
+                                pred[sample] = m_classes[vote.best(m_codes, row.indices.data(), n)];
+                                vote.clear(m_codes, row.indices.data(), n);
+                            });
+                    return labelsOf<Label>(std::move(pred));
+                }
+
+                // Rows of outliers are zero, unless the outlier label is one of the classes, which then gets 1.
+                [[nodiscard]] np::Array<np::float_> predict_proba(const utils::DenseMatrix<DataType> &X) const {
+                    const bool distances = needDistances();
+                    const auto neighbors = m_base.radius_neighbors(X, m_parameters.radius, distances, false);
+                    const np::Size n_queries = neighbors.offsets.size() - 1;
+                    checkOutliers(neighbors, n_queries);
+                    const np::Size n_classes = m_classes.size();
+                    std::optional<np::Size> outlier_code;
+                    if (m_outlierLabel) {
+                        const auto it = std::lower_bound(m_classes.cbegin(), m_classes.cend(), *m_outlierLabel);
+                        if (it != m_classes.cend() && *it == *m_outlierLabel) {
+                            outlier_code = static_cast<np::Size>(it - m_classes.cbegin());
+                        }
+                    }
+                    std::vector<np::float_> proba(n_queries * n_classes);
+                    m_base.forEachQuery(
+                            n_queries, [n_classes] { return std::make_pair(Vote{n_classes, 0}, RadiusRow{}); },
+                            [&](np::Size sample, std::pair<Vote, RadiusRow> &scratch) {
+                                auto &[vote, row] = scratch;
+                                const np::Size n = row.load(neighbors, sample, distances);
+                                const auto out = proba.begin() + static_cast<long>(sample * n_classes);
+                                if (n == 0) {
+                                    if (outlier_code) {
+                                        out[static_cast<long>(*outlier_code)] = 1;
+                                    }
+                                    return;
+                                }
+                                const auto &histogram = vote.accumulate(m_parameters.weights, m_parameters.weights_callable, m_codes, row.indices.data(), row.distances.data(), n);
+                                auto normalizer = std::accumulate(histogram.cbegin(), histogram.cend(), np::float_{0});
+                                if (normalizer == 0) {
+                                    normalizer = 1;
+                                }
+                                std::transform(histogram.cbegin(), histogram.cend(), out, [normalizer](np::float_ w) { return w / normalizer; });
+                                vote.clear(m_codes, row.indices.data(), n);
+                            });
+                    return np::Array<np::float_>{std::move(proba), np::Shape{n_queries, n_classes}};
+                }
+
+                [[nodiscard]] const std::vector<Label> &classes() const {
+                    return m_classes;
+                }
+
+                [[nodiscard]] AlgorithmType fitMethod() const {
+                    return m_base.fitMethod();
+                }
+
+            private:
+                [[nodiscard]] bool needDistances() const {
+                    return m_parameters.weights != WeightsType::kUniform;
+                }
+
+                void checkOutliers(const RadiusNeighbors &neighbors, np::Size n_queries) const {
+                    if (m_outlierLabel) {
+                        return;
+                    }
+                    for (np::Size i = 0; i < n_queries; ++i) {
+                        if (neighbors.offsets.get(i) == neighbors.offsets.get(i + 1)) {
+                            throw std::runtime_error("No neighbors found for test sample " + std::to_string(i) +
+                                                     ", you can try using larger radius, giving a label for outliers, or considering removing them from your dataset.");
+                        }
+                    }
+                }
+
+                RadiusNeighborsClassifierParameters m_parameters;
+                std::optional<Label> m_outlierLabel;
+                NeighborsBase<DataType> m_base;
+                std::vector<Label> m_classes;
+                // the index in m_classes of the label of every training sample
+                std::vector<np::Size> m_codes;
+            };
+        }// namespace internal
+
+        template<typename DataType, typename TargetType = DataType>
+        class RadiusNeighborsClassifier {
+        public:
+            // outlier_label - label given to outlier samples, the samples without neighbors within the radius. If not
+            // set, predicting an outlier throws.
+            explicit RadiusNeighborsClassifier(RadiusNeighborsClassifierParameters parameters = {}, std::optional<TargetType> outlier_label = std::nullopt)
+                : m_impl{std::move(parameters), std::move(outlier_label)} {
+            }
+
+            // Fit the radius neighbors classifier from the training dataset.
+            // X - training data
+            // y - target values
+            template<typename ArrayDataType, typename ArrayTargetType>
+            void fit(const ArrayDataType &X, const ArrayTargetType &y) {
+                fit(utils::DenseMatrix<DataType>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            template<typename ArrayTargetType>
+            void fit(utils::DenseMatrix<DataType> X, const ArrayTargetType &y) {
+                std::vector<TargetType> labels(y.size());
+                for (np::Size i = 0; i < labels.size(); ++i) {
+                    labels[i] = y.get(i);
+                }
+                m_impl.fit(std::move(X), labels);
+            }
+
+            // Predict the class labels for the provided data.
+            // X - test samples.
+            template<typename ArrayPredictType>
+            np::Array<TargetType> predict(const ArrayPredictType &X) const {
+                auto pred = m_impl.predict(utils::DenseMatrix<DataType>{X});
+                const np::Size n_queries = pred.size();
+                return np::Array<TargetType>{std::move(pred), np::Shape{n_queries}};
+            }
+
+            // Return probability estimates for the test data X, of shape (n_queries, n_classes) with classes ordered
+            // as in classes_().
+            template<typename ArrayPredictType>
+            np::Array<np::float_> predict_proba(const ArrayPredictType &X) const {
+                return m_impl.predict_proba(utils::DenseMatrix<DataType>{X});
+            }
+
+            // Find the neighbors within a given radius of a point.
+            // X - query points
+            // radius - limiting distance of neighbors to return, the radius parameter by default
+            // return_distance - whether or not to return the distances
+            // sort_results - whether to sort the neighbors of every query by increasing distance
+            // Returns the neighbors in compressed sparse row layout, see RadiusNeighbors.
+            template<typename ArrayPredictType>
+            RadiusNeighbors radius_neighbors(const ArrayPredictType &X, std::optional<np::float_> radius = std::nullopt, bool return_distance = true, bool sort_results = false) const {
+                return m_impl.radius_neighbors(utils::DenseMatrix<DataType>{X}, radius, return_distance, sort_results);
+            }
+
+            // The class labels known to the classifier, sorted.
+            [[nodiscard]] np::Array<TargetType> classes_() const {
+                return np::Array<TargetType>{m_impl.classes(), np::Shape{m_impl.classes().size()}};
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::RadiusNeighborsClassifierImpl<DataType, TargetType> m_impl;
+        };
+
+        template<>
+        class RadiusNeighborsClassifier<pd::DataFrame> {
+        public:
+            // outlier_label - label given to outlier samples, see RadiusNeighborsClassifier.
+            explicit RadiusNeighborsClassifier(RadiusNeighborsClassifierParameters parameters = {}, std::optional<pd::internal::Value> outlier_label = std::nullopt)
+                : m_impl{std::move(parameters), std::move(outlier_label)} {
+            }
+
+            // Fit the radius neighbors classifier from the training dataset.
+            // X - training data
+            // y - target values
+            void fit(const pd::DataFrame &X, const pd::DataFrame &y) {
+                fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            void fit(utils::DenseMatrix<np::float_> X, const pd::DataFrame &y) {
+                std::vector<pd::internal::Value> labels(y.shape()[0]);
+                for (np::Size i = 0; i < labels.size(); ++i) {
+                    labels[i] = y.at(i, 0);
+                }
+                m_impl.fit(std::move(X), labels);
+            }
+
+            // Predict the class labels for the provided data.
+            // X - test samples.
+            pd::DataFrame predict(const pd::DataFrame &X) const {
+                auto pred = m_impl.predict(utils::DenseMatrix<np::float_>{X});
+                const np::Size n_queries = pred.size();
+                return pd::DataFrame{np::Array<pd::internal::Value>{std::move(pred), np::Shape{n_queries}}};
+            }
+
+            // Return probability estimates for the test data X, see RadiusNeighborsClassifier::predict_proba.
+            np::Array<np::float_> predict_proba(const pd::DataFrame &X) const {
+                return m_impl.predict_proba(utils::DenseMatrix<np::float_>{X});
+            }
+
+            // Find the neighbors within a given radius of a point, see RadiusNeighborsClassifier::radius_neighbors.
+            RadiusNeighbors radius_neighbors(const pd::DataFrame &X, std::optional<np::float_> radius = std::nullopt, bool return_distance = true, bool sort_results = false) const {
+                return m_impl.radius_neighbors(utils::DenseMatrix<np::float_>{X}, radius, return_distance, sort_results);
+            }
+
+            // The class labels known to the classifier, sorted, as a single column: the columns of predict_proba.
+            [[nodiscard]] pd::DataFrame classes_() const {
+                return pd::DataFrame{np::Array<pd::internal::Value>{m_impl.classes(), np::Shape{m_impl.classes().size()}}};
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::RadiusNeighborsClassifierImpl<np::float_, pd::internal::Value> m_impl;
+        };
+    }// namespace neighbors
+}// namespace sklearn
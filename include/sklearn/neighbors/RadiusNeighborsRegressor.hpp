@@ -0,0 +1,204 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <pd/core/frame/DataFrame/DataFrame.hpp>
+#include <sklearn/metrics/DistanceMetricType.hpp>
+#include <sklearn/neighbors/AlgorithmType.hpp>
+#include <sklearn/neighbors/NeighborsBase.hpp>
+#include <sklearn/neighbors/WeightsType.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+
+namespace sklearn {
+    namespace neighbors {
+        /// Regression based on neighbors within a fixed radius: the target is predicted by the (weighted) mean of the
+        /// targets of the neighbors in the training set, NaN for samples without neighbors.
+        struct RadiusNeighborsRegressorParameters {
+            /// Range of parameter space to use by default for radius_neighbors queries.
+            np::float_ radius{1.0};
+            /// Weight function used in prediction, see KNeighborsClassifierParameters::weights.
+            WeightsType weights{WeightsType::kUniform};
+            AlgorithmType algorithm{AlgorithmType::kAuto};
+            int leaf_size{30};
+            np::float_ p{2};
+            metrics::DistanceMetricType metric{metrics::DistanceMetricType::kMinkowski};
+            /// The number of parallel jobs to run for neighbors search and averaging. -1 means using all processors,
+            /// see utils::effective_n_jobs. Predictions do not depend on it.
+            int n_jobs{1};
+            /// The weight of a neighbor as a function of its distance, used with weights = kCallable.
+            WeightsCallable weights_callable{};
+            /// Precision of the brute force distances on float32 data (DataType = float), see utils::Accumulation.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
+        };
+
+        namespace internal {
+            // The search and the averaging of the radius regressors over arrays and over data frames.
+            template<typename DataType>
+            class RadiusNeighborsRegressorImpl {
+            public:
+                explicit RadiusNeighborsRegressorImpl(RadiusNeighborsRegressorParameters parameters)
+                    : m_parameters{std::move(parameters)},
+                      m_base{m_parameters.algorithm, m_parameters.leaf_size, m_parameters.metric, m_parameters.p, m_parameters.n_jobs, {}, {}, m_parameters.accumulation} {
+                    checkRadiusAlgorithm(m_parameters.algorithm);
+                    checkWeights(m_parameters.weights, m_parameters.weights_callable);
+                }
+
+                void fit(utils::DenseMatrix<DataType> X, std::vector<np::float_> targets) {
+                    m_base.fit(std::move(X), targets.size(), 1);
+                    m_targets = std::move(targets);
+                }
+
+                [[nodiscard]] RadiusNeighbors radius_neighbors(const utils::DenseMatrix<DataType> &X, std::optional<np::float_> radius, bool return_distance, bool sort_results) const {
+                    return m_base.radius_neighbors(X, radius.value_or(m_parameters.radius), return_distance, sort_results);
+                }
+
+                [[nodiscard]] std::vector<np::float_> predict(const utils::DenseMatrix<DataType> &X) const {
+                    const bool distances = m_parameters.weights != WeightsType::kUniform;
+                    const auto neighbors = m_base.radius_neighbors(X, m_parameters.radius, distances, false);
+                    const np::Size n_queries = neighbors.offsets.size() - 1;
+                    std::vector<np::float_> pred(n_queries);
+                    m_base.forEachQuery(
+                            n_queries, [] { return std::make_pair(Average{0}, RadiusRow{}); },
+                            [&](np::Size sample, std::pair<Average, RadiusRow> &scratch) {
+                                auto &[average, row] = scratch;
+                                const np::Size n = row.load(neighbors, sample, distances);
+                                pred[sample] = average(m_parameters.weights, m_parameters.weights_callable, m_targets, row.indices.data(), row.distances.data(), n);
+                            });
+                    return pred;
+                }
+
+                [[nodiscard]] AlgorithmType fitMethod() const {
+                    return m_base.fitMethod();
+                }
+
+            private:
+                RadiusNeighborsRegressorParameters m_parameters;
+                NeighborsBase<DataType> m_base;
+                std::vector<np::float_> m_targets;
+            };
+        }// namespace internal
+
+        template<typename DataType>
+        class RadiusNeighborsRegressor {
+        public:
+            explicit RadiusNeighborsRegressor(RadiusNeighborsRegressorParameters parameters = {})
+                : m_impl{std::move(parameters)} {
+            }
+
+            // Fit the radius neighbors regressor from the training dataset.
+            // X - training data
+            // y - target values, one per sample
+            template<typename ArrayDataType, typename ArrayTargetType>
+            void fit(const ArrayDataType &X, const ArrayTargetType &y) {
+                fit(utils::DenseMatrix<DataType>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            template<typename ArrayTargetType>
+            void fit(utils::DenseMatrix<DataType> X, const ArrayTargetType &y) {
+                std::vector<np::float_> targets(y.size());
+                for (np::Size i = 0; i < targets.size(); ++i) {
+                    targets[i] = static_cast<np::float_>(y.get(i));
+                }
+                m_impl.fit(std::move(X), std::move(targets));
+            }
+
+            // Predict the target for the provided data, NaN for samples without neighbors within the radius.
+            // X - test samples.
+            template<typename ArrayPredictType>
+            np::Array<np::float_> predict(const ArrayPredictType &X) const {
+                auto pred = m_impl.predict(utils::DenseMatrix<DataType>{X});
+                const np::Size n_queries = pred.size();
+                return np::Array<np::float_>{std::move(pred), np::Shape{n_queries}};
+            }
+
+            // Find the neighbors within a given radius of a point, see RadiusNeighborsClassifier::radius_neighbors.
+            template<typename ArrayPredictType>
+            RadiusNeighbors radius_neighbors(const ArrayPredictType &X, std::optional<np::float_> radius = std::nullopt, bool return_distance = true, bool sort_results = false) const {
+                return m_impl.radius_neighbors(utils::DenseMatrix<DataType>{X}, radius, return_distance, sort_results);
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::RadiusNeighborsRegressorImpl<DataType> m_impl;
+        };
+
+        template<>
+        class RadiusNeighborsRegressor<pd::DataFrame> {
+        public:
+            explicit RadiusNeighborsRegressor(RadiusNeighborsRegressorParameters parameters = {})
+                : m_impl{std::move(parameters)} {
+            }
+
+            // Fit the radius neighbors regressor from the training dataset.
+            // X - training data
+            // y - target values, a single column
+            void fit(const pd::DataFrame &X, const pd::DataFrame &y) {
+                fit(utils::DenseMatrix<np::float_>{X}, y);
+            }
+
+            // Fit from a row-major training matrix without copying it: an owning matrix is moved into the index, a
+            // utils::DenseMatrix::view of caller-owned data is borrowed and has to outlive the estimator and its
+            // copies, see utils::DenseMatrix. Only the targets are copied.
+            void fit(utils::DenseMatrix<np::float_> X, const pd::DataFrame &y) {
+                std::vector<np::float_> targets(y.shape()[0]);
+                for (np::Size i = 0; i < targets.size(); ++i) {
+                    targets[i] = static_cast<np::float_>(y.at(i, 0));
+                }
+                m_impl.fit(std::move(X), std::move(targets));
+            }
+
+            // Predict the target for the provided data, NaN for samples without neighbors within the radius.
+            // X - test samples.
+            pd::DataFrame predict(const pd::DataFrame &X) const {
+                const auto pred = m_impl.predict(utils::DenseMatrix<np::float_>{X});
+                std::vector<pd::internal::Value> values(pred.cbegin(), pred.cend());
+                return pd::DataFrame{np::Array<pd::internal::Value>{std::move(values), np::Shape{pred.size()}}};
+            }
+
+            // Find the neighbors within a given radius of a point, see RadiusNeighborsClassifier::radius_neighbors.
+            RadiusNeighbors radius_neighbors(const pd::DataFrame &X, std::optional<np::float_> radius = std::nullopt, bool return_distance = true, bool sort_results = false) const {
+                return m_impl.radius_neighbors(utils::DenseMatrix<np::float_>{X}, radius, return_distance, sort_results);
+            }
+
+            // The algorithm used by the fitted estimator, kAuto resolved.
+            [[nodiscard]] AlgorithmType fit_method_() const {
+                return m_impl.fitMethod();
+            }
+
+        private:
+            internal::RadiusNeighborsRegressorImpl<np::float_> m_impl;
+        };
+    }// namespace neighbors
+}// namespace sklearn
@@ -29,8 +29,12 @@ SOFTWARE.
 #include <np/DType.hpp>
 
 #include <sklearn/model_selection/train_test_split.hpp>
+#include <sklearn/utils/Accumulation.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
 
+#include <cmath>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace sklearn {
@@ -46,8 +50,59 @@ namespace sklearn {
             bool with_mean{true};
             /// if true, scale the data to unit variance (or equivalently, unit standard deviation).
             bool with_std{true};
+            /// Precision of the statistics and of the scaling of float32 data (DType = float), see utils::Accumulation.
+            /// The statistics are stored as np::float_ anyway.
+            utils::Accumulation accumulation{utils::Accumulation::kFloat64};
         };
 
+        namespace internal {
+            struct ScaleRows {
+                // data[i * n_features + j] = (data[i * n_features + j] - mean[j]) / scale[j], in place, computed in Acc.
+                template<typename DType, typename Acc>
+                SKLEARN_ALWAYS_INLINE static void run(DType *data, np::Size n_samples, np::Size n_features, const Acc *mean, const Acc *scale) {
+                    for (np::Size i = 0; i < n_samples; ++i) {
+                        DType *x = data + i * n_features;
+                        for (np::Size j = 0; j < n_features; ++j) {
+                            x[j] = static_cast<DType>((static_cast<Acc>(x[j]) - mean[j]) / scale[j]);
+                        }
+                    }
+                }
+            };
+
+            // The mean and, if var is not null, the variance of every column of the row-major data, summed in Acc.
+            // The variance takes a second pass over the deviations from the mean, as numpy does, so that a large mean
+            // does not cancel it. Both passes read the rows in order and sum all the columns at once.
+            template<typename Acc, typename DType>
+            void columnMoments(const DType *data, np::Size n_samples, np::Size n_features, std::vector<np::float_> &mean, std::vector<np::float_> *var) {
+                std::vector<Acc> sums(n_features, Acc{0});
+                for (np::Size i = 0; i < n_samples; ++i) {
+                    const DType *x = data + i * n_features;
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        sums[j] += static_cast<Acc>(x[j]);
+                    }
+                }
+                for (auto &sum: sums) {
+                    sum /= static_cast<Acc>(n_samples);
+                }
+                mean.assign(sums.cbegin(), sums.cend());
+                if (var == nullptr) {
+                    return;
+                }
+                std::vector<Acc> squares(n_features, Acc{0});
+                for (np::Size i = 0; i < n_samples; ++i) {
+                    const DType *x = data + i * n_features;
+                    for (np::Size j = 0; j < n_features; ++j) {
+                        const Acc deviation = static_cast<Acc>(x[j]) - sums[j];
+                        squares[j] += deviation * deviation;
+                    }
+                }
+                for (auto &square: squares) {
+                    square /= static_cast<Acc>(n_samples);
+                }
+                var->assign(squares.cbegin(), squares.cend());
+            }
+        }// namespace internal
+
         /* Standardize features by removing the mean and scaling to unit variance.
         The standard score of a sample x is calculated as:
         z = (x - u) / s
@@ -76,28 +131,40 @@ namespace sklearn {
                 : m_parameters{parameters} {
             }
 
+            // The statistics are computed in one read of the samples per moment, in the precision chosen by
+            // StandardScalerParameters::accumulation.
             StandardScaler &fit(const np::Array<DType> &array) {
                 if (array.shape().size() != 2) {
                     throw std::runtime_error("Array must be 2-dimensional");
                 }
+                const np::Size n_samples = array.shape()[0];
                 np::Size size = array.shape()[1];
+                m_n_features_in = size;
+                if (!m_parameters.with_mean && !m_parameters.with_std) {
+                    return *this;
+                }
+                std::vector<DType> data(array.size());
+                for (np::Size i = 0; i < data.size(); ++i) {
+                    data[i] = array.get(i);
+                }
+                std::vector<np::float_> mean;
+                std::vector<np::float_> var;
+                utils::visit_accumulator<DType>(m_parameters.accumulation, [&](auto zero) {
+                    internal::columnMoments<decltype(zero)>(data.data(), n_samples, size, mean, m_parameters.with_std ? &var : nullptr);
+                });
                 if (m_parameters.with_mean) {
-                    m_mean = np::Array<np::float_>{np::Shape{size}};
-                    for (np::Size i = 0; i < size; ++i) {
-                        m_mean.set(i, array[":," + std::to_string(i)].mean());
-                    }
+                    m_mean = np::Array<np::float_>{mean, np::Shape{size}};
                 }
                 if (m_parameters.with_std) {
-                    m_var = np::Array<np::float_>{np::Shape{size}};
+                    m_var = np::Array<np::float_>{var, np::Shape{size}};
+                    std::vector<np::float_> scale(size);
                     for (np::Size i = 0; i < size; ++i) {
-                        m_var.set(i, array[":," + std::to_string(i)].var());
+                        scale[i] = std::sqrt(var[i]);
                     }
-                    m_scale = m_var.sqrt();
-                    if (std::all_of(m_scale.cbegin(), m_scale.cend(), [](auto element) { return element == 0; })) {
-                        for (np::Size i = 0; i < m_scale.size(); ++i) {
-                            m_scale.set(i, 1);
-                        }
+                    if (std::all_of(scale.cbegin(), scale.cend(), [](auto element) { return element == 0; })) {
+                        std::fill(scale.begin(), scale.end(), np::float_{1});
                     }
+                    m_scale = np::Array<np::float_>{scale, np::Shape{size}};
                 }
                 return *this;
             }
@@ -107,6 +174,7 @@ namespace sklearn {
                     throw std::runtime_error("DataFrame must be 2-dimensional");
                 }
                 np::Size size = dataFrame.shape()[1];
+                m_n_features_in = size;
                 if (m_parameters.with_mean) {
                     m_mean = np::Array<np::float_>{np::Shape{size}};
                     for (np::Size i = 0; i < size; ++i) {
@@ -128,8 +196,37 @@ namespace sklearn {
                 return *this;
             }
 
+            // Samples are the rows of array (a 1-dimensional array is a single sample). They are copied into a
+            // contiguous buffer and scaled by a kernel compiled for every level of utils::cpu_dispatch, in the
+            // precision chosen by StandardScalerParameters::accumulation; the result keeps the type of the samples.
             np::Array<DType> transform(const np::Array<DType> &array) {
-                return array.subtract(m_mean).divide(m_scale);
+                if (m_n_features_in == 0) {
+                    throw std::runtime_error("StandardScaler is not fitted");
+                }
+                const auto shape = array.shape();
+                const np::Size n_features = shape.size() == 0 ? 0 : shape[shape.size() - 1];
+                if (n_features != m_n_features_in) {
+                    throw std::runtime_error("X has " + std::to_string(n_features) + " features, but StandardScaler is expecting " + std::to_string(m_n_features_in) + " features as input");
+                }
+                std::vector<DType> data(array.size());
+                for (np::Size i = 0; i < data.size(); ++i) {
+                    data[i] = array.get(i);
+                }
+                utils::visit_accumulator<DType>(m_parameters.accumulation, [&](auto zero) {
+                    using Acc = decltype(zero);
+                    std::vector<Acc> mean(m_n_features_in, Acc{0});
+                    std::vector<Acc> scale(m_n_features_in, Acc{1});
+                    for (np::Size j = 0; j < m_n_features_in; ++j) {
+                        if (m_parameters.with_mean) {
+                            mean[j] = static_cast<Acc>(m_mean.get(j));
+                        }
+                        if (m_parameters.with_std) {
+                            scale[j] = static_cast<Acc>(m_scale.get(j));
+                        }
+                    }
+                    utils::cpu_dispatch<internal::ScaleRows>(data.data(), data.size() / m_n_features_in, m_n_features_in, mean.data(), scale.data());
+                });
+                return np::Array<DType>{std::move(data), shape};
             }
 
             pd::DataFrame transform(const pd::DataFrame &dataFrame) {
@@ -146,15 +243,16 @@ namespace sklearn {
                 return transform(dataFrame);
             }
 
-            const np::Array<DType> &mean_() const {
+            // The statistics are np::float_ whatever DType is, as in scikit-learn.
+            const np::Array<np::float_> &mean_() const {
                 return m_mean;
             }
 
-            const np::Array<DType> &var_() const {
+            const np::Array<np::float_> &var_() const {
                 return m_var;
             }
 
-            const np::Array<DType> &scale_() const {
+            const np::Array<np::float_> &scale_() const {
                 return m_scale;
             }
 
@@ -163,6 +261,7 @@ namespace sklearn {
             np::Array<np::float_> m_mean;
             np::Array<np::float_> m_var;
             np::Array<np::float_> m_scale;
+            np::Size m_n_features_in{0};
         };
 
     }// namespace preprocessing
@@ -0,0 +1,58 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <type_traits>
+
+#include <np/Array.hpp>
+
+namespace sklearn {
+    namespace utils {
+        // Precision of the sums of the kernels over float32 data. Any other data are summed in np::float_.
+        enum class Accumulation {
+            // float32 elements are widened and summed in np::float_: the results are as accurate as for float64 data,
+            // reading the data still costs half the memory traffic
+            kFloat64,
+            // sums in float32, twice the SIMD lanes of kFloat64. The relative error grows with the number of terms,
+            // and Euclidean distances computed from the row norms lose most of their digits for close rows
+            kFloat32
+        };
+
+        // The type of the results computed from DType data: float32 stays float32, anything else gives np::float_.
+        template<typename DType>
+        using result_t = std::conditional_t<std::is_same_v<DType, float>, float, np::float_>;
+
+        // Calls f with a zero of the type DType data are summed in: float for float32 data with
+        // Accumulation::kFloat32, np::float_ otherwise. Only the branches possible for DType are instantiated, and both
+        // must return the same type.
+        template<typename DType, typename F>
+        decltype(auto) visit_accumulator(Accumulation accumulation, F &&f) {
+            if constexpr (std::is_same_v<DType, float>) {
+                if (accumulation == Accumulation::kFloat32) {
+                    return f(float{0});
+                }
+            }
+            return f(np::float_{0});
+        }
+    }// namespace utils
+}// namespace sklearn
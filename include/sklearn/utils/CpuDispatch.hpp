@@ -0,0 +1,168 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Hot kernels are compiled for several instruction set levels and the level is chosen at run time, so that one binary
+// runs on any x86-64 CPU and still uses AVX2 or AVX-512 where they are available.
+// Elsewhere (other compilers or architectures) only the baseline version exists.
+// Kernels keep the order of every sum at all levels, but the AVX2 and AVX-512 versions may contract a * b + c into
+// one FMA instruction, so products can differ from the baseline in the last bit.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SKLEARN_CPU_DISPATCH 1
+#define SKLEARN_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SKLEARN_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512vl,avx2,fma")))
+#define SKLEARN_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SKLEARN_CPU_DISPATCH 0
+#define SKLEARN_TARGET_AVX2
+#define SKLEARN_TARGET_AVX512
+#define SKLEARN_ALWAYS_INLINE inline
+#endif
+
+namespace sklearn {
+    namespace utils {
+        enum class CpuLevel {
+            kBaseline,// the instruction set the library is compiled for, SSE2 on x86-64
+            kAvx2,    // AVX2 and FMA
+            kAvx512   // AVX-512 F, DQ and VL
+        };
+
+        inline const char *cpu_level_name(CpuLevel level) {
+            switch (level) {
+                case CpuLevel::kBaseline:
+                    return "baseline";
+                case CpuLevel::kAvx2:
+                    return "avx2";
+                case CpuLevel::kAvx512:
+                    return "avx512";
+            }
+            return "";
+        }
+
+        // The highest level supported by the CPU, from cpuid.
+        inline CpuLevel detected_cpu_level() {
+#if SKLEARN_CPU_DISPATCH
+            static const CpuLevel level = []() {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+                    return CpuLevel::kAvx512;
+                }
+                if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                    return CpuLevel::kAvx2;
+                }
+                return CpuLevel::kBaseline;
+            }();
+            return level;
+#else
+            return CpuLevel::kBaseline;
+#endif
+        }
+
+        namespace internal {
+            inline CpuLevel parseCpuLevel(const std::string &name) {
+                for (auto level: {CpuLevel::kBaseline, CpuLevel::kAvx2, CpuLevel::kAvx512}) {
+                    if (name == cpu_level_name(level)) {
+                        return level;
+                    }
+                }
+                throw std::runtime_error("Unknown CPU level " + name + ", expected baseline, avx2 or avx512");
+            }
+
+            inline void checkCpuLevel(CpuLevel level) {
+                if (level > detected_cpu_level()) {
+                    throw std::runtime_error(std::string{"CPU level "} + cpu_level_name(level) + " is not supported by this CPU, the highest one is " + cpu_level_name(detected_cpu_level()));
+                }
+            }
+
+            // The level used by the kernels. On first use it is taken from the SKLEARN_CPU_LEVEL environment variable
+            // (baseline, avx2 or avx512) if it is set, otherwise the detected level is used.
+            inline std::atomic<CpuLevel> &activeCpuLevel() {
+                static std::atomic<CpuLevel> level{[]() {
+                    const char *name = std::getenv("SKLEARN_CPU_LEVEL");
+                    if (name == nullptr || *name == '\0') {
+                        return detected_cpu_level();
+                    }
+                    const auto level = parseCpuLevel(name);
+                    checkCpuLevel(level);
+                    return level;
+                }()};
+                return level;
+            }
+        }// namespace internal
+
+        // The level the kernels currently run at.
+        inline CpuLevel cpu_level() {
+            return internal::activeCpuLevel().load(std::memory_order_relaxed);
+        }
+
+        // Forces the kernels to run at the level, e.g. to compare levels or to reproduce results of another machine.
+        // Throws if the CPU does not support the level.
+        inline void set_cpu_level(CpuLevel level) {
+            internal::checkCpuLevel(level);
+            internal::activeCpuLevel().store(level, std::memory_order_relaxed);
+        }
+
+        namespace internal {
+            template<typename Kernel, typename... Args>
+            SKLEARN_TARGET_AVX512 decltype(auto) runAvx512(Args &&...args) {
+                return Kernel::run(std::forward<Args>(args)...);
+            }
+
+            template<typename Kernel, typename... Args>
+            SKLEARN_TARGET_AVX2 decltype(auto) runAvx2(Args &&...args) {
+                return Kernel::run(std::forward<Args>(args)...);
+            }
+
+            template<typename Kernel, typename... Args>
+            decltype(auto) runBaseline(Args &&...args) {
+                return Kernel::run(std::forward<Args>(args)...);
+            }
+        }// namespace internal
+
+        // Runs Kernel::run(args...) compiled for the current cpu_level().
+        // Kernel::run must be declared SKLEARN_ALWAYS_INLINE: it is inlined into one wrapper per level, and each wrapper
+        // is compiled with the instruction set of its level.
+        template<typename Kernel, typename... Args>
+        decltype(auto) cpu_dispatch(Args &&...args) {
+#if SKLEARN_CPU_DISPATCH
+            switch (cpu_level()) {
+                case CpuLevel::kAvx512:
+                    return internal::runAvx512<Kernel>(std::forward<Args>(args)...);
+                case CpuLevel::kAvx2:
+                    return internal::runAvx2<Kernel>(std::forward<Args>(args)...);
+                case CpuLevel::kBaseline:
+                    break;
+            }
+#endif
+            return internal::runBaseline<Kernel>(std::forward<Args>(args)...);
+        }
+    }// namespace utils
+}// namespace sklearn
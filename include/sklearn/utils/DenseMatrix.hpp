@@ -0,0 +1,138 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <pd/core/frame/DataFrame/DataFrame.hpp>
+
+namespace sklearn {
+    namespace utils {
+        // Row-major contiguous matrix.
+        // Hot kernels (distances, tree searches) work on raw row pointers, so the input arrays or data frames are
+        // converted into this layout once and then accessed without any per-element indexing overhead.
+        // A matrix either owns its elements or, if made by view, is a read-only view of row-major data owned by the
+        // caller: the data must stay alive and unchanged for as long as the view or any copy of it is in use.
+        template<typename DType = np::float_>
+        class DenseMatrix {
+        public:
+            DenseMatrix() = default;
+
+            DenseMatrix(np::Size rows, np::Size cols, DType value = DType{})
+                : m_rows{rows}, m_cols{cols}, m_data(rows * cols, value) {
+            }
+
+            template<typename DTypeX, typename DerivedX, typename StorageX>
+            explicit DenseMatrix(const np::ndarray::internal::NDArrayBase<DTypeX, DerivedX, StorageX> &X) {
+                if (X.ndim() != 2) {
+                    throw std::runtime_error("2D array expected");
+                }
+                m_rows = X.shape()[0];
+                m_cols = X.shape()[1];
+                m_data.resize(m_rows * m_cols);
+                for (np::Size i = 0; i < m_data.size(); ++i) {
+                    m_data[i] = static_cast<DType>(X.get(i));
+                }
+            }
+
+            // A non-owning view of rows x cols row-major elements at data, see the lifetime rules above. Copies of the
+            // view are views of the same data.
+            static DenseMatrix view(const DType *data, np::Size rows, np::Size cols) {
+                DenseMatrix matrix;
+                matrix.m_rows = rows;
+                matrix.m_cols = cols;
+                matrix.m_view = data;
+                return matrix;
+            }
+
+            // Converts the frame column by column: every column is looked up once and read sequentially, instead of
+            // resolving the column of every element.
+            explicit DenseMatrix(const pd::DataFrame &X) {
+                if (X.shape().size() != 2) {
+                    throw std::runtime_error("DataFrame must be 2-dimensional");
+                }
+                m_rows = X.shape()[0];
+                m_cols = X.shape()[1];
+                m_data.resize(m_rows * m_cols);
+                np::Size j = 0;
+                for (const auto &columnName: X.columns().getIndex()) {
+                    const auto &series = X[columnName];
+                    DType *column = m_data.data() + j;
+                    for (np::Size i = 0; i < m_rows; ++i) {
+                        column[i * m_cols] = static_cast<DType>(static_cast<np::float_>(series.at(i)));
+                    }
+                    ++j;
+                }
+            }
+
+            [[nodiscard]] np::Size rows() const {
+                return m_rows;
+            }
+
+            [[nodiscard]] np::Size cols() const {
+                return m_cols;
+            }
+
+            [[nodiscard]] bool empty() const {
+                return m_rows * m_cols == 0;
+            }
+
+            // Whether the matrix is a view of caller-owned data.
+            [[nodiscard]] bool is_view() const {
+                return m_view != nullptr;
+            }
+
+            [[nodiscard]] const DType *data() const {
+                return m_view != nullptr ? m_view : m_data.data();
+            }
+
+            DType *data() {
+                checkWritable();
+                return m_data.data();
+            }
+
+            [[nodiscard]] const DType *row(np::Size i) const {
+                return data() + i * m_cols;
+            }
+
+            DType *row(np::Size i) {
+                return data() + i * m_cols;
+            }
+
+        private:
+            void checkWritable() const {
+                if (m_view != nullptr) {
+                    throw std::runtime_error("DenseMatrix view is read-only");
+                }
+            }
+
+            np::Size m_rows{0};
+            np::Size m_cols{0};
+            std::vector<DType> m_data;
+            const DType *m_view{nullptr};
+        };
+    }// namespace utils
+}// namespace sklearn
@@ -0,0 +1,160 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+
+namespace sklearn {
+    namespace utils {
+        namespace internal {
+            // C[i * ldc + j] = op(... op(op(0, A[i][0], B[j][0]), A[i][1], B[j][1]) ..., A[i][k - 1], B[j][k - 1])
+            // for the m rows of A and the n rows of B (row strides lda and ldb), that is a fold of op over the coordinates
+            // of every pair of rows, starting from zero. The fold runs in the element type Acc of C, the elements of A
+            // and B are converted to it: float accumulators fill twice the SIMD lanes of np::float_ ones.
+            // Rows of B are packed by panels of kCols, coordinate-major, into a buffer on the stack, and kRows rows of A
+            // are folded against a panel at once: the kRows x kCols accumulators are independent and consecutive in
+            // memory, so the innermost loop is vectorized across the rows of B without reordering any fold.
+            // Coordinates are packed kDepth at a time and the folds of the following blocks continue from the values
+            // stored in C, so the result does not depend on the blocking.
+            template<typename Op, typename DType, typename Acc>
+            SKLEARN_ALWAYS_INLINE void foldPairs(const Op &op, const DType *A, np::Size lda, const DType *B, np::Size ldb, np::Size m, np::Size n, np::Size k, Acc *C, np::Size ldc) {
+                constexpr np::Size kRows = 4;
+                constexpr np::Size kCols = 16;
+                constexpr np::Size kDepth = 128;
+                alignas(64) Acc panel[kDepth * kCols];
+
+                // Accumulators are initialized from a full kRows x kCols copy of C: a load guarded by the width of the
+                // last panel keeps GCC from holding them in registers.
+                const auto load = [&](Acc(&acc)[kCols], np::Size i, np::Size j0, np::Size cols, bool first) {
+                    alignas(64) Acc init[kCols] = {};
+                    if (!first) {
+                        std::copy_n(C + i * ldc + j0, cols, init);
+                    }
+                    for (np::Size c = 0; c < kCols; ++c) {
+                        acc[c] = init[c];
+                    }
+                };
+
+                if (k == 0) {
+                    for (np::Size i = 0; i < m; ++i) {
+                        std::fill(C + i * ldc, C + i * ldc + n, Acc{0});
+                    }
+                    return;
+                }
+                for (np::Size j0 = 0; j0 < n; j0 += kCols) {
+                    const np::Size cols = std::min(kCols, n - j0);
+                    for (np::Size p0 = 0; p0 < k; p0 += kDepth) {
+                        const np::Size depth = std::min(kDepth, k - p0);
+                        for (np::Size c = 0; c < kCols; ++c) {
+                            const DType *b = B + (j0 + std::min(c, cols - 1)) * ldb + p0;
+                            for (np::Size p = 0; p < depth; ++p) {
+                                panel[p * kCols + c] = static_cast<Acc>(b[p]);
+                            }
+                        }
+                        const np::Size tiled = m - m % kRows;
+                        for (np::Size i = 0; i < tiled; i += kRows) {
+                            Acc acc[kRows][kCols];
+                            for (np::Size r = 0; r < kRows; ++r) {
+                                load(acc[r], i + r, j0, cols, p0 == 0);
+                            }
+                            const DType *a = A + i * lda + p0;
+                            for (np::Size p = 0; p < depth; ++p) {
+                                const Acc *b = panel + p * kCols;
+                                // The elements of A are read in the innermost loop on purpose: the compiler broadcasts
+                                // them once per p, while locals hoisted here made it spill the accumulators.
+                                for (np::Size c = 0; c < kCols; ++c) {
+                                    for (np::Size r = 0; r < kRows; ++r) {
+                                        acc[r][c] = op(acc[r][c], static_cast<Acc>(a[r * lda + p]), b[c]);
+                                    }
+                                }
+                            }
+                            for (np::Size r = 0; r < kRows; ++r) {
+                                std::copy_n(acc[r], cols, C + (i + r) * ldc + j0);
+                            }
+                        }
+                        for (np::Size i = tiled; i < m; ++i) {
+                            Acc acc[kCols];
+                            load(acc, i, j0, cols, p0 == 0);
+                            const DType *a = A + i * lda + p0;
+                            for (np::Size p = 0; p < depth; ++p) {
+                                const Acc *b = panel + p * kCols;
+                                for (np::Size c = 0; c < kCols; ++c) {
+                                    acc[c] = op(acc[c], static_cast<Acc>(a[p]), b[c]);
+                                }
+                            }
+                            std::copy_n(acc, cols, C + i * ldc + j0);
+                        }
+                    }
+                }
+            }
+
+            struct RowNorms {
+                template<typename DType, typename Acc>
+                SKLEARN_ALWAYS_INLINE static void run(const DenseMatrix<DType> &X, bool squared, Acc *norms) {
+                    for (np::Size i = 0; i < X.rows(); ++i) {
+                        const auto *x = X.row(i);
+                        Acc norm{0};
+                        for (np::Size f = 0; f < X.cols(); ++f) {
+                            norm += static_cast<Acc>(x[f]) * static_cast<Acc>(x[f]);
+                        }
+                        norms[i] = squared ? norm : std::sqrt(norm);
+                    }
+                }
+            };
+
+            struct DotTransposed {
+                template<typename DType, typename Acc>
+                SKLEARN_ALWAYS_INLINE static void run(const DType *A, np::Size lda, const DType *B, np::Size ldb, np::Size m, np::Size n, np::Size k, Acc *C, np::Size ldc) {
+                    foldPairs([](Acc acc, Acc a, Acc b) { return acc + a * b; }, A, lda, B, ldb, m, n, k, C, ldc);
+                }
+            };
+        }// namespace internal
+
+        // Euclidean norms of the rows of X, squared if requested, summed in Acc.
+        template<typename Acc = np::float_, typename DType>
+        std::vector<Acc> row_norms(const DenseMatrix<DType> &X, bool squared = false) {
+            std::vector<Acc> norms(X.rows());
+            cpu_dispatch<internal::RowNorms>(X, squared, norms.data());
+            return norms;
+        }
+
+        // C = A * B^T for row-major A of shape (m, k) and B of shape (n, k), C of shape (m, n).
+        // lda, ldb and ldc are the row strides, so the function also works on blocks of larger matrices.
+        // A packed panel of 16 rows of B stays in cache while the rows of A sweep over it, 4 rows at a time, so every
+        // loaded element is used several times (see internal::foldPairs). Every dot product is summed in the order
+        // of the coordinates, as in a plain loop, in the element type of C. The kernel is compiled for every level of
+        // utils::cpu_dispatch.
+        template<typename DType, typename Acc>
+        void dot_transposed(const DType *A, np::Size lda, const DType *B, np::Size ldb, np::Size m, np::Size n, np::Size k, Acc *C, np::Size ldc) {
+            cpu_dispatch<internal::DotTransposed>(A, lda, B, ldb, m, n, k, C, ldc);
+        }
+    }// namespace utils
+}// namespace sklearn
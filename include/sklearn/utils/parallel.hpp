@@ -0,0 +1,50 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace sklearn {
+    namespace utils {
+        // Number of threads for n_jobs, with the meaning it has in scikit-learn: a positive value is the number of
+        // threads, -1 means all the processors, -2 all of them but one, and so on. Without OpenMP it is always 1.
+        inline int effective_n_jobs(int n_jobs) {
+            if (n_jobs == 0) {
+                throw std::runtime_error("n_jobs == 0 has no meaning");
+            }
+#ifdef _OPENMP
+            if (n_jobs < 0) {
+                return std::max(omp_get_num_procs() + 1 + n_jobs, 1);
+            }
+            return n_jobs;
+#else
+            return 1;
+#endif
+        }
+    }// namespace utils
+}// namespace sklearn
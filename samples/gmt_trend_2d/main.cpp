@@ -125,6 +125,7 @@ auto generate_data(auto rank, auto num_points, auto noise_level) {
     return column_stack(x, y, z);
 }
 
+// Mean time of a run, in milliseconds.
 auto measure_time(auto func, auto data, int rank, int n_runs) {
     timespec start_time{};
     clock_gettime(CLOCK_MONOTONIC, &start_time);
@@ -133,22 +134,24 @@ auto measure_time(auto func, auto data, int rank, int n_runs) {
     }
     timespec end_time{};
     clock_gettime(CLOCK_MONOTONIC, &end_time);
-    return 1000000000 * (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec);
+    return (1000.0 * static_cast<float_>(end_time.tv_sec - start_time.tv_sec) + static_cast<float_>(end_time.tv_nsec - start_time.tv_nsec) / 1e6) / n_runs;
 }
 
 struct Result {
     int rank;
     int noise_level;
-    int gmt_time;
+    float_ gmt_time;
 };
 
+// Every iteration of GMT_trend2d is a weighted fit: the weights scale the rows in place, so the memory of a run is
+// O(num_points), while a dense diag(w) took num_points^2 elements, 80 GB at the default size.
 void test_time(int num_points = 100 * 1000, int n_runs = 50, const std::vector<int> &ranks = {1, 2, 3}, const std::vector<int> &noise_levels = {0, 1, 10, 50}) {
     std::vector<Result> results;
     for (auto rank: ranks) {
         for (auto noise_level: noise_levels) {
             auto data = generate_data(rank, num_points, noise_level);
 
-            int gmt_time = 1000 * measure_time(GMT_trend2d, data, rank, n_runs);
+            auto gmt_time = measure_time(GMT_trend2d, data, rank, n_runs);
             results.push_back({rank, noise_level, gmt_time});
         }
     }
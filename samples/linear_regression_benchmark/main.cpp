@@ -0,0 +1,147 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/linear_model/LinearRegression.hpp>
+
+using namespace sklearn;
+
+// Fit time and memory of the LinearRegression solvers on a tall design, by default n_samples = 10M and
+// n_features = 200: X alone takes 16 GB, pass smaller sizes as arguments on smaller machines:
+//     linear_regression_benchmark [n_samples [n_features]]
+// X is fitted through a utils::DenseMatrix::view, so the only memory a fit allocates is its own. Every global
+// operator new records its size, and the table shows the peak of the bytes a fit keeps allocated at once next to the
+// peak resident set size of the process, which includes X.
+// Forming (X^T X)^-1 X^T y from a copy of X with a column of ones, as the fit did before the solvers, needed the
+// copy, its transpose and the n_samples x (n_features + 1) product of the inverse and X^T: three more copies of X.
+
+static std::atomic<std::size_t> allocated_bytes{0};
+static std::atomic<std::size_t> peak_bytes{0};
+
+// Blocks are counted by their usable size, which is known again when they are freed.
+void *operator new(std::size_t size) {
+    void *p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc{};
+    }
+    const auto bytes = allocated_bytes += malloc_usable_size(p);
+    auto peak = peak_bytes.load();
+    while (bytes > peak && !peak_bytes.compare_exchange_weak(peak, bytes)) {
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    allocated_bytes -= malloc_usable_size(p);
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+np::float_ elapsed_s(const timespec &start_time, const timespec &end_time) {
+    return static_cast<np::float_>(end_time.tv_sec - start_time.tv_sec) + static_cast<np::float_>(end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
+np::float_ max_rss_mb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<np::float_>(usage.ru_maxrss) / 1024.0;
+}
+
+const char *solver_name(linear_model::SolverType solver) {
+    switch (solver) {
+        case linear_model::SolverType::kAuto:
+            return "auto";
+        case linear_model::SolverType::kCholesky:
+            return "cholesky";
+        case linear_model::SolverType::kQr:
+            return "qr";
+        case linear_model::SolverType::kSvd:
+            return "svd";
+    }
+    return "";
+}
+
+int main(int argc, char **argv) {
+    const np::Size n_samples = argc > 1 ? std::stoul(argv[1]) : 10 * 1000 * 1000;
+    const np::Size n_features = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    std::mt19937 generator{1};
+    std::normal_distribution<np::float_> normal{0.0, 1.0};
+    std::vector<np::float_> coef(n_features);
+    for (auto &c: coef) {
+        c = normal(generator);
+    }
+    std::vector<np::float_> X(n_samples * n_features);
+    std::vector<np::float_> y(n_samples);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        y[i] = 1.0 + 0.1 * normal(generator);
+        for (np::Size j = 0; j < n_features; ++j) {
+            X[i * n_features + j] = normal(generator);
+            y[i] += coef[j] * X[i * n_features + j];
+        }
+    }
+    const auto X_view = utils::DenseMatrix<np::float_>::view(X.data(), n_samples, n_features);
+    const np::Array<np::float_> y_array{std::move(y), np::Shape{n_samples}};
+
+    std::cout << "n_samples " << n_samples << ", n_features " << n_features << ", X " << static_cast<np::float_>(X.size() * sizeof(np::float_)) / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "solver\tfit, [s]\tfit peak heap, [MB]\tmax RSS, [MB]\tmax |coef error|" << std::endl;
+    for (auto solver: {linear_model::SolverType::kCholesky, linear_model::SolverType::kQr, linear_model::SolverType::kSvd, linear_model::SolverType::kAuto}) {
+        linear_model::LinearRegression reg{{.solver = solver}};
+        const auto baseline = allocated_bytes.load();
+        peak_bytes = baseline;
+        timespec start_time{};
+        clock_gettime(CLOCK_MONOTONIC, &start_time);
+        reg.fit(X_view, y_array);
+        timespec end_time{};
+        clock_gettime(CLOCK_MONOTONIC, &end_time);
+        const auto fit_peak = peak_bytes.load() - baseline;
+
+        np::float_ error{0};
+        const auto fitted = reg.coef_();
+        for (np::Size j = 0; j < n_features; ++j) {
+            error = std::max(error, std::abs(fitted.get(j) - coef[j]));
+        }
+        std::cout << solver_name(solver) << (solver == linear_model::SolverType::kAuto ? std::string{" ("} + solver_name(reg.solver_()) + ")" : "") << "\t"
+                  << elapsed_s(start_time, end_time) << "\t" << static_cast<np::float_>(fit_peak) / (1024.0 * 1024.0) << "\t"
+                  << max_rss_mb() << "\t" << error << std::endl;
+    }
+
+    return 0;
+}
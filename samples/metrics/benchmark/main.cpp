@@ -0,0 +1,142 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceMetric.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+
+using namespace sklearn::metrics;
+
+// Counts heap allocations and measures the time of DistanceMetric::pairwise(X, Y) for growing inputs.
+// The number of allocations per call must not depend on the number of pairs.
+// For comparison, the "row views" line computes the Manhattan distances the way it was done before,
+// with sum(abs(X[i].subtract(Y[j]))) allocating temporary arrays for every pair.
+
+static std::atomic<std::size_t> allocations{0};
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+auto generate_data(np::Size n_samples, np::Size n_features, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<np::float_> distribution{-1.0, 1.0};
+    std::vector<np::float_> X(n_samples * n_features);
+    for (auto &x: X) {
+        x = distribution(generator);
+    }
+    return np::Array<np::float_>{std::move(X), np::Shape{n_samples, n_features}};
+}
+
+auto measure_time(auto func) {
+    timespec start_time{};
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    func();
+    timespec end_time{};
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    return 1000 * (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1000000;
+}
+
+const char *metric_name(DistanceMetricType metric) {
+    switch (metric) {
+        case DistanceMetricType::kEuclidean:
+            return "euclidean";
+        case DistanceMetricType::kManhattan:
+            return "manhattan";
+        case DistanceMetricType::kChebyshev:
+            return "chebyshev";
+        case DistanceMetricType::kMinkowski:
+            return "minkowski";
+    }
+    return "";
+}
+
+void print_result(const char *name, np::Size n_samples, np::Size n_features, std::size_t n_allocations, long time) {
+    std::cout << name << "\t" << n_samples << "\t" << n_features << "\t" << n_allocations << "\t" << time << std::endl;
+}
+
+void test_allocations(np::Size n_features = 16, const std::vector<np::Size> &sizes = {250, 500, 1000, 2000}, np::Size max_row_views_size = 500,
+                      const std::vector<DistanceMetricType> &metrics = {DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev, DistanceMetricType::kEuclidean, DistanceMetricType::kMinkowski}) {
+    auto headers = {"metric", "n_samples", "n_features", "allocations", "time, [ms]"};
+    for (const auto &header: headers) {
+        std::cout << header << "\t";
+    }
+    std::cout << std::endl;
+    for (auto metric: metrics) {
+        for (auto n_samples: sizes) {
+            auto X = generate_data(n_samples, n_features, 42);
+            auto Y = generate_data(n_samples, n_features, 43);
+            auto distance = DistanceMetric<np::Array<np::float_>>::get_metric(metric, 3);
+            np::Array<np::float_> result;
+            const std::size_t start = allocations;
+            auto time = measure_time([&]() { result = distance->pairwise(X, Y); });
+            print_result(metric_name(metric), n_samples, n_features, allocations - start, time);
+        }
+    }
+    for (auto n_samples: sizes) {
+        if (n_samples > max_row_views_size) {
+            break;
+        }
+        auto X = generate_data(n_samples, n_features, 42);
+        auto Y = generate_data(n_samples, n_features, 43);
+        np::Array<np::float_> result{np::Shape{n_samples, n_samples}};
+        const std::size_t start = allocations;
+        auto time = measure_time([&]() {
+            for (np::Size i = 0; i < n_samples; ++i) {
+                for (np::Size j = 0; j < n_samples; ++j) {
+                    result.set(i * n_samples + j, np::sum(np::abs(X[i].subtract(Y[j]))));
+                }
+            }
+        });
+        print_result("row views", n_samples, n_features, allocations - start, time);
+    }
+}
+
+int main(int, char **) {
+    // The level can be forced with the SKLEARN_CPU_LEVEL environment variable to compare the kernels of every level.
+    std::cout << "CPU level: " << sklearn::utils::cpu_level_name(sklearn::utils::cpu_level())
+              << " (detected: " << sklearn::utils::cpu_level_name(sklearn::utils::detected_cpu_level()) << ")" << std::endl;
+    test_allocations();
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <np/Comp.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+using namespace sklearn::neighbors;
+
+// Compares KNeighborsClassifier::predict timings of the available search algorithms on uniformly distributed data.
+
+auto generate_data(np::Size n_samples, np::Size n_features, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<np::float_> distribution{-1.0, 1.0};
+    std::vector<np::float_> X(n_samples * n_features);
+    std::vector<np::int_> y(n_samples);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        np::float_ sum{0};
+        for (np::Size j = 0; j < n_features; ++j) {
+            X[i * n_features + j] = distribution(generator);
+            sum += X[i * n_features + j];
+        }
+        y[i] = sum > 0 ? 1 : 0;
+    }
+    return std::make_pair(np::Array<np::float_>{std::move(X), np::Shape{n_samples, n_features}}, np::Array<np::int_>{std::move(y), np::Shape{n_samples}});
+}
+
+auto measure_time(auto func) {
+    timespec start_time{};
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    func();
+    timespec end_time{};
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    return 1000 * (end_time.tv_sec - start_time.tv_sec) + (end_time.tv_nsec - start_time.tv_nsec) / 1000000;
+}
+
+struct Result {
+    np::Size n_train;
+    np::Size n_features;
+    AlgorithmType algorithm;
+    long fit_time;
+    long predict_time;
+    bool equal;
+};
+
+const char *algorithm_name(AlgorithmType algorithm) {
+    switch (algorithm) {
+        case AlgorithmType::kAuto:
+            return "auto";
+        case AlgorithmType::kBallTree:
+            return "ball_tree";
+        case AlgorithmType::kKdTree:
+            return "kd_tree";
+        case AlgorithmType::kBruteForce:
+            return "brute";
+        case AlgorithmType::kHnsw:
+            return "hnsw";
+        case AlgorithmType::kIvfPq:
+            return "ivf_pq";
+    }
+    return "";
+}
+
+void test_time(np::Size n_test = 1000, np::Size n_neighbors = 5, const std::vector<np::Size> &train_sizes = {10 * 1000, 100 * 1000}, const std::vector<np::Size> &features = {8, 16, 64},
+               const std::vector<AlgorithmType> &algorithms = {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree, AlgorithmType::kAuto}) {
+    std::vector<Result> results;
+    for (auto n_train: train_sizes) {
+        for (auto n_features: features) {
+            auto [X_train, y_train] = generate_data(n_train, n_features, 42);
+            auto [X_test, y_test] = generate_data(n_test, n_features, 43);
+
+            np::Array<np::int_> reference;
+            for (auto algorithm: algorithms) {
+                auto kn = KNeighborsClassifier<np::float_, np::int_>{{.n_neighbors = n_neighbors, .algorithm = algorithm}};
+                auto fit_time = measure_time([&]() { kn.fit(X_train, y_train); });
+                np::Array<np::int_> y_pred;
+                auto predict_time = measure_time([&]() { y_pred = kn.predict(X_test); });
+                if (reference.empty()) {
+                    reference = y_pred;
+                }
+                results.push_back({n_train, n_features, algorithm, fit_time, predict_time, np::array_equal(reference, y_pred)});
+            }
+        }
+    }
+
+    auto headers = {"n_train", "n_features", "algorithm", "fit, [ms]", "predict, [ms]", "same prediction"};
+    for (const auto &header: headers) {
+        std::cout << header << "\t";
+    }
+    std::cout << std::endl;
+    for (const auto &result: results) {
+        std::cout << result.n_train << "\t" << result.n_features << "\t" << algorithm_name(result.algorithm) << "\t"
+                  << result.fit_time << "\t" << result.predict_time << "\t" << (result.equal ? "yes" : "no") << std::endl;
+    }
+}
+
+int main(int, char **) {
+    test_time();
+
+    return 0;
+}
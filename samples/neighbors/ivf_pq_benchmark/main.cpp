@@ -0,0 +1,128 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/neighbors/IvfPq.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+using namespace sklearn::neighbors;
+
+// Recall, latency and memory of the approximate IvfPq search against the exact brute force search,
+// without and with exact re-ranking of the best candidates.
+// The data are gaussian clusters, as real features usually are; uniform data is the worst case of every index.
+
+np::Array<np::float_> generate_data(np::Size n_samples, np::Size n_features, np::Size n_clusters, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::normal_distribution<np::float_> noise{0.0, 0.3};
+    std::uniform_real_distribution<np::float_> uniform{-1.0, 1.0};
+    // the same centers for the train and the test data
+    std::mt19937 center_generator{42};
+    std::vector<np::float_> centers(n_clusters * n_features);
+    for (auto &c: centers) {
+        c = uniform(center_generator);
+    }
+    std::uniform_int_distribution<np::Size> cluster{0, n_clusters - 1};
+    std::vector<np::float_> X(n_samples * n_features);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        const np::Size c = cluster(generator);
+        for (np::Size j = 0; j < n_features; ++j) {
+            X[i * n_features + j] = centers[c * n_features + j] + noise(generator);
+        }
+    }
+    return np::Array<np::float_>{std::move(X), np::Shape{n_samples, n_features}};
+}
+
+np::float_ elapsed_ms(const timespec &start_time, const timespec &end_time) {
+    return 1000.0 * static_cast<np::float_>(end_time.tv_sec - start_time.tv_sec) + static_cast<np::float_>(end_time.tv_nsec - start_time.tv_nsec) / 1e6;
+}
+
+auto measure_time(auto func) {
+    timespec start_time{};
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    func();
+    timespec end_time{};
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    return elapsed_ms(start_time, end_time);
+}
+
+void test_recall(np::Size n_train = 100 * 1000, np::Size n_features = 96, np::Size n_test = 1000, np::Size n_neighbors = 10,
+                 const std::vector<np::Size> &n_probes = {1, 2, 4, 8, 16, 32}, const std::vector<np::Size> &reranks = {0, 100}) {
+    auto X_train = generate_data(n_train, n_features, 100, 1);
+    auto X_test = generate_data(n_test, n_features, 100, 2);
+    const sklearn::utils::DenseMatrix<np::float_> queries{X_test};
+
+    KNeighborsClassifier<np::float_, np::int_> exact{{.n_neighbors = n_neighbors, .algorithm = AlgorithmType::kBruteForce}};
+    exact.fit(X_train, np::Array<np::int_>{std::vector<np::int_>(n_train), np::Shape{n_train}});
+    KNeighbors expected;
+    const auto brute_time = measure_time([&]() { expected = exact.kneighbors(X_test); });
+
+    std::cout << "n_train " << n_train << ", n_features " << n_features << ", k " << n_neighbors << std::endl;
+    std::cout << "brute force: " << brute_time / static_cast<np::float_>(n_test) << " ms/query, "
+              << n_features * sizeof(np::float_) << " bytes/sample" << std::endl;
+    const sklearn::utils::DenseMatrix<np::float_> train{X_train};
+    for (auto rerank: reranks) {
+        std::optional<IvfPq<np::float_>> index;
+        // a view keeps the original vectors for re-ranking without a copy
+        const auto build_time = measure_time([&]() { index.emplace(sklearn::utils::DenseMatrix<np::float_>::view(train.data(), n_train, n_features), IvfPqParameters{.n_lists = 256, .n_subquantizers = 16, .rerank = rerank}); });
+        std::cout << "ivf_pq rerank " << rerank << " build: " << build_time << " ms, "
+                  << static_cast<np::float_>(index->index_size()) / static_cast<np::float_>(n_train) << " bytes/sample" << std::endl;
+        std::cout << "n_probe\trecall\tmean, [ms]\tp99, [ms]" << std::endl;
+        for (auto n_probe: n_probes) {
+            index->set_n_probe(n_probe);
+            std::vector<np::float_> latencies(n_test);
+            std::vector<np::Size> found(n_test * n_neighbors);
+            for (np::Size i = 0; i < n_test; ++i) {
+                const auto query = sklearn::utils::DenseMatrix<np::float_>::view(queries.row(i), 1, n_features);
+                NeighborsHeap heap;
+                latencies[i] = measure_time([&]() { heap = index->query(query, n_neighbors); });
+                std::copy(heap.indices(0), heap.indices(0) + n_neighbors, found.begin() + static_cast<long>(i * n_neighbors));
+            }
+            np::Size hits = 0;
+            for (np::Size i = 0; i < n_test; ++i) {
+                for (np::Size n = 0; n < n_neighbors; ++n) {
+                    const auto *begin = found.data() + i * n_neighbors;
+                    hits += std::count(begin, begin + n_neighbors, expected.second.get(i * n_neighbors + n)) > 0;
+                }
+            }
+            np::float_ total{0};
+            for (auto latency: latencies) {
+                total += latency;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << n_probe << "\t" << static_cast<np::float_>(hits) / static_cast<np::float_>(n_test * n_neighbors) << "\t"
+                      << total / static_cast<np::float_>(n_test) << "\t" << latencies[n_test * 99 / 100] << std::endl;
+        }
+    }
+}
+
+int main(int, char **) {
+    test_recall();
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/linear_model/LinearRegression.hpp>
+#include <sklearn/linear_model/SGDRegressor.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+using namespace sklearn;
+
+// Latency of single-sample predictions, as an online service makes them: predict on a one-row array against the
+// allocation-free predict_into, for a single sample and for a batch written into a caller-provided buffer.
+// Every global operator new is counted, so the table shows the heap allocations of a call next to its time.
+
+static std::atomic<std::size_t> n_allocations{0};
+
+void *operator new(std::size_t size) {
+    ++n_allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+np::Array<np::float_> generate_data(np::Size n_samples, np::Size n_features, unsigned seed) {
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<np::float_> distribution{-1.0, 1.0};
+    std::vector<np::float_> X(n_samples * n_features);
+    for (auto &x: X) {
+        x = distribution(generator);
+    }
+    return np::Array<np::float_>{std::move(X), np::Shape{n_samples, n_features}};
+}
+
+np::float_ elapsed_ns(const timespec &start_time, const timespec &end_time) {
+    return 1e9 * static_cast<np::float_>(end_time.tv_sec - start_time.tv_sec) + static_cast<np::float_>(end_time.tv_nsec - start_time.tv_nsec);
+}
+
+// Runs predict(i) for the calls i in [0, n_calls), each predicting batch samples, and prints the mean time and the
+// allocations per prediction. A first untimed pass warms up the caches and the buffers the predictions keep.
+void measure(const std::string &name, np::Size n_calls, np::Size batch, auto predict) {
+    for (np::Size i = 0; i < n_calls; ++i) {
+        predict(i);
+    }
+    const std::size_t allocations = n_allocations;
+    timespec start_time{};
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    for (np::Size i = 0; i < n_calls; ++i) {
+        predict(i);
+    }
+    timespec end_time{};
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    const auto n = static_cast<np::float_>(n_calls * batch);
+    std::cout << name << "\t" << elapsed_ns(start_time, end_time) / n << "\t" << static_cast<np::float_>(n_allocations - allocations) / n << std::endl;
+}
+
+void test_linear_models(np::Size n_train = 10000, np::Size n_features = 16, np::Size n_test = 10000) {
+    const auto X_train = generate_data(n_train, n_features, 1);
+    const auto y = generate_data(n_train, 1, 2);
+    const np::Array<np::float_> y_train{std::vector<np::float_>(y.cbegin(), y.cend()), np::Shape{n_train}};
+    const auto X_test = generate_data(n_test, n_features, 3);
+    const std::vector<np::float_> x_test(X_test.cbegin(), X_test.cend());
+    std::vector<np::float_> out(n_test);
+
+    linear_model::LinearRegression ols{};
+    ols.fit(X_train, y_train);
+    linear_model::SGDRegressor<np::Array<np::float_>> sgd{};
+    sgd.fit(X_train, y_train);
+
+    std::cout << "n_features " << n_features << std::endl;
+    std::cout << "estimator\tns/prediction\tallocations/prediction" << std::endl;
+    measure("LinearRegression::predict, one-row array", n_test, 1, [&](np::Size i) {
+        out[i] = ols.predict(np::Array<np::float_>{std::vector<np::float_>(x_test.cbegin() + static_cast<long>(i * n_features), x_test.cbegin() + static_cast<long>((i + 1) * n_features)), np::Shape{1, n_features}}).get(0);
+    });
+    measure("LinearRegression::predict_into, one row", n_test, 1, [&](np::Size i) { ols.predict_into(x_test.data() + i * n_features, n_features, &out[i]); });
+    measure("LinearRegression::predict_into, batch", 1, n_test, [&](np::Size) { ols.predict_into(x_test.data(), n_test, n_features, out.data()); });
+    measure("SGDRegressor::predict_into, one row", n_test, 1, [&](np::Size i) { sgd.predict_into(x_test.data() + i * n_features, n_features, &out[i]); });
+}
+
+void test_neighbors(np::Size n_train = 10000, np::Size n_features = 8, np::Size n_test = 1000) {
+    using namespace sklearn::neighbors;
+    const auto X_train = generate_data(n_train, n_features, 4);
+    std::vector<np::int_> labels(n_train);
+    for (np::Size i = 0; i < n_train; ++i) {
+        labels[i] = static_cast<np::int_>(i % 3);
+    }
+    const np::Array<np::int_> y_train{labels, np::Shape{n_train}};
+    const auto X_test = generate_data(n_test, n_features, 5);
+    const std::vector<np::float_> x_test(X_test.cbegin(), X_test.cend());
+    std::vector<np::int_> out(n_test);
+
+    std::cout << "n_train " << n_train << ", n_features " << n_features << ", k 5" << std::endl;
+    std::cout << "estimator\tns/prediction\tallocations/prediction" << std::endl;
+    for (auto [algorithm, name]: {std::pair{AlgorithmType::kBruteForce, "brute"}, std::pair{AlgorithmType::kKdTree, "kd_tree"}, std::pair{AlgorithmType::kHnsw, "hnsw"}}) {
+        KNeighborsClassifier<np::float_, np::int_> clf{{.n_neighbors = 5, .algorithm = algorithm}};
+        clf.fit(X_train, y_train);
+        const std::string prefix = std::string{"KNeighborsClassifier "} + name;
+        measure(prefix + "::predict, one-row array", n_test, 1, [&](np::Size i) {
+            out[i] = clf.predict(np::Array<np::float_>{std::vector<np::float_>(x_test.cbegin() + static_cast<long>(i * n_features), x_test.cbegin() + static_cast<long>((i + 1) * n_features)), np::Shape{1, n_features}}).get(0);
+        });
+        measure(prefix + "::predict_into, one row", n_test, 1, [&](np::Size i) { clf.predict_into(x_test.data() + i * n_features, n_features, &out[i]); });
+        measure(prefix + "::predict_into, batch", 1, n_test, [&](np::Size) { clf.predict_into(x_test.data(), n_test, n_features, out.data()); });
+    }
+}
+
+int main(int, char **) {
+    test_linear_models();
+    test_neighbors();
+
+    return 0;
+}
@@ -38,10 +38,18 @@ function create_package() {
         include/sklearn/metrics
         include/sklearn/model_selection
         include/sklearn/neighbors
+        include/sklearn/utils
         samples
+        samples/linear_regression_benchmark
+        samples/metrics
+        samples/metrics/benchmark
         samples/neighbors
+        samples/neighbors/benchmark
         samples/neighbors/diabetes
+        samples/neighbors/hnsw_benchmark
         samples/neighbors/iris
+        samples/neighbors/ivf_pq_benchmark
+        samples/predict_latency
         scripts
         src
         src/datasets
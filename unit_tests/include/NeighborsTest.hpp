@@ -0,0 +1,163 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <np/Array.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+
+#include <SklearnTest.hpp>
+
+// Helpers shared by the nearest neighbors tests: random data and exhaustive search references.
+class NeighborsTest : public SklearnTest {
+protected:
+    static np::Array<np::float_> randomArray(np::Size rows, np::Size cols, unsigned seed) {
+        std::mt19937 generator{seed};
+        std::uniform_real_distribution<np::float_> distribution{-1.0, 1.0};
+        std::vector<np::float_> v(rows * cols);
+        for (auto &element: v) {
+            element = distribution(generator);
+        }
+        return np::Array<np::float_>{std::move(v), np::Shape{rows, cols}};
+    }
+
+    // All (distance, index) pairs of X for the row i of Y, sorted by increasing distance.
+    static std::vector<std::pair<np::float_, np::Size>> exhaustiveSearch(const np::Array<np::float_> &X, const np::Array<np::float_> &Y, np::Size i, const sklearn::metrics::DistanceKernel &kernel) {
+        const np::Size n_features = X.shape()[1];
+        std::vector<std::pair<np::float_, np::Size>> result;
+        for (np::Size j = 0; j < X.shape()[0]; ++j) {
+            np::float_ rdist{0};
+            for (np::Size f = 0; f < n_features; ++f) {
+                rdist = kernel.accumulate(rdist, X.get(j * n_features + f) - Y.get(i * n_features + f));
+            }
+            result.emplace_back(kernel.rdist_to_dist(rdist), j);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Checks k-nearest query results of a tree against an exhaustive search.
+    template<typename Tree>
+    static void checkQuery(const Tree &tree, const np::Array<np::float_> &X, const np::Array<np::float_> &Y, np::Size k, const sklearn::metrics::DistanceKernel &kernel) {
+        auto [distances, indices] = tree.query(Y, k);
+        checkArrayShape(distances, np::Shape{Y.shape()[0], k});
+        checkArrayShape(indices, np::Shape{Y.shape()[0], k});
+        for (np::Size i = 0; i < Y.shape()[0]; ++i) {
+            auto expected = exhaustiveSearch(X, Y, i, kernel);
+            for (np::Size n = 0; n < k; ++n) {
+                EXPECT_NEAR(distances.get(i * k + n), expected[n].first, 1e-12);
+                EXPECT_EQ(indices.get(i * k + n), expected[n].second);
+            }
+        }
+    }
+
+    // The share of the exact k nearest neighbors found by an approximate index.
+    template<typename Index>
+    static np::float_ recall(const Index &index, const np::Array<np::float_> &X, const np::Array<np::float_> &Y, np::Size k) {
+        auto [distances, indices] = index.query(Y, k);
+        const np::Size n_queries = Y.shape()[0];
+        np::Size found = 0;
+        for (np::Size i = 0; i < n_queries; ++i) {
+            const auto expected = exhaustiveSearch(X, Y, i, index.kernel());
+            for (np::Size n = 0; n < k; ++n) {
+                for (np::Size m = 0; m < k; ++m) {
+                    found += indices.get(i * k + m) == expected[n].second;
+                }
+            }
+        }
+        return static_cast<np::float_>(found) / static_cast<np::float_>(n_queries * k);
+    }
+
+    // Checks that an approximate index answers the same on several threads as on one, and that an index built the
+    // same way from the same data, which only depends on the seed, answers the same.
+    template<typename Index>
+    static void checkJobs(const Index &index, const Index &rebuilt, const np::Array<np::float_> &Y, np::Size k) {
+        const auto queries = sklearn::utils::DenseMatrix<np::float_>{Y};
+        const auto expected = index.query(queries, k);
+        for (int n_jobs: {2, 3, -1}) {
+            const auto heap = index.query(queries, k, n_jobs);
+            EXPECT_EQ(heap.indices(), expected.indices());
+            EXPECT_EQ(heap.distances(), expected.distances());
+        }
+        EXPECT_EQ(rebuilt.query(queries, k).indices(), expected.indices());
+    }
+
+    // Checks that a classifier on an approximate algorithm predicts almost as the brute force search on random
+    // samples labeled by the sign of their first feature, and that the algorithm refuses radius queries.
+    static void checkApproximateClassifier(const sklearn::neighbors::KNeighborsClassifierParameters &parameters, unsigned seed) {
+        using namespace sklearn::neighbors;
+        auto X = randomArray(2000, 8, seed);
+        auto Y = randomArray(200, 8, seed + 1);
+        std::vector<np::int_> labels(2000);
+        for (np::Size i = 0; i < labels.size(); ++i) {
+            labels[i] = X.get(i * 8) > 0 ? 1 : 0;
+        }
+        np::Array<np::int_> y{labels, np::Shape{labels.size()}};
+
+        KNeighborsClassifier<np::float_, np::int_> exact{{.n_neighbors = parameters.n_neighbors, .algorithm = AlgorithmType::kBruteForce}};
+        exact.fit(X, y);
+        KNeighborsClassifier<np::float_, np::int_> approximate{parameters};
+        approximate.fit(X, y);
+        EXPECT_EQ(approximate.fit_method_(), parameters.algorithm);
+
+        const auto expected = exact.predict(Y);
+        const auto pred = approximate.predict(Y);
+        np::Size same = 0;
+        for (np::Size i = 0; i < expected.size(); ++i) {
+            same += expected.get(i) == pred.get(i);
+        }
+        EXPECT_GE(same, 196);
+        // only the exact algorithms answer radius queries
+        const auto algorithm = get_algorithm(parameters.algorithm, sklearn::utils::DenseMatrix<np::float_>{X}, parameters.leaf_size, parameters.metric, parameters.p, parameters.hnsw, parameters.ivf_pq);
+        EXPECT_THROW(algorithm->query_radius(sklearn::utils::DenseMatrix<np::float_>{Y}, 0.5, false), std::runtime_error);
+    }
+
+    // Checks sorted radius query results of a tree against an exhaustive search.
+    template<typename Tree>
+    static void checkQueryRadius(const Tree &tree, const np::Array<np::float_> &X, const np::Array<np::float_> &Y, np::float_ r, const sklearn::metrics::DistanceKernel &kernel) {
+        auto result = tree.query_radius(Y, r, true);
+        checkArrayShape(result.offsets, np::Shape{Y.shape()[0] + 1});
+        for (np::Size i = 0; i < Y.shape()[0]; ++i) {
+            auto expected = exhaustiveSearch(X, Y, i, kernel);
+            np::Size count = 0;
+            while (count < expected.size() && expected[count].first <= r) {
+                ++count;
+            }
+            const auto begin = result.offsets.get(i);
+            ASSERT_EQ(result.offsets.get(i + 1) - begin, count);
+            for (np::Size n = 0; n < count; ++n) {
+                EXPECT_NEAR(result.distances.get(begin + n), expected[n].first, 1e-12);
+                EXPECT_EQ(result.indices.get(begin + n), expected[n].second);
+            }
+        }
+    }
+};
@@ -0,0 +1,83 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/neighbors/Algorithm.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+#include <NeighborsTest.hpp>
+
+using namespace sklearn::metrics;
+using namespace sklearn::neighbors;
+
+class AlgorithmTest : public NeighborsTest {
+protected:
+};
+
+TEST_F(AlgorithmTest, selectAlgorithmTest) {
+    // small data sets and large k: brute force
+    EXPECT_EQ(select_algorithm(100, 4, 5, DistanceMetricType::kEuclidean), AlgorithmType::kBruteForce);
+    EXPECT_EQ(select_algorithm(5000, 4, 2500, DistanceMetricType::kEuclidean), AlgorithmType::kBruteForce);
+    // low dimension: KdTree
+    EXPECT_EQ(select_algorithm(5000, 4, 5, DistanceMetricType::kEuclidean), AlgorithmType::kKdTree);
+    EXPECT_EQ(select_algorithm(2000000, 16 - 1, 5, DistanceMetricType::kChebyshev), AlgorithmType::kKdTree);
+    // high dimension: BallTree for large data sets only
+    EXPECT_EQ(select_algorithm(5000, 64, 5, DistanceMetricType::kEuclidean), AlgorithmType::kBruteForce);
+    EXPECT_EQ(select_algorithm(2000000, 64, 5, DistanceMetricType::kEuclidean), AlgorithmType::kBallTree);
+    EXPECT_EQ(select_algorithm(2000000, 1024, 5, DistanceMetricType::kEuclidean), AlgorithmType::kBruteForce);
+    // expensive metrics favour trees
+    EXPECT_EQ(select_algorithm(500, 4, 5, DistanceMetricType::kMinkowski, 3), AlgorithmType::kKdTree);
+    EXPECT_EQ(select_algorithm(500, 4, 5, DistanceMetricType::kMinkowski, 2), AlgorithmType::kBruteForce);
+    EXPECT_EQ(select_algorithm(5000, 64, 5, DistanceMetricType::kMinkowski, 3), AlgorithmType::kBallTree);
+}
+
+TEST_F(AlgorithmTest, getAlgorithmTest) {
+    sklearn::utils::DenseMatrix<np::float_> X{randomArray(100, 3, 1)};
+    EXPECT_EQ(get_algorithm(AlgorithmType::kBruteForce, X)->type(), AlgorithmType::kBruteForce);
+    EXPECT_EQ(get_algorithm(AlgorithmType::kKdTree, X)->type(), AlgorithmType::kKdTree);
+    EXPECT_EQ(get_algorithm(AlgorithmType::kBallTree, X)->type(), AlgorithmType::kBallTree);
+    EXPECT_EQ(get_algorithm(AlgorithmType::kAuto, X)->type(), AlgorithmType::kBruteForce);
+
+    auto algorithm = get_algorithm(AlgorithmType::kBallTree, X, 5, DistanceMetricType::kManhattan);
+    auto neighbors = algorithm->query(X, 1);
+    for (np::Size i = 0; i < X.rows(); ++i) {
+        EXPECT_EQ(neighbors.indices(i)[0], i);
+        EXPECT_EQ(neighbors.distances(i)[0], 0.0);
+    }
+}
+
+TEST_F(AlgorithmTest, kNeighborsClassifierAutoTest) {
+    auto X = randomArray(5000, 4, 2);
+    np::Array<np::int_> y{std::vector<np::int_>(5000, 1), np::Shape{5000}};
+
+    auto kn = KNeighborsClassifier<np::float_, np::int_>{};
+    kn.fit(X, y);
+    EXPECT_EQ(kn.fit_method_(), AlgorithmType::kKdTree);
+    compare(kn.predict(X), y);
+
+    kn.fit(randomArray(100, 4, 3), np::Array<np::int_>{std::vector<np::int_>(100, 1), np::Shape{100}});
+    EXPECT_EQ(kn.fit_method_(), AlgorithmType::kBruteForce);
+}
@@ -0,0 +1,151 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/PairwiseDistancesReduction.hpp>
+#include <sklearn/neighbors/BruteForce.hpp>
+#include <sklearn/utils/DenseMatrix.hpp>
+
+#include <NeighborsTest.hpp>
+
+using namespace sklearn::metrics;
+using namespace sklearn::neighbors;
+using sklearn::utils::DenseMatrix;
+
+class BruteForceTest : public NeighborsTest {
+};
+
+TEST_F(BruteForceTest, pairwiseDistancesReductionTilesTest) {
+    DenseMatrix<np::float_> X{randomArray(50, 3, 1)};
+    DenseMatrix<np::float_> Y{randomArray(37, 3, 2)};
+    DistanceKernel kernel{DistanceMetricType::kManhattan};
+    for (np::Size chunk_size: {1, 7, 50, 256}) {
+        std::vector<np::float_> distances(X.rows() * Y.rows(), -1.0);
+        np::Size last_x_start = 0;
+        pairwise_distances_reduction(
+                X, Y, kernel,
+                [&](np::Size x_start, np::Size x_end, np::Size y_start, np::Size y_end, const np::float_ *tile) {
+                    EXPECT_LE(x_end - x_start, chunk_size);
+                    EXPECT_LE(y_end - y_start, chunk_size);
+                    EXPECT_GE(x_start, last_x_start);
+                    last_x_start = x_start;
+                    for (np::Size i = x_start; i < x_end; ++i) {
+                        for (np::Size j = y_start; j < y_end; ++j, ++tile) {
+                            EXPECT_EQ(distances[i * Y.rows() + j], -1.0);
+                            distances[i * Y.rows() + j] = *tile;
+                        }
+                    }
+                },
+                chunk_size);
+        for (np::Size i = 0; i < X.rows(); ++i) {
+            for (np::Size j = 0; j < Y.rows(); ++j) {
+                EXPECT_EQ(distances[i * Y.rows() + j], kernel.rdist(X.row(i), Y.row(j), X.cols()));
+            }
+        }
+    }
+}
+
+TEST_F(BruteForceTest, queryTest) {
+    auto X = randomArray(300, 4, 3);
+    auto Y = randomArray(40, 4, 4);
+    for (auto metric: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev}) {
+        DistanceKernel kernel{metric};
+        for (np::Size chunk_size: {1, 16, 256}) {
+            for (int n_jobs: {1, 3}) {
+                auto heap = brute_force_query(DenseMatrix<np::float_>{Y}, DenseMatrix<np::float_>{X}, kernel, 5, chunk_size, n_jobs);
+                for (np::Size i = 0; i < Y.shape()[0]; ++i) {
+                    auto expected = exhaustiveSearch(X, Y, i, kernel);
+                    for (np::Size n = 0; n < 5; ++n) {
+                        EXPECT_NEAR(kernel.rdist_to_dist(heap.distances(i)[n]), expected[n].first, 1e-12);
+                        EXPECT_EQ(heap.indices(i)[n], expected[n].second);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(BruteForceTest, queryRadiusTest) {
+    auto X = randomArray(300, 2, 5);
+    auto Y = randomArray(40, 2, 6);
+    DistanceKernel kernel{DistanceMetricType::kMinkowski, 3};
+    for (np::Size chunk_size: {1, 16, 256}) {
+        for (int n_jobs: {1, 3}) {
+            auto result = brute_force_query_radius(DenseMatrix<np::float_>{Y}, DenseMatrix<np::float_>{X}, kernel, 0.3, true, chunk_size, n_jobs);
+            checkArrayShape(result.offsets, np::Shape{Y.shape()[0] + 1});
+            for (np::Size i = 0; i < Y.shape()[0]; ++i) {
+                auto expected = exhaustiveSearch(X, Y, i, kernel);
+                np::Size count = 0;
+                while (count < expected.size() && expected[count].first <= 0.3) {
+                    ++count;
+                }
+                const auto begin = result.offsets.get(i);
+                ASSERT_EQ(result.offsets.get(i + 1) - begin, count);
+                for (np::Size n = 0; n < count; ++n) {
+                    EXPECT_NEAR(result.distances.get(begin + n), expected[n].first, 1e-12);
+                    EXPECT_EQ(result.indices.get(begin + n), expected[n].second);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(BruteForceTest, float32QueryTest) {
+    // float32 data, rounded once so that the float64 reference sees the same samples
+    auto X = randomArray(300, 4, 9);
+    auto Y = randomArray(40, 4, 10);
+    const std::vector<float> x(X.cbegin(), X.cend());
+    const std::vector<float> y(Y.cbegin(), Y.cend());
+    X = np::Array<np::float_>{std::vector<np::float_>(x.cbegin(), x.cend()), X.shape()};
+    Y = np::Array<np::float_>{std::vector<np::float_>(y.cbegin(), y.cend()), Y.shape()};
+    const DenseMatrix<float> X32{np::Array<float>{x, X.shape()}};
+    const DenseMatrix<float> Y32{np::Array<float>{y, Y.shape()}};
+    for (auto metric: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kMinkowski}) {
+        for (auto accumulation: {sklearn::utils::Accumulation::kFloat64, sklearn::utils::Accumulation::kFloat32}) {
+            DistanceKernel kernel{metric, 3, accumulation};
+            auto heap = brute_force_query(Y32, X32, kernel, 5, 16, 3);
+            for (np::Size i = 0; i < Y.shape()[0]; ++i) {
+                auto expected = exhaustiveSearch(X, Y, i, kernel);
+                for (np::Size n = 0; n < 5; ++n) {
+                    EXPECT_NEAR(kernel.rdist_to_dist(heap.distances(i)[n]), expected[n].first, 1e-5);
+                    EXPECT_EQ(heap.indices(i)[n], expected[n].second);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(BruteForceTest, invalidParametersTest) {
+    DenseMatrix<np::float_> X{randomArray(10, 2, 7)};
+    DenseMatrix<np::float_> Y{randomArray(10, 3, 8)};
+    DistanceKernel kernel;
+    EXPECT_THROW(brute_force_query(X, X, kernel, 0), std::runtime_error);
+    EXPECT_THROW(brute_force_query(X, X, kernel, 11), std::runtime_error);
+    EXPECT_THROW(brute_force_query(X, Y, kernel, 1), std::runtime_error);
+    EXPECT_THROW(brute_force_query(X, X, kernel, 1, 0), std::runtime_error);
+    EXPECT_THROW(brute_force_query_radius(X, X, kernel, -1.0), std::runtime_error);
+}
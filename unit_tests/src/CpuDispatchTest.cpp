@@ -0,0 +1,109 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <np/Comp.hpp>
+
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
+#include <sklearn/utils/CpuDispatch.hpp>
+#include <sklearn/utils/extmath.hpp>
+
+#include <SklearnTest.hpp>
+
+using namespace sklearn::utils;
+
+class CpuDispatchTest : public SklearnTest {
+protected:
+    static DenseMatrix<np::float_> generate(np::Size rows, np::Size cols, np::Size seed) {
+        DenseMatrix<np::float_> X{rows, cols};
+        for (np::Size i = 0; i < rows * cols; ++i) {
+            X.data()[i] = static_cast<np::float_>((i * seed) % 101) / 13.0 - 4.0;
+        }
+        return X;
+    }
+
+    static std::vector<CpuLevel> supportedLevels() {
+        std::vector<CpuLevel> levels;
+        for (auto level: {CpuLevel::kBaseline, CpuLevel::kAvx2, CpuLevel::kAvx512}) {
+            if (level <= detected_cpu_level()) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+};
+
+TEST_F(CpuDispatchTest, cpuLevelTest) {
+    EXPECT_STREQ(cpu_level_name(CpuLevel::kBaseline), "baseline");
+    EXPECT_STREQ(cpu_level_name(CpuLevel::kAvx2), "avx2");
+    EXPECT_STREQ(cpu_level_name(CpuLevel::kAvx512), "avx512");
+    EXPECT_LE(cpu_level(), detected_cpu_level());
+
+    const auto level = cpu_level();
+    set_cpu_level(CpuLevel::kBaseline);
+    EXPECT_EQ(cpu_level(), CpuLevel::kBaseline);
+    if (detected_cpu_level() < CpuLevel::kAvx512) {
+        EXPECT_THROW(set_cpu_level(CpuLevel::kAvx512), std::runtime_error);
+        EXPECT_EQ(cpu_level(), CpuLevel::kBaseline);
+    }
+    set_cpu_level(level);
+    EXPECT_EQ(cpu_level(), level);
+}
+
+TEST_F(CpuDispatchTest, kernelsOfAllLevelsTest) {
+    // Odd sizes exercise the remainders of the register tiles, more than 128 features the continued folds.
+    const auto X = generate(37, 131, 7919);
+    const auto Y = generate(29, 131, 104729);
+    const auto level = cpu_level();
+
+    set_cpu_level(CpuLevel::kBaseline);
+    const auto manhattan = sklearn::metrics::pairwise_rdist(sklearn::metrics::internal::ManhattanRdist{}, X, Y);
+    const auto chebyshev = sklearn::metrics::pairwise_rdist(sklearn::metrics::internal::ChebyshevRdist{}, X, Y);
+    std::vector<np::float_> dot(X.rows() * Y.rows());
+    dot_transposed(X.data(), X.cols(), Y.data(), Y.cols(), X.rows(), Y.rows(), X.cols(), dot.data(), Y.rows());
+    for (np::Size i = 0; i < X.rows(); ++i) {
+        for (np::Size j = 0; j < Y.rows(); ++j) {
+            np::float_ sum{0};
+            np::float_ product{0};
+            for (np::Size f = 0; f < X.cols(); ++f) {
+                sum += std::abs(X.row(i)[f] - Y.row(j)[f]);
+                product += X.row(i)[f] * Y.row(j)[f];
+            }
+            EXPECT_EQ(manhattan[i * Y.rows() + j], sum);
+            EXPECT_NEAR(dot[i * Y.rows() + j], product, 1e-9);
+        }
+    }
+
+    for (auto supported: supportedLevels()) {
+        set_cpu_level(supported);
+        EXPECT_EQ(sklearn::metrics::pairwise_rdist(sklearn::metrics::internal::ManhattanRdist{}, X, Y), manhattan);
+        EXPECT_EQ(sklearn::metrics::pairwise_rdist(sklearn::metrics::internal::ChebyshevRdist{}, X, Y), chebyshev);
+        std::vector<np::float_> result(X.rows() * Y.rows());
+        dot_transposed(X.data(), X.cols(), Y.data(), Y.cols(), X.rows(), Y.rows(), X.cols(), result.data(), Y.rows());
+        for (np::Size i = 0; i < result.size(); ++i) {
+            // Levels with FMA may round the products differently.
+            EXPECT_NEAR(result[i], dot[i], 1e-9);
+        }
+    }
+    set_cpu_level(level);
+}
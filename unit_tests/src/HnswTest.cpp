@@ -0,0 +1,91 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/neighbors/Hnsw.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+#include <NeighborsTest.hpp>
+
+using namespace sklearn::metrics;
+using namespace sklearn::neighbors;
+
+class HnswTest : public NeighborsTest {
+protected:
+};
+
+TEST_F(HnswTest, exactOnSmallDataTest) {
+    // with ef above the number of samples the search visits every reachable node, so it is exact
+    auto X = randomArray(200, 4, 1);
+    auto Y = randomArray(20, 4, 2);
+    for (auto [metric, p]: {std::pair{DistanceMetricType::kEuclidean, 2.}, std::pair{DistanceMetricType::kManhattan, 1.},
+                            std::pair{DistanceMetricType::kChebyshev, 2.}, std::pair{DistanceMetricType::kMinkowski, 3.}}) {
+        Hnsw<np::float_> index{X, {.M = 8, .ef_construction = 100, .ef = 400}, metric, p};
+        checkQuery(index, X, Y, 5, index.kernel());
+    }
+}
+
+TEST_F(HnswTest, recallTest) {
+    auto X = randomArray(3000, 16, 3);
+    auto Y = randomArray(100, 16, 4);
+    Hnsw<np::float_> index{X};
+    EXPECT_GE(recall(index, X, Y, 10), 0.9);
+    // a longer candidate list can only help
+    index.set_ef(200);
+    EXPECT_GE(recall(index, X, Y, 10), 0.98);
+    EXPECT_THROW(index.query(Y, 3001), std::runtime_error);
+    EXPECT_THROW(index.query(randomArray(1, 3, 5), 1), std::runtime_error);
+}
+
+TEST_F(HnswTest, unreachableNodesTest) {
+    // with M = 2 and a short candidate list the pruned one-way links orphan nodes of this graph, the query still
+    // returns all the samples, nearest first
+    auto X = randomArray(60, 2, 0);
+    Hnsw<np::float_> index{X, {.M = 2, .ef_construction = 2, .ef = 1}};
+    checkQuery(index, X, X, 60, index.kernel());
+}
+
+TEST_F(HnswTest, addTest) {
+    auto X = randomArray(2000, 8, 6);
+    auto Y = randomArray(100, 8, 7);
+    std::vector<np::float_> first(X.cbegin(), X.cbegin() + 1000 * 8);
+    std::vector<np::float_> second(X.cbegin() + 1000 * 8, X.cend());
+
+    Hnsw<np::float_> index{np::Array<np::float_>{first, np::Shape{1000, 8}}};
+    index.add(sklearn::utils::DenseMatrix<np::float_>{np::Array<np::float_>{second, np::Shape{1000, 8}}});
+    EXPECT_EQ(index.n_samples(), 2000);
+    // the added points are found with the indices following the initial ones
+    EXPECT_GE(recall(index, X, Y, 5), 0.95);
+}
+
+TEST_F(HnswTest, nJobsTest) {
+    // the graph only depends on the seed and the insertion order
+    auto X = randomArray(2000, 8, 8);
+    checkJobs(Hnsw<np::float_>{X, {.M = 8}}, Hnsw<np::float_>{X, {.M = 8}}, randomArray(300, 8, 9), 5);
+}
+
+TEST_F(HnswTest, classifierTest) {
+    checkApproximateClassifier({.n_neighbors = 5, .algorithm = AlgorithmType::kHnsw, .hnsw = {.ef = 100}}, 10);
+}
@@ -0,0 +1,101 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/neighbors/IvfPq.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+
+#include <NeighborsTest.hpp>
+
+using namespace sklearn::metrics;
+using namespace sklearn::neighbors;
+
+class IvfPqTest : public NeighborsTest {
+protected:
+};
+
+TEST_F(IvfPqTest, exactWithFullRerankTest) {
+    // probing every list and re-ranking every sample is an exhaustive search
+    auto X = randomArray(300, 4, 1);
+    auto Y = randomArray(20, 4, 2);
+    for (auto [metric, p]: {std::pair{DistanceMetricType::kEuclidean, 2.}, std::pair{DistanceMetricType::kManhattan, 1.},
+                            std::pair{DistanceMetricType::kChebyshev, 2.}, std::pair{DistanceMetricType::kMinkowski, 3.}}) {
+        IvfPq<np::float_> index{X, {.n_lists = 8, .n_subquantizers = 2, .n_probe = 8, .rerank = 300}, metric, p};
+        checkQuery(index, X, Y, 5, index.kernel());
+    }
+}
+
+TEST_F(IvfPqTest, recallTest) {
+    auto X = randomArray(3000, 16, 3);
+    auto Y = randomArray(100, 16, 4);
+    IvfPq<np::float_> compressed{X, {.n_lists = 32, .n_probe = 8}};
+    EXPECT_GE(recall(compressed, X, Y, 10), 0.75);
+    // more lists can only help, the codes still lose some neighbors
+    compressed.set_n_probe(16);
+    EXPECT_GE(recall(compressed, X, Y, 10), 0.85);
+
+    // exact distances on the best candidates recover them
+    IvfPq<np::float_> reranked{X, {.n_lists = 32, .n_probe = 16, .rerank = 50}};
+    EXPECT_GE(recall(reranked, X, Y, 10), 0.95);
+    reranked.set_n_probe(32);
+    EXPECT_GE(recall(reranked, X, Y, 10), 0.99);
+    EXPECT_THROW(reranked.query(Y, 3001), std::runtime_error);
+    EXPECT_THROW(reranked.query(randomArray(1, 8, 5), 1), std::runtime_error);
+    EXPECT_THROW(reranked.set_n_probe(0), std::runtime_error);
+}
+
+TEST_F(IvfPqTest, indexSizeTest) {
+    auto X = randomArray(20000, 32, 6);
+    IvfPq<np::float_> index{X, {.n_lists = 64, .n_subquantizers = 8, .max_iter = 5, .max_train = 4000}};
+    // 8 bytes of code and a 4-byte id per sample, against 256 bytes of the original vector
+    const np::Size centroids = (64 * 32 + 256 * 32) * sizeof(np::float_);
+    EXPECT_LE(index.index_size(), 20000 * (8 + 4) + 65 * sizeof(np::Size) + centroids);
+    EXPECT_EQ(index.n_samples(), 20000);
+    EXPECT_EQ(index.n_features(), 32);
+}
+
+TEST_F(IvfPqTest, parametersTest) {
+    auto X = randomArray(100, 6, 7);
+    EXPECT_THROW((IvfPq<np::float_>{X, {.n_lists = 4, .n_subquantizers = 4}}), std::runtime_error);
+    EXPECT_THROW((IvfPq<np::float_>{X, {.n_lists = 101, .n_subquantizers = 3}}), std::runtime_error);
+    EXPECT_THROW((IvfPq<np::float_>{X, {.n_lists = 4, .n_subquantizers = 3, .n_probe = 0}}), std::runtime_error);
+    // lists are scanned past n_probe until k samples have been seen
+    IvfPq<np::float_> index{X, {.n_lists = 50, .n_subquantizers = 3, .n_probe = 1}};
+    auto [distances, indices] = index.query(randomArray(5, 6, 8), 20);
+    for (auto i = indices.cbegin(); i != indices.cend(); ++i) {
+        EXPECT_LT(*i, 100);
+    }
+}
+
+TEST_F(IvfPqTest, nJobsTest) {
+    // training only depends on the seed
+    auto X = randomArray(2000, 8, 9);
+    const IvfPqParameters parameters{.n_lists = 16, .n_subquantizers = 4, .rerank = 20};
+    checkJobs(IvfPq<np::float_>{X, parameters}, IvfPq<np::float_>{X, parameters}, randomArray(300, 8, 10), 5);
+}
+
+TEST_F(IvfPqTest, classifierTest) {
+    checkApproximateClassifier({.n_neighbors = 5, .algorithm = AlgorithmType::kIvfPq, .ivf_pq = {.n_lists = 16, .n_subquantizers = 4, .rerank = 50}}, 11);
+}
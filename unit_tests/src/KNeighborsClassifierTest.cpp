@@ -125,3 +125,230 @@ TEST_F(KNeighborsClassifierTest, diabetesTest) {
     auto score = accuracy_score(y_test, y_pred);
     EXPECT_GE(score, 0.6558441558441559);
 }
+
+TEST_F(KNeighborsClassifierTest, nJobsTest) {
+    using namespace sklearn::neighbors;
+
+    const np::Size n_samples = 600;
+    const np::Size n_features = 4;
+    std::vector<np::float_> x(n_samples * n_features);
+    std::vector<np::int_> y(n_samples);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>((i * 7919) % 1009) / 100.0;
+    }
+    for (np::Size i = 0; i < n_samples; ++i) {
+        y[i] = static_cast<np::int_>(x[i * n_features] + x[i * n_features + 1]) % 3;
+    }
+    np::Array<np::float_> X{x, np::Shape{n_samples, n_features}};
+    np::Array<np::int_> Y{y, np::Shape{n_samples}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        KNeighborsClassifier<np::float_, np::int_> serial{{.n_neighbors = 7, .algorithm = algorithm}};
+        serial.fit(X, Y);
+        const auto expected = serial.predict(X);
+        for (int n_jobs: {2, 3, -1}) {
+            KNeighborsClassifier<np::float_, np::int_> parallel{{.n_neighbors = 7, .algorithm = algorithm, .n_jobs = n_jobs}};
+            parallel.fit(X, Y);
+            EXPECT_TRUE(np::array_equal(parallel.predict(X), expected));
+        }
+    }
+
+    // bool labels, which std::vector<bool> would pack into shared bits, written by neighbouring samples in parallel
+    std::vector<bool> flags(n_samples);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        flags[i] = y[i] == 1;
+    }
+    np::Array<bool> F{flags, np::Shape{n_samples}};
+    KNeighborsClassifier<np::float_, bool> serial{{.n_neighbors = 7}};
+    serial.fit(X, F);
+    const auto expected = serial.predict(X);
+    KNeighborsClassifier<np::float_, bool> parallel{{.n_neighbors = 7, .n_jobs = -1}};
+    parallel.fit(X, F);
+    const auto pred = parallel.predict(X);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        EXPECT_EQ(pred.get(i), expected.get(i));
+    }
+    EXPECT_THROW(KNeighborsClassifier<np::float_>{{.n_jobs = 0}}, std::runtime_error);
+}
+
+TEST_F(KNeighborsClassifierTest, weightsTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    // the neighbors of 0.9 are 1 (class 3, distance 0.1), 0 and 2 (class 7, distances 0.9 and 1.1)
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 2.}, np::Shape{2, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree}) {
+        KNeighborsClassifier<np::float_, np::int_> uniform{{.n_neighbors = 3, .algorithm = algorithm}};
+        uniform.fit(X, y);
+        EXPECT_TRUE(np::array_equal(uniform.predict(X_test), np::Array<np::int_>{7, 7}));
+        EXPECT_TRUE(np::array_equal(uniform.classes_(), np::Array<np::int_>{3, 7}));
+
+        // 1 / 0.1 outweighs 1 / 0.9 + 1 / 1.1, an exact match takes it all
+        KNeighborsClassifier<np::float_, np::int_> distance{{.n_neighbors = 3, .weights = WeightsType::kDistance, .algorithm = algorithm}};
+        distance.fit(X, y);
+        EXPECT_TRUE(np::array_equal(distance.predict(X_test), np::Array<np::int_>{3, 7}));
+
+        KNeighborsClassifier<np::float_, np::int_> callable{{.n_neighbors = 3,
+                                                             .weights = WeightsType::kCallable,
+                                                             .algorithm = algorithm,
+                                                             .weights_callable = [](np::float_ d) { return d < 0.5 ? 0.0 : 1.0; }}};
+        callable.fit(X, y);
+        EXPECT_TRUE(np::array_equal(callable.predict(X_test), np::Array<np::int_>{7, 3}));
+
+        // a tie between the classes goes to the smallest label
+        KNeighborsClassifier<np::float_, np::int_> tie{{.n_neighbors = 2, .algorithm = algorithm}};
+        tie.fit(X, y);
+        EXPECT_TRUE(np::array_equal(tie.predict(X_test), np::Array<np::int_>{3, 3}));
+    }
+    EXPECT_THROW(KNeighborsClassifier<np::float_>{{.weights = WeightsType::kCallable}}, std::runtime_error);
+}
+
+TEST_F(KNeighborsClassifierTest, kneighborsPredictProbaTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 2.}, np::Shape{2, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        KNeighborsClassifier<np::float_, np::int_> uniform{{.n_neighbors = 3, .algorithm = algorithm}};
+        uniform.fit(X, y);
+
+        auto [distances, indices] = uniform.kneighbors(X_test);
+        EXPECT_TRUE(np::array_equal(indices, np::Array<np::Size>{std::vector<np::Size>{1, 0, 2, 2, 1, 0}, np::Shape{2, 3}}));
+        checkArrayShape(distances, np::Shape{2, 3});
+        const np::float_ expected_distances[] = {0.1, 0.9, 1.1, 0., 1., 2.};
+        for (np::Size i = 0; i < 6; ++i) {
+            EXPECT_NEAR(distances.get(i), expected_distances[i], 1e-12);
+        }
+        auto [no_distances, nearest] = uniform.kneighbors(X_test, 1, false);
+        EXPECT_EQ(no_distances.size(), 0);
+        EXPECT_TRUE(np::array_equal(nearest, np::Array<np::Size>{std::vector<np::Size>{1, 2}, np::Shape{2, 1}}));
+
+        // classes 3 and 7
+        auto proba = uniform.predict_proba(X_test);
+        checkArrayShape(proba, np::Shape{2, 2});
+        const np::float_ expected_uniform[] = {1. / 3, 2. / 3, 1. / 3, 2. / 3};
+        for (np::Size i = 0; i < 4; ++i) {
+            EXPECT_NEAR(proba.get(i), expected_uniform[i], 1e-12);
+        }
+        EXPECT_TRUE(np::array_equal(uniform.predict_proba(uniform.kneighbors(X_test, std::nullopt, false)), proba));
+
+        KNeighborsClassifier<np::float_, np::int_> distance{{.n_neighbors = 3, .weights = WeightsType::kDistance, .algorithm = algorithm}};
+        distance.fit(X, y);
+        proba = distance.predict_proba(X_test);
+        const np::float_ weight_3 = 1 / 0.1;
+        const np::float_ weight_7 = 1 / 0.9 + 1 / 1.1;
+        const np::float_ expected_distance[] = {weight_3 / (weight_3 + weight_7), weight_7 / (weight_3 + weight_7), 0., 1.};
+        for (np::Size i = 0; i < 4; ++i) {
+            EXPECT_NEAR(proba.get(i), expected_distance[i], 1e-12);
+        }
+        // one search for both the neighbors and the probabilities
+        EXPECT_TRUE(np::array_equal(distance.predict_proba(distance.kneighbors(X_test)), proba));
+        EXPECT_THROW(distance.predict_proba(distance.kneighbors(X_test, std::nullopt, false)), std::runtime_error);
+    }
+}
+
+TEST_F(KNeighborsClassifierTest, borrowedFitTest) {
+    using namespace sklearn::neighbors;
+    using sklearn::utils::DenseMatrix;
+
+    const std::vector<np::float_> data{0., 1., 2., 10.};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 2.}, np::Shape{2, 1}};
+
+    const auto view = DenseMatrix<np::float_>::view(data.data(), 4, 1);
+    EXPECT_TRUE(view.is_view());
+    EXPECT_EQ(view.data(), data.data());
+    EXPECT_EQ(view.row(3), data.data() + 3);
+    EXPECT_THROW(DenseMatrix<np::float_>::view(data.data(), 4, 1).data()[0] = 1, std::runtime_error);
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        KNeighborsClassifier<np::float_, np::int_> copied{{.n_neighbors = 3, .algorithm = algorithm}};
+        copied.fit(np::Array<np::float_>{data, np::Shape{4, 1}}, y);
+
+        KNeighborsClassifier<np::float_, np::int_> borrowed{{.n_neighbors = 3, .algorithm = algorithm}};
+        borrowed.fit(view, y);
+        EXPECT_TRUE(np::array_equal(borrowed.predict(X_test), copied.predict(X_test)));
+        EXPECT_TRUE(np::array_equal(borrowed.kneighbors(X_test).second, copied.kneighbors(X_test).second));
+        // the view can be moved away, the index keeps the caller's data
+        KNeighborsClassifier<np::float_, np::int_> moved{std::move(borrowed)};
+        EXPECT_TRUE(np::array_equal(moved.predict(X_test), copied.predict(X_test)));
+    }
+}
+
+TEST_F(KNeighborsClassifierTest, dataFrameTest) {
+    using namespace sklearn::neighbors;
+
+    // two features, so that the column by column conversion has to interleave them
+    np::Array<np::float_> X{std::vector<np::float_>{0., 5., 1., 4., 2., 3., 10., -1.}, np::Shape{4, 2}};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 4.2, 9., 0.}, np::Shape{2, 2}};
+
+    KNeighborsClassifier<np::float_, np::int_> array{{.n_neighbors = 3, .weights = WeightsType::kDistance}};
+    array.fit(X, y);
+    KNeighborsClassifier<pd::DataFrame> frame{{.n_neighbors = 3, .weights = WeightsType::kDistance}};
+    frame.fit(pd::DataFrame{X}, pd::DataFrame{y});
+
+    const auto expected = array.predict(X_test);
+    const auto pred = frame.predict(pd::DataFrame{X_test});
+    for (np::Size i = 0; i < expected.size(); ++i) {
+        EXPECT_DOUBLE_EQ(static_cast<np::float_>(pred.at(i, 0)), static_cast<np::float_>(expected.get(i)));
+    }
+    EXPECT_TRUE(np::array_equal(frame.predict_proba(pd::DataFrame{X_test}), array.predict_proba(X_test)));
+    EXPECT_TRUE(np::array_equal(frame.kneighbors(pd::DataFrame{X_test}).second, array.kneighbors(X_test).second));
+    const auto classes = frame.classes_();
+    ASSERT_EQ(classes.shape()[0], array.classes_().size());
+    for (np::Size i = 0; i < classes.shape()[0]; ++i) {
+        EXPECT_DOUBLE_EQ(static_cast<np::float_>(classes.at(i, 0)), static_cast<np::float_>(array.classes_().get(i)));
+    }
+}
+
+TEST_F(KNeighborsClassifierTest, predictIntoTest) {
+    using namespace sklearn::neighbors;
+
+    const np::Size n_samples = 500;
+    const np::Size n_test = 40;
+    const np::Size n_features = 3;
+    std::vector<np::float_> x(n_samples * n_features);
+    std::vector<np::int_> y(n_samples);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>((i * 7919) % 1009) / 100.0;
+    }
+    for (np::Size i = 0; i < n_samples; ++i) {
+        y[i] = static_cast<np::int_>(x[i * n_features] + x[i * n_features + 1]) % 3;
+    }
+    std::vector<np::float_> x_test(n_test * n_features);
+    for (np::Size i = 0; i < x_test.size(); ++i) {
+        x_test[i] = static_cast<np::float_>((i * 104729) % 997) / 99.0;
+    }
+    np::Array<np::float_> X{x, np::Shape{n_samples, n_features}};
+    np::Array<np::int_> Y{y, np::Shape{n_samples}};
+    np::Array<np::float_> X_test{x_test, np::Shape{n_test, n_features}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree, AlgorithmType::kHnsw}) {
+        for (auto weights: {WeightsType::kUniform, WeightsType::kDistance}) {
+            for (int n_jobs: {1, 3}) {
+                KNeighborsClassifier<np::float_, np::int_> clf{{.n_neighbors = 5, .weights = weights, .algorithm = algorithm, .n_jobs = n_jobs}};
+                clf.fit(X, Y);
+                const auto expected = clf.predict(X_test);
+
+                std::vector<np::int_> batch(n_test, -1);
+                clf.predict_into(x_test.data(), n_test, n_features, batch.data());
+                for (np::Size i = 0; i < n_test; ++i) {
+                    np::int_ label{-1};
+                    clf.predict_into(x_test.data() + i * n_features, n_features, &label);
+                    EXPECT_EQ(label, expected.get(i));
+                    EXPECT_EQ(batch[i], expected.get(i));
+                }
+            }
+        }
+    }
+    KNeighborsClassifier<np::float_, np::int_> clf{};
+    np::int_ label{0};
+    EXPECT_THROW(clf.predict_into(x_test.data(), n_features, &label), std::runtime_error);
+    clf.fit(X, Y);
+    EXPECT_THROW(clf.predict_into(x_test.data(), n_features - 1, &label), std::runtime_error);
+}
@@ -0,0 +1,126 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/neighbors/KNeighborsRegressor.hpp>
+
+#include <SklearnTest.hpp>
+
+#include <cmath>
+
+class KNeighborsRegressorTest : public SklearnTest {
+protected:
+};
+
+TEST_F(KNeighborsRegressorTest, predictTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::float_> y{1., 2., 3., 10.};
+    // the neighbors of 0.9 are 1 and 0 (distances 0.1 and 0.9), of 9 are 10 and 2 (distances 1 and 7)
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 9., 1.}, np::Shape{3, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        KNeighborsRegressor<np::float_> uniform{{.n_neighbors = 2, .algorithm = algorithm}};
+        uniform.fit(X, y);
+        auto pred = uniform.predict(X_test);
+        checkArrayShape(pred, np::Shape{3});
+        EXPECT_DOUBLE_EQ(pred.get(0), 1.5);
+        EXPECT_DOUBLE_EQ(pred.get(1), 6.5);
+        // 0 and 2 are tied at distance 1 from 1, the smaller index wins
+        EXPECT_DOUBLE_EQ(pred.get(2), 1.5);
+        EXPECT_EQ(uniform.fit_method_(), algorithm);
+
+        KNeighborsRegressor<np::float_> distance{{.n_neighbors = 2, .weights = WeightsType::kDistance, .algorithm = algorithm}};
+        distance.fit(X, y);
+        pred = distance.predict(X_test);
+        EXPECT_NEAR(pred.get(0), (2. / 0.1 + 1. / 0.9) / (1 / 0.1 + 1 / 0.9), 1e-12);
+        EXPECT_NEAR(pred.get(1), (10. / 1 + 3. / 7) / (1 / 1. + 1 / 7.), 1e-12);
+        // an exact match takes all the weight
+        EXPECT_DOUBLE_EQ(pred.get(2), 2.);
+
+        KNeighborsRegressor<np::float_> callable{{.n_neighbors = 2,
+                                                  .weights = WeightsType::kCallable,
+                                                  .algorithm = algorithm,
+                                                  .weights_callable = [](np::float_ d) { return d < 0.5 ? 3.0 : 1.0; }}};
+        callable.fit(X, y);
+        EXPECT_DOUBLE_EQ(callable.predict(X_test).get(0), (3 * 2. + 1.) / 4);
+
+        auto [distances, indices] = uniform.kneighbors(X_test, 1);
+        EXPECT_TRUE(np::array_equal(indices, np::Array<np::Size>{std::vector<np::Size>{1, 3, 1}, np::Shape{3, 1}}));
+        EXPECT_NEAR(distances.get(0), 0.1, 1e-12);
+    }
+    EXPECT_THROW(KNeighborsRegressor<np::float_>{{.weights = WeightsType::kCallable}}, std::runtime_error);
+    EXPECT_THROW(KNeighborsRegressor<np::float_>{}.predict(X_test), std::runtime_error);
+}
+
+TEST_F(KNeighborsRegressorTest, nJobsTest) {
+    using namespace sklearn::neighbors;
+
+    const np::Size n_samples = 200;
+    const np::Size n_features = 3;
+    std::vector<np::float_> data(n_samples * n_features);
+    std::vector<np::float_> targets(n_samples);
+    for (np::Size i = 0; i < data.size(); ++i) {
+        data[i] = std::sin(static_cast<np::float_>(i) * 0.37);
+    }
+    for (np::Size i = 0; i < n_samples; ++i) {
+        targets[i] = std::cos(static_cast<np::float_>(i));
+    }
+    np::Array<np::float_> X{data, np::Shape{n_samples, n_features}};
+    np::Array<np::float_> y{targets, np::Shape{n_samples}};
+
+    KNeighborsRegressor<np::float_> serial{{.n_neighbors = 7, .weights = WeightsType::kDistance}};
+    serial.fit(X, y);
+    const auto expected = serial.predict(X);
+    for (int n_jobs: {2, 3, -1}) {
+        KNeighborsRegressor<np::float_> parallel{{.n_neighbors = 7, .weights = WeightsType::kDistance, .n_jobs = n_jobs}};
+        parallel.fit(X, y);
+        EXPECT_TRUE(np::array_equal(parallel.predict(X), expected));
+    }
+}
+
+TEST_F(KNeighborsRegressorTest, predictIntoTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::float_> y{1., 2., 3., 10.};
+    const std::vector<np::float_> x_test{0.9, 9., 1.};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        KNeighborsRegressor<np::float_> distance{{.n_neighbors = 2, .weights = WeightsType::kDistance, .algorithm = algorithm}};
+        distance.fit(X, y);
+        const auto expected = distance.predict(np::Array<np::float_>{x_test, np::Shape{3, 1}});
+
+        std::vector<float> batch(3);
+        distance.predict_into(x_test.data(), 3, 1, batch.data());
+        for (np::Size i = 0; i < 3; ++i) {
+            np::float_ pred{0};
+            distance.predict_into(x_test.data() + i, 1, &pred);
+            // brute force distances of single samples are not expanded, see brute_force_query_point
+            EXPECT_NEAR(pred, expected.get(i), 1e-12);
+            EXPECT_FLOAT_EQ(batch[i], static_cast<float>(expected.get(i)));
+        }
+    }
+}
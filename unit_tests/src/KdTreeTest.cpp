@@ -0,0 +1,118 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/datasets/datasets.hpp>
+#include <sklearn/metrics/DistanceKernel.hpp>
+#include <sklearn/metrics/accuracy_score.hpp>
+#include <sklearn/model_selection/train_test_split.hpp>
+#include <sklearn/neighbors/KNeighborsClassifier.hpp>
+#include <sklearn/neighbors/KdTree.hpp>
+#include <sklearn/preprocessing/StandardScaler.hpp>
+
+#include <NeighborsTest.hpp>
+
+using namespace sklearn::metrics;
+using namespace sklearn::neighbors;
+
+class KdTreeTest : public NeighborsTest {
+protected:
+};
+
+TEST_F(KdTreeTest, queryTest) {
+    /*
+>>> from sklearn.neighbors import KDTree
+>>> X = [[0, 0], [1, 1], [2, 2], [3, 3], [10, 10]]
+>>> tree = KDTree(X, leaf_size=2)
+>>> tree.query([[2.1, 2.1]], k=3)
+(array([[0.14142136, 1.27279221, 1.55563492]]), array([[2, 3, 1]]))
+*/
+    np::float_ X_c[5][2] = {{0.0, 0.0}, {1.0, 1.0}, {2.0, 2.0}, {3.0, 3.0}, {10.0, 10.0}};
+    auto tree = KdTree{np::Array<np::float_>{X_c}, 2};
+    np::float_ Y_c[1][2] = {{2.1, 2.1}};
+    auto [distances, indices] = tree.query(np::Array<np::float_>{Y_c}, 3);
+
+    np::float_ distances_c[1][3] = {{0.14142135623730964, 1.2727922061357855, 1.5556349186104046}};
+    compare(distances, np::Array<np::float_>{distances_c});
+    compare(indices, np::Array<np::Size>{std::vector<np::Size>{2, 3, 1}, np::Shape{1, 3}});
+}
+
+TEST_F(KdTreeTest, bruteForceAgreementTest) {
+    auto X = randomArray(1000, 8, 1);
+    auto Y = randomArray(50, 8, 2);
+    for (auto metric: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev}) {
+        auto tree = KdTree{X, 10, metric};
+        checkQuery(tree, X, Y, 7, DistanceKernel{metric});
+    }
+    auto tree = KdTree{X, 40, DistanceMetricType::kMinkowski, 3};
+    checkQuery(tree, X, Y, 5, DistanceKernel{DistanceMetricType::kMinkowski, 3});
+}
+
+TEST_F(KdTreeTest, queryRadiusTest) {
+    auto X = randomArray(500, 4, 6);
+    auto Y = randomArray(20, 4, 7);
+    for (auto metric: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev}) {
+        auto tree = KdTree{X, 10, metric};
+        checkQueryRadius(tree, X, Y, 0.5, DistanceKernel{metric});
+    }
+}
+
+TEST_F(KdTreeTest, duplicatePointsTest) {
+    np::Array<np::float_> X{std::vector<np::float_>(2 * 100, 1.0), np::Shape{100, 2}};
+    auto tree = KdTree{X, 3};
+    checkQuery(tree, X, randomArray(5, 2, 3), 10, DistanceKernel{});
+}
+
+TEST_F(KdTreeTest, invalidParametersTest) {
+    auto X = randomArray(10, 3, 4);
+    EXPECT_THROW(KdTree(X, 0), std::runtime_error);
+    auto tree = KdTree{X};
+    EXPECT_THROW(tree.query(X, 11), std::runtime_error);
+    EXPECT_THROW(tree.query(randomArray(10, 2, 5), 1), std::runtime_error);
+}
+
+TEST_F(KdTreeTest, kNeighborsClassifierTest) {
+    using namespace sklearn::datasets;
+    using namespace sklearn::model_selection;
+    using namespace sklearn::preprocessing;
+
+    auto iris = load_iris();
+    auto [X_train, X_test, y_train, y_test] =
+            train_test_split<np::float_, np::int_, 600, 150>({.X = iris.data(), .y = iris.target(), .test_size = 0.2, .random_state = 42});
+    auto sc_X = StandardScaler();
+    X_train = sc_X.fit_transform(X_train);
+    X_test = sc_X.transform(X_test);
+
+    auto kn = KNeighborsClassifier<np::float_, np::int_>{{.n_neighbors = 13,
+                                                          .algorithm = AlgorithmType::kKdTree,
+                                                          .leaf_size = 5,
+                                                          .metric = DistanceMetricType::kEuclidean}};
+    kn.fit(X_train, y_train);
+    auto y_pred = kn.predict(X_test);
+
+    auto score = accuracy_score<np::int_>(y_test, y_pred);
+    EXPECT_GE(score, 0.7);
+}
@@ -32,8 +32,31 @@ SOFTWARE.
 
 #include <SklearnTest.hpp>
 
+#include <thread>
+#include <vector>
+
 class LinearRegressionTest : public SklearnTest {
 protected:
+    // A design of n_samples x 3 features with a noisy linear target, row-major.
+    static void generate(np::Size n_samples, std::vector<np::float_> &X, std::vector<np::float_> &y) {
+        const np::Size n_features = 3;
+        X.resize(n_samples * n_features);
+        y.resize(n_samples);
+        for (np::Size i = 0; i < n_samples; ++i) {
+            for (np::Size j = 0; j < n_features; ++j) {
+                X[i * n_features + j] = static_cast<np::float_>((i * (j + 3)) % 17) / 4.0;
+            }
+            y[i] = 1.0 + X[i * n_features] - 2.0 * X[i * n_features + 1] + 0.5 * X[i * n_features + 2] + static_cast<np::float_>(i % 5) / 10.0;
+        }
+    }
+
+    template<typename Array>
+    static void expectNear(const Array &actual, const std::vector<np::float_> &expected, np::float_ tolerance) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (np::Size i = 0; i < expected.size(); ++i) {
+            EXPECT_NEAR(actual.get(i), expected[i], tolerance);
+        }
+    }
 };
 
 TEST_F(LinearRegressionTest, OLSTest) {
@@ -44,15 +67,14 @@ TEST_F(LinearRegressionTest, OLSTest) {
     np::float_ y[4] = {6.0, 8.0, 9.0, 11.0};
     reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y});
 
-    EXPECT_DOUBLE_EQ(reg.intercept_(), 4.8000000000000558);
+    EXPECT_NEAR(reg.intercept_(), 4.8, 1e-12);
 
-    compare(reg.coef_(), np::Array<np::float_>{0.7, 1.1});
+    expectNear(reg.coef_(), {0.7, 1.1}, 1e-12);
 
     np::float_ ar_pred[3][2] = {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
     auto pred = reg.predict(np::Array<np::float_>{ar_pred});
 
-    np::float_ pred_sample[3] = {7.7, 11.3, 14.9};
-    compare(pred, np::Array<np::float_>{pred_sample});
+    expectNear(pred, {7.7, 11.3, 14.9}, 1e-12);
 }
 
 TEST_F(LinearRegressionTest, weightedOLSTest) {
@@ -65,15 +87,42 @@ TEST_F(LinearRegressionTest, weightedOLSTest) {
     np::float_ sample_weight[4] = {4.0, 0.5, 2.0, 3.0};
     reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y}, np::Array<np::float_>{sample_weight});
 
-    EXPECT_DOUBLE_EQ(reg.intercept_(), 4.1250000000000187);
+    EXPECT_NEAR(reg.intercept_(), 4.125, 1e-12);
 
-    compare(reg.coef_(), np::Array<np::float_>{1.5625, 0.59375});
+    expectNear(reg.coef_(), {1.5625, 0.59375}, 1e-12);
 
     np::float_ ar_pred[3][2] = {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
     auto pred = reg.predict(np::Array<np::float_>{ar_pred});
 
-    np::float_ pred_sample[3] = {6.875, 11.1875, 15.5};
-    compare(pred, np::Array<np::float_>{pred_sample});
+    expectNear(pred, {6.875, 11.1875, 15.5}, 1e-12);
+}
+
+TEST_F(LinearRegressionTest, sampleWeightTest) {
+    // Integer weights fit as repeated samples, a zero weight as a dropped sample, with every solver.
+    using namespace sklearn::linear_model;
+    const std::vector<np::float_> X{1.0, 1.0, 1.0, 2.0, 2.0, 2.0, 3.0, 4.0, 0.0, 7.0};
+    const std::vector<np::float_> y{6.0, 8.0, 9.0, 11.0, 100.0};
+    const std::vector<np::float_> sample_weight{2.0, 1.0, 3.0, 1.0, 0.0};
+    const std::vector<np::float_> X_repeated{1.0, 1.0, 1.0, 1.0, 1.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 3.0, 4.0};
+    const std::vector<np::float_> y_repeated{6.0, 6.0, 8.0, 9.0, 9.0, 9.0, 11.0};
+    for (auto solver: {SolverType::kAuto, SolverType::kCholesky, SolverType::kQr, SolverType::kSvd}) {
+        auto weighted = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        weighted.fit(np::Array<np::float_>{X, np::Shape{5, 2}}, np::Array<np::float_>{y, np::Shape{5}}, np::Array<np::float_>{sample_weight, np::Shape{5}});
+        auto repeated = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        repeated.fit(np::Array<np::float_>{X_repeated, np::Shape{7, 2}}, np::Array<np::float_>{y_repeated, np::Shape{7}});
+        EXPECT_NEAR(weighted.intercept_(), repeated.intercept_(), 1e-10);
+        expectNear(weighted.coef_(), {repeated.coef_().get(0), repeated.coef_().get(1)}, 1e-10);
+
+        auto view = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        view.fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), 5, 2), np::Array<np::float_>{y, np::Shape{5}}, np::Array<np::float_>{sample_weight, np::Shape{5}});
+        EXPECT_EQ(view.intercept_(), weighted.intercept_());
+    }
+
+    auto reg = LinearRegression{};
+    const std::vector<np::float_> negative{2.0, 1.0, -3.0, 1.0, 0.0};
+    EXPECT_THROW(reg.fit(np::Array<np::float_>{X, np::Shape{5, 2}}, np::Array<np::float_>{y, np::Shape{5}}, np::Array<np::float_>{negative, np::Shape{5}}), std::runtime_error);
+    const std::vector<np::float_> zero(5, 0.0);
+    EXPECT_THROW(reg.fit(np::Array<np::float_>{X, np::Shape{5, 2}}, np::Array<np::float_>{y, np::Shape{5}}, np::Array<np::float_>{zero, np::Shape{5}}), std::runtime_error);
 }
 
 TEST_F(LinearRegressionTest, diabetesTest) {
@@ -111,9 +160,235 @@ TEST_F(LinearRegressionTest, diabetesTest) {
     // The mean squared error
     MeanSquaredErrorParameters<decltype(diabetes_y_test), decltype(diabetes_y_pred)> mseParams{.y_true = diabetes_y_test, .y_pred = diabetes_y_pred};
     auto mse = mean_squared_error(mseParams);
-    EXPECT_DOUBLE_EQ(mse, 2548.0723987259735);
+    EXPECT_NEAR(mse, 2548.0723987259735, 1e-8);
     R2ScoreParameters<decltype(diabetes_y_test), decltype(diabetes_y_pred)> r2ScoreParams{.y_true = diabetes_y_test, .y_pred = diabetes_y_pred};
     // The coefficient of determination: 1 is perfect prediction
     auto r2 = r2_score(r2ScoreParams);
-    EXPECT_DOUBLE_EQ(r2, 0.47257544798227069);
-}
\ No newline at end of file
+    EXPECT_NEAR(r2, 0.47257544798227069, 1e-12);
+}
+
+TEST_F(LinearRegressionTest, solversTest) {
+    using namespace sklearn::linear_model;
+    np::float_ X[4][2] = {{1.0, 1.0}, {1.0, 2.0}, {2.0, 2.0}, {3.0, 4.0}};
+    np::float_ y[4] = {6.0, 8.0, 9.0, 11.0};
+    for (auto solver: {SolverType::kAuto, SolverType::kCholesky, SolverType::kQr, SolverType::kSvd}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y});
+        EXPECT_EQ(reg.solver_(), solver == SolverType::kAuto ? SolverType::kCholesky : solver);
+        EXPECT_NEAR(reg.intercept_(), 4.8, 1e-12);
+        expectNear(reg.coef_(), {0.7, 1.1}, 1e-12);
+        expectNear(reg.coeffs_(), {4.8, 0.7, 1.1}, 1e-12);
+    }
+}
+
+TEST_F(LinearRegressionTest, rankDeficientTest) {
+    // The second feature is constant: cholesky and qr cannot solve the problem, auto falls back to the minimum norm
+    // solution of svd, which leaves the constant feature out.
+    using namespace sklearn::linear_model;
+    np::float_ X[4][2] = {{1.0, 5.0}, {2.0, 5.0}, {3.0, 5.0}, {4.0, 5.0}};
+    np::float_ y[4] = {3.0, 5.0, 7.0, 9.0};
+    for (auto solver: {SolverType::kAuto, SolverType::kSvd}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y});
+        EXPECT_EQ(reg.solver_(), SolverType::kSvd);
+        EXPECT_NEAR(reg.intercept_(), 1.0, 1e-12);
+        expectNear(reg.coef_(), {2.0, 0.0}, 1e-12);
+    }
+    for (auto solver: {SolverType::kCholesky, SolverType::kQr}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        EXPECT_THROW(reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y}), std::runtime_error);
+    }
+}
+
+TEST_F(LinearRegressionTest, largeOffsetTest) {
+    // Features far from the origin: the statistics are centered block by block, so no digits are lost in X^T X.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 1000;
+    std::vector<np::float_> X(n_samples * 2);
+    std::vector<np::float_> y(n_samples);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        X[i * 2] = 1e8 + static_cast<np::float_>(i % 37);
+        X[i * 2 + 1] = -1e8 + static_cast<np::float_>((i * 7) % 101);
+        y[i] = 3.0 + 0.5 * (X[i * 2] - 1e8) - 0.25 * (X[i * 2 + 1] + 1e8);
+    }
+    for (auto solver: {SolverType::kAuto, SolverType::kCholesky, SolverType::kQr, SolverType::kSvd}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, 2}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+        expectNear(reg.coef_(), {0.5, -0.25}, 1e-9);
+        EXPECT_NEAR(reg.intercept_(), 3.0 - 0.5e8 - 0.25e8, 1e-1);
+    }
+}
+
+TEST_F(LinearRegressionTest, denseMatrixFitTest) {
+    // Blocks of rows are read in place from a view, with the same result as the array, across several blocks.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 1000;
+    const np::Size n_features = 3;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    const np::Array<np::float_> y_array{y, np::Shape{n_samples}};
+    auto reg = LinearRegression{};
+    reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, n_features}}, y_array);
+    auto regView = LinearRegression{};
+    regView.fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_samples, n_features), y_array);
+    EXPECT_EQ(regView.intercept_(), reg.intercept_());
+    for (np::Size j = 0; j < n_features; ++j) {
+        EXPECT_EQ(regView.coef_().get(j), reg.coef_().get(j));
+    }
+    EXPECT_THROW(regView.fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_samples - 1, n_features), y_array), std::runtime_error);
+}
+
+TEST_F(LinearRegressionTest, partialFitTest) {
+    // Chunks of any size, across the blocks of rows, give the model of the whole data, with and without weights.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 1000;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    std::vector<np::float_> sample_weight(n_samples);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        sample_weight[i] = static_cast<np::float_>(i % 3);
+    }
+    const std::vector<np::Size> chunks{0, 1, 300, 301, 1000};
+    for (auto solver: {SolverType::kAuto, SolverType::kCholesky, SolverType::kQr, SolverType::kSvd}) {
+        for (bool weighted: {false, true}) {
+            const auto weights = weighted ? std::optional<np::Array<np::float_>>{np::Array<np::float_>{sample_weight, np::Shape{n_samples}}} : std::nullopt;
+            auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+            reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, 3}}, np::Array<np::float_>{y, np::Shape{n_samples}}, weights);
+
+            auto incremental = LinearRegression{LinearRegressionParameters{.solver = solver}};
+            for (np::Size c = 0; c + 1 < chunks.size(); ++c) {
+                const np::Size rows = chunks[c + 1] - chunks[c];
+                std::optional<np::Array<np::float_>> chunk_weights;
+                if (weighted) {
+                    chunk_weights = np::Array<np::float_>{std::vector<np::float_>(sample_weight.cbegin() + static_cast<long>(chunks[c]), sample_weight.cbegin() + static_cast<long>(chunks[c + 1])), np::Shape{rows}};
+                }
+                incremental.partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data() + chunks[c] * 3, rows, 3),
+                                        np::Array<np::float_>{std::vector<np::float_>(y.cbegin() + static_cast<long>(chunks[c]), y.cbegin() + static_cast<long>(chunks[c + 1])), np::Shape{rows}}, chunk_weights);
+            }
+            EXPECT_EQ(incremental.n_samples_seen_(), n_samples);
+            EXPECT_EQ(incremental.solver_(), solver == SolverType::kAuto ? SolverType::kQr : solver);
+            EXPECT_NEAR(incremental.intercept_(), reg.intercept_(), 1e-10);
+            expectNear(incremental.coef_(), {reg.coef_().get(0), reg.coef_().get(1), reg.coef_().get(2)}, 1e-10);
+        }
+    }
+
+    auto reg = LinearRegression{};
+    reg.partial_fit(np::Array<np::float_>{X, np::Shape{n_samples, 3}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+    EXPECT_THROW(reg.partial_fit(np::Array<np::float_>{X, np::Shape{n_samples / 2, 6}}, np::Array<np::float_>{std::vector<np::float_>(n_samples / 2), np::Shape{n_samples / 2}}), std::runtime_error);
+    // fit discards the statistics
+    np::float_ X_small[4][2] = {{1.0, 1.0}, {1.0, 2.0}, {2.0, 2.0}, {3.0, 4.0}};
+    np::float_ y_small[4] = {6.0, 8.0, 9.0, 11.0};
+    reg.fit(np::Array<np::float_>{X_small}, np::Array<np::float_>{y_small});
+    EXPECT_EQ(reg.n_samples_seen_(), 0);
+    EXPECT_NEAR(reg.intercept_(), 4.8, 1e-12);
+}
+
+TEST_F(LinearRegressionTest, mergeTest) {
+    // Shards fitted separately and merged give the model of the whole data.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 1000;
+    const np::Size n_shards = 3;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    for (auto solver: {SolverType::kAuto, SolverType::kCholesky, SolverType::kQr, SolverType::kSvd}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, 3}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+
+        std::vector<LinearRegression> shards(n_shards, LinearRegression{LinearRegressionParameters{.solver = solver}});
+        for (np::Size s = 0; s < n_shards; ++s) {
+            const np::Size begin = n_samples * s / n_shards;
+            const np::Size end = n_samples * (s + 1) / n_shards;
+            shards[s].partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data() + begin * 3, end - begin, 3),
+                                  np::Array<np::float_>{std::vector<np::float_>(y.cbegin() + static_cast<long>(begin), y.cbegin() + static_cast<long>(end)), np::Shape{end - begin}});
+        }
+        auto merged = LinearRegression{LinearRegressionParameters{.solver = solver}};
+        for (const auto &shard: shards) {
+            merged.merge(shard);
+        }
+        EXPECT_EQ(merged.n_samples_seen_(), n_samples);
+        EXPECT_NEAR(merged.intercept_(), reg.intercept_(), 1e-10);
+        expectNear(merged.coef_(), {reg.coef_().get(0), reg.coef_().get(1), reg.coef_().get(2)}, 1e-10);
+    }
+
+    auto cholesky = LinearRegression{LinearRegressionParameters{.solver = SolverType::kCholesky}};
+    auto qr = LinearRegression{LinearRegressionParameters{.solver = SolverType::kQr}};
+    cholesky.partial_fit(np::Array<np::float_>{X, np::Shape{n_samples, 3}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+    qr.partial_fit(np::Array<np::float_>{X, np::Shape{n_samples, 3}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+    EXPECT_THROW(cholesky.merge(qr), std::runtime_error);
+}
+
+TEST_F(LinearRegressionTest, float32PredictTest) {
+    using namespace sklearn::linear_model;
+    np::float_ X[4][2] = {{1.0, 1.0}, {1.0, 2.0}, {2.0, 2.0}, {3.0, 4.0}};
+    np::float_ y[4] = {6.0, 8.0, 9.0, 11.0};
+    float ar_pred[3][2] = {{1.0f, 2.0f}, {3.0f, 4.0f}, {5.0f, 6.0f}};
+    np::float_ pred_sample[3] = {7.7, 11.3, 14.9};
+    for (auto accumulation: {sklearn::utils::Accumulation::kFloat64, sklearn::utils::Accumulation::kFloat32}) {
+        auto reg = LinearRegression{LinearRegressionParameters{.accumulation = accumulation}};
+        reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y});
+
+        const np::Array<float> pred = reg.predict(np::Array<float>{ar_pred});
+        checkArrayShape(pred, np::Shape{3});
+        for (np::Size i = 0; i < 3; ++i) {
+            EXPECT_NEAR(pred.get(i), pred_sample[i], 1e-5);
+        }
+    }
+    EXPECT_THROW(LinearRegression{}.predict(np::Array<float>{ar_pred}), std::runtime_error);
+}
+
+TEST_F(LinearRegressionTest, predictIntoTest) {
+    using namespace sklearn::linear_model;
+    auto reg = LinearRegression{};
+
+    np::float_ X[4][2] = {{1.0, 1.0}, {1.0, 2.0}, {2.0, 2.0}, {3.0, 4.0}};
+    np::float_ y[4] = {6.0, 8.0, 9.0, 11.0};
+    const std::vector<np::float_> x_pred{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    np::float_ out{0};
+    EXPECT_THROW(reg.predict_into(x_pred.data(), 2, &out), std::runtime_error);
+    reg.fit(np::Array<np::float_>{X}, np::Array<np::float_>{y});
+
+    const auto expected = reg.predict(np::Array<np::float_>{x_pred, np::Shape{3, 2}});
+    std::vector<np::float_> batch(3);
+    reg.predict_into(x_pred.data(), 3, 2, batch.data());
+    for (np::Size i = 0; i < 3; ++i) {
+        reg.predict_into(x_pred.data() + i * 2, 2, &out);
+        EXPECT_EQ(out, expected.get(i));
+        EXPECT_EQ(batch[i], expected.get(i));
+    }
+    EXPECT_THROW(reg.predict_into(x_pred.data(), 3, &out), std::runtime_error);
+}
+
+TEST_F(LinearRegressionTest, concurrentSolveTest) {
+    // Threads serving right after a partial_fit share one lazy solve and all predict the model of the data.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 1000;
+    const np::Size n_features = 3;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    auto reference = LinearRegression{};
+    reference.fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_samples, n_features), np::Array<np::float_>{y, np::Shape{n_samples}});
+    std::vector<np::float_> expected(n_samples);
+    reference.predict_into(X.data(), n_samples, n_features, expected.data());
+
+    for (int round = 0; round < 20; ++round) {
+        auto reg = LinearRegression{};
+        reg.partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_samples, n_features), np::Array<np::float_>{y, np::Shape{n_samples}});
+        std::vector<std::vector<np::float_>> pred(4, std::vector<np::float_>(n_samples));
+        std::vector<std::thread> threads;
+        for (np::Size t = 0; t < pred.size(); ++t) {
+            threads.emplace_back([&, t] { reg.predict_into(X.data(), n_samples, n_features, pred[t].data()); });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        for (const auto &p: pred) {
+            for (np::Size i = 0; i < n_samples; ++i) {
+                EXPECT_NEAR(p[i], expected[i], 1e-9);
+            }
+        }
+    }
+}
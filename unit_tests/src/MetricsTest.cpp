@@ -24,8 +24,11 @@ SOFTWARE.
 
 #include <np/Comp.hpp>
 
+#include <sklearn/metrics/DistanceKernel.hpp>
 #include <sklearn/metrics/DistanceMetric.hpp>
 #include <sklearn/metrics/EuclideanDistance.hpp>
+#include <sklearn/metrics/MinkowskiDistance.hpp>
+#include <sklearn/metrics/pairwise_distances.hpp>
 
 #include <SklearnTest.hpp>
 
@@ -208,3 +211,221 @@ array([[10.39230485, 15.58845727, 20.78460969],
     np::Array<np::float_> result_sample{result_array_c};
     compare(result, result_sample);
 }
+
+TEST_F(MetricsTest, minkowskiDistancePairwiseGeneralPTest) {
+    /*
+>>> from sklearn.metrics import DistanceMetric
+>>> X = [[0, 1, 2],
+        [3, 4, 5]]
+>>> Y = [[6, 7, 8],
+        [9, 10, 11],
+        [12, 13, 14]]
+>>> DistanceMetric.get_metric('minkowski', p=3).pairwise(X, Y)
+array([[ 8.65349742, 12.98024613, 17.30699484],
+       [ 4.32674871,  8.65349742, 12.98024613]])
+>>> DistanceMetric.get_metric('minkowski', p=1.5).pairwise(X, Y)
+array([[12.48050294, 18.72075441, 24.96100588],
+       [ 6.24025147, 12.48050294, 18.72075441]])
+*/
+    np::float_ array_1_c[2][3] = {{0.0, 1.0, 2.0}, {3.0, 4.0, 5.0}};
+    np::Array<np::float_> array_1{array_1_c};
+    np::float_ array_2_c[3][3] = {{6.0, 7.0, 8.0}, {9.0, 10.0, 11.0}, {12.0, 13.0, 14.0}};
+    np::Array<np::float_> array_2{array_2_c};
+    const std::vector<np::float_> expected_3{8.653497421844449, 12.980246132766673, 17.306994843688898, 4.3267487109222245, 8.653497421844449, 12.980246132766673};
+    const std::vector<np::float_> expected_1_5{12.480502938311423, 18.720754407467133, 24.961005876622846, 6.240251469155711, 12.480502938311423, 18.720754407467133};
+    for (const auto &[p, expected]: {std::make_pair(3.0, expected_3), std::make_pair(1.5, expected_1_5)}) {
+        auto dist = DistanceMetric<np::Array<np::float_>>::get_metric(DistanceMetricType::kMinkowski, p);
+        auto result = dist->pairwise(array_1, array_2);
+        checkArrayShape(result, np::Shape{2, 3});
+        for (np::Size i = 0; i < expected.size(); ++i) {
+            EXPECT_NEAR(result.get(i), expected[i], 1e-12);
+        }
+        auto self = dist->pairwise(array_1);
+        EXPECT_EQ(self.get(0), 0.0);
+        EXPECT_NEAR(self.get(1), expected[3], 1e-12);
+        EXPECT_EQ(self.get(1), self.get(2));
+    }
+}
+
+TEST_F(MetricsTest, minkowskiDistanceReducedTest) {
+    np::float_ array_1_c[2][3] = {{0.0, 1.0, 2.0}, {3.0, 4.0, 5.0}};
+    np::Array<np::float_> array_1{array_1_c};
+    np::float_ array_2_c[3][3] = {{6.0, 7.0, 8.0}, {9.0, 10.0, 11.0}, {12.0, 13.0, 14.0}};
+    np::Array<np::float_> array_2{array_2_c};
+
+    MinkowskiDistance<np::Array<np::float_>> cube{3};
+    np::float_ cube_c[2][3] = {{648., 2187., 5184.}, {81., 648., 2187.}};
+    compare(cube.reduced_pairwise(array_1, array_2), np::Array<np::float_>{cube_c});
+
+    MinkowskiDistance<np::Array<np::float_>> square{2};
+    np::float_ square_c[2][3] = {{108., 243., 432.}, {27., 108., 243.}};
+    compare(square.reduced_pairwise(array_1, array_2), np::Array<np::float_>{square_c});
+
+    MinkowskiDistance<np::Array<np::float_>> chebyshev{std::numeric_limits<np::float_>::infinity()};
+    np::float_ chebyshev_c[2][2] = {{0., 3.}, {3., 0.}};
+    compare(chebyshev.reduced_pairwise(array_1), np::Array<np::float_>{chebyshev_c});
+
+    EXPECT_THROW(MinkowskiDistance<np::Array<np::float_>>{0.5}, std::runtime_error);
+}
+
+TEST_F(MetricsTest, distanceKernelIntegerPTest) {
+    const np::float_ x[4] = {0.5, -1.25, 3.0, 2.0};
+    const np::float_ y[4] = {-0.75, 2.0, 1.5, 2.0};
+    for (int p = 1; p <= 7; ++p) {
+        DistanceKernel kernel{DistanceMetricType::kMinkowski, static_cast<np::float_>(p)};
+        np::float_ expected{0};
+        for (np::Size i = 0; i < 4; ++i) {
+            expected += std::pow(std::abs(x[i] - y[i]), p);
+        }
+        EXPECT_NEAR(kernel.rdist(x, y, 4), expected, 1e-12 * expected);
+        EXPECT_NEAR(kernel.dist_to_rdist(kernel.dist(x, y, 4)), expected, 1e-12 * expected);
+    }
+}
+
+TEST_F(MetricsTest, euclideanDistancePairwiseBlockedTest) {
+    // sizes that are not multiples of the register tile and of the cache blocks, and a duplicated row
+    const np::Size n_x = 70;
+    const np::Size n_y = 131;
+    const np::Size n_features = 259;
+    std::vector<np::float_> x(n_x * n_features);
+    std::vector<np::float_> y(n_y * n_features);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>((i * 7919) % 113) / 17.0 - 3.0;
+    }
+    for (np::Size i = 0; i < y.size(); ++i) {
+        y[i] = static_cast<np::float_>((i * 104729) % 127) / 19.0 - 3.0;
+    }
+    std::copy(x.begin(), x.begin() + n_features, y.begin() + 5 * n_features);
+    np::Array<np::float_> X{x, np::Shape{n_x, n_features}};
+    np::Array<np::float_> Y{y, np::Shape{n_y, n_features}};
+
+    auto dist = DistanceMetric<np::Array<np::float_>>::get_metric(DistanceMetricType::kEuclidean);
+    auto result = dist->pairwise(X, Y);
+    checkArrayShape(result, np::Shape{n_x, n_y});
+    for (np::Size i = 0; i < n_x; ++i) {
+        for (np::Size j = 0; j < n_y; ++j) {
+            np::float_ expected{0};
+            for (np::Size f = 0; f < n_features; ++f) {
+                const auto d = x[i * n_features + f] - y[j * n_features + f];
+                expected += d * d;
+            }
+            EXPECT_NEAR(result.get(i * n_y + j), std::sqrt(expected), 1e-6);
+        }
+    }
+    EXPECT_EQ(result.get(5), 0.0);
+
+    auto self = dist->pairwise(X);
+    for (np::Size i = 0; i < n_x; ++i) {
+        EXPECT_EQ(self.get(i * n_x + i), 0.0);
+    }
+}
+
+TEST_F(MetricsTest, symmetricPairwiseTest) {
+    const np::Size n = 150;
+    const np::Size n_features = 5;
+    std::vector<np::float_> x(n * n_features);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>((i * 7919) % 101) / 13.0;
+    }
+    np::Array<np::float_> X{x, np::Shape{n, n_features}};
+    for (auto type: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev, DistanceMetricType::kMinkowski}) {
+        auto dist = DistanceMetric<np::Array<np::float_>>::get_metric(type);
+        auto result = dist->pairwise(X);
+        auto expected = dist->pairwise(X, X);
+        checkArrayShape(result, np::Shape{n, n});
+        for (np::Size i = 0; i < n; ++i) {
+            EXPECT_EQ(result.get(i * n + i), 0.0);
+            for (np::Size j = 0; j < n; ++j) {
+                EXPECT_EQ(result.get(i * n + j), result.get(j * n + i));
+                if (i != j) {
+                    EXPECT_NEAR(result.get(i * n + j), expected.get(i * n + j), 1e-9);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(MetricsTest, triangularRowBlocksTest) {
+    const np::Size n = 1000;
+    const auto bounds = triangular_row_blocks(n, 8);
+    ASSERT_EQ(bounds.size(), 9);
+    EXPECT_EQ(bounds.front(), 0);
+    EXPECT_EQ(bounds.back(), n);
+    const np::Size n_pairs = n * (n - 1) / 2;
+    for (np::Size block = 0; block + 1 < bounds.size(); ++block) {
+        np::Size pairs = 0;
+        for (np::Size i = bounds[block]; i < bounds[block + 1]; ++i) {
+            pairs += n - 1 - i;
+        }
+        EXPECT_NEAR(static_cast<double>(pairs), static_cast<double>(n_pairs) / 8, static_cast<double>(n));
+    }
+    EXPECT_EQ(triangular_row_blocks(1, 8), (std::vector<np::Size>{0, 1}));
+    EXPECT_EQ(triangular_row_blocks(3, 8), (std::vector<np::Size>{0, 1, 3}));
+}
+
+TEST_F(MetricsTest, manhattanChebyshevPairwiseBlockedTest) {
+    // sizes that are not multiples of the register tile and of the cache blocks
+    const np::Size n_x = 71;
+    const np::Size n_y = 263;
+    const np::Size n_features = 6;
+    std::vector<np::float_> x(n_x * n_features);
+    std::vector<np::float_> y(n_y * n_features);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>((i * 7919) % 113) / 17.0 - 3.0;
+    }
+    for (np::Size i = 0; i < y.size(); ++i) {
+        y[i] = static_cast<np::float_>((i * 104729) % 127) / 19.0 - 3.0;
+    }
+    np::Array<np::float_> X{x, np::Shape{n_x, n_features}};
+    np::Array<np::float_> Y{y, np::Shape{n_y, n_features}};
+
+    auto manhattan = DistanceMetric<np::Array<np::float_>>::get_metric(DistanceMetricType::kManhattan)->pairwise(X, Y);
+    auto chebyshev = DistanceMetric<np::Array<np::float_>>::get_metric(DistanceMetricType::kChebyshev)->pairwise(X, Y);
+    checkArrayShape(manhattan, np::Shape{n_x, n_y});
+    checkArrayShape(chebyshev, np::Shape{n_x, n_y});
+    for (np::Size i = 0; i < n_x; ++i) {
+        for (np::Size j = 0; j < n_y; ++j) {
+            np::float_ sum{0};
+            np::float_ max{0};
+            for (np::Size f = 0; f < n_features; ++f) {
+                const auto d = std::abs(x[i * n_features + f] - y[j * n_features + f]);
+                sum += d;
+                max = std::max(max, d);
+            }
+            EXPECT_EQ(manhattan.get(i * n_y + j), sum);
+            EXPECT_EQ(chebyshev.get(i * n_y + j), max);
+        }
+    }
+}
+
+TEST_F(MetricsTest, float32PairwiseTest) {
+    const np::Size n_x = 37;
+    const np::Size n_y = 53;
+    const np::Size n_features = 67;
+    std::vector<np::float_> x(n_x * n_features);
+    std::vector<np::float_> y(n_y * n_features);
+    for (np::Size i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<np::float_>(static_cast<float>(static_cast<np::float_>((i * 7919) % 113) / 17.0 - 3.0));
+    }
+    for (np::Size i = 0; i < y.size(); ++i) {
+        y[i] = static_cast<np::float_>(static_cast<float>(static_cast<np::float_>((i * 104729) % 127) / 19.0 - 3.0));
+    }
+    np::Array<np::float_> X{x, np::Shape{n_x, n_features}};
+    np::Array<np::float_> Y{y, np::Shape{n_y, n_features}};
+    np::Array<float> X32{std::vector<float>(x.cbegin(), x.cend()), np::Shape{n_x, n_features}};
+    np::Array<float> Y32{std::vector<float>(y.cbegin(), y.cend()), np::Shape{n_y, n_features}};
+
+    for (auto type: {DistanceMetricType::kEuclidean, DistanceMetricType::kManhattan, DistanceMetricType::kChebyshev, DistanceMetricType::kMinkowski}) {
+        const auto expected = DistanceMetric<np::Array<np::float_>>::get_metric(type, 3)->pairwise(X, Y);
+        for (auto accumulation: {sklearn::utils::Accumulation::kFloat64, sklearn::utils::Accumulation::kFloat32}) {
+            auto dist = DistanceMetric<np::Array<float>>::get_metric(type, 3, accumulation);
+            EXPECT_EQ(dist->accumulation(), accumulation);
+            const np::Array<float> result = dist->pairwise(X32, Y32);
+            checkArrayShape(result, np::Shape{n_x, n_y});
+            const np::float_ tolerance = accumulation == sklearn::utils::Accumulation::kFloat64 ? 1e-6 : 1e-4;
+            for (np::Size i = 0; i < result.size(); ++i) {
+                EXPECT_NEAR(result.get(i), expected.get(i), tolerance * std::max(np::float_{1}, expected.get(i)));
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/neighbors/RadiusNeighborsClassifier.hpp>
+
+#include <SklearnTest.hpp>
+
+class RadiusNeighborsClassifierTest : public SklearnTest {
+protected:
+};
+
+TEST_F(RadiusNeighborsClassifierTest, predictTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    // within 1.5 of 0.9 are 1 (class 3, distance 0.1), 0 and 2 (class 7, distances 0.9 and 1.1), nothing is within
+    // 1.5 of 5, only 10 (class 3) of 10
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 5., 10.}, np::Shape{3, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        RadiusNeighborsClassifier<np::float_, np::int_> uniform{{.radius = 1.5, .algorithm = algorithm}, -1};
+        uniform.fit(X, y);
+        EXPECT_TRUE(np::array_equal(uniform.predict(X_test), np::Array<np::int_>{7, -1, 3}));
+        EXPECT_TRUE(np::array_equal(uniform.classes_(), np::Array<np::int_>{3, 7}));
+
+        auto proba = uniform.predict_proba(X_test);
+        checkArrayShape(proba, np::Shape{3, 2});
+        const np::float_ expected_proba[] = {1. / 3, 2. / 3, 0., 0., 1., 0.};
+        for (np::Size i = 0; i < 6; ++i) {
+            EXPECT_NEAR(proba.get(i), expected_proba[i], 1e-12);
+        }
+
+        RadiusNeighborsClassifier<np::float_, np::int_> distance{{.radius = 1.5, .weights = WeightsType::kDistance, .algorithm = algorithm}, 7};
+        distance.fit(X, y);
+        EXPECT_TRUE(np::array_equal(distance.predict(X_test), np::Array<np::int_>{3, 7, 3}));
+        // the outlier label is a known class
+        EXPECT_DOUBLE_EQ(distance.predict_proba(X_test).get(3), 1.);
+
+        RadiusNeighborsClassifier<np::float_, np::int_> no_outliers{{.radius = 1.5, .algorithm = algorithm}};
+        no_outliers.fit(X, y);
+        EXPECT_THROW(no_outliers.predict(X_test), std::runtime_error);
+        EXPECT_THROW(no_outliers.predict_proba(X_test), std::runtime_error);
+    }
+    // the approximate algorithms answer no radius queries
+    EXPECT_THROW((RadiusNeighborsClassifier<np::float_, np::int_>{{.algorithm = AlgorithmType::kHnsw}}), std::runtime_error);
+    EXPECT_THROW((RadiusNeighborsClassifier<np::float_, np::int_>{{.algorithm = AlgorithmType::kIvfPq}}), std::runtime_error);
+}
+
+TEST_F(RadiusNeighborsClassifierTest, radiusNeighborsTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::int_> y{7, 3, 7, 3};
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 5., 10.}, np::Shape{3, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        for (int n_jobs: {1, 3}) {
+            RadiusNeighborsClassifier<np::float_, np::int_> classifier{{.radius = 1.5, .algorithm = algorithm, .n_jobs = n_jobs}};
+            classifier.fit(X, y);
+
+            const auto neighbors = classifier.radius_neighbors(X_test, std::nullopt, true, true);
+            EXPECT_TRUE(np::array_equal(neighbors.offsets, np::Array<np::Size>{0, 3, 3, 4}));
+            EXPECT_TRUE(np::array_equal(neighbors.indices, np::Array<np::Size>{1, 0, 2, 3}));
+            const np::float_ expected_distances[] = {0.1, 0.9, 1.1, 0.};
+            for (np::Size i = 0; i < 4; ++i) {
+                EXPECT_NEAR(neighbors.distances.get(i), expected_distances[i], 1e-12);
+            }
+
+            const auto nearest = classifier.radius_neighbors(X_test, 0.5, false);
+            EXPECT_TRUE(np::array_equal(nearest.offsets, np::Array<np::Size>{0, 1, 1, 2}));
+            EXPECT_TRUE(np::array_equal(nearest.indices, np::Array<np::Size>{1, 3}));
+            EXPECT_EQ(nearest.distances.size(), 0);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ML Methods from scikit-learn library
+
+Copyright (c) 2023 Mikhail Gorshkov (mikhail.gorshkov@gmail.com)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <np/Comp.hpp>
+
+#include <sklearn/neighbors/RadiusNeighborsRegressor.hpp>
+
+#include <SklearnTest.hpp>
+
+#include <cmath>
+
+class RadiusNeighborsRegressorTest : public SklearnTest {
+protected:
+};
+
+TEST_F(RadiusNeighborsRegressorTest, predictTest) {
+    using namespace sklearn::neighbors;
+
+    np::Array<np::float_> X{std::vector<np::float_>{0., 1., 2., 10.}, np::Shape{4, 1}};
+    np::Array<np::float_> y{1., 2., 3., 10.};
+    np::Array<np::float_> X_test{std::vector<np::float_>{0.9, 5., 10.}, np::Shape{3, 1}};
+
+    for (auto algorithm: {AlgorithmType::kBruteForce, AlgorithmType::kKdTree, AlgorithmType::kBallTree}) {
+        for (int n_jobs: {1, 3}) {
+            RadiusNeighborsRegressor<np::float_> uniform{{.radius = 1.5, .algorithm = algorithm, .n_jobs = n_jobs}};
+            uniform.fit(X, y);
+            auto pred = uniform.predict(X_test);
+            checkArrayShape(pred, np::Shape{3});
+            EXPECT_DOUBLE_EQ(pred.get(0), 2.);
+            // no neighbors within the radius
+            EXPECT_TRUE(std::isnan(pred.get(1)));
+            EXPECT_DOUBLE_EQ(pred.get(2), 10.);
+
+            RadiusNeighborsRegressor<np::float_> distance{{.radius = 1.5, .weights = WeightsType::kDistance, .algorithm = algorithm, .n_jobs = n_jobs}};
+            distance.fit(X, y);
+            pred = distance.predict(X_test);
+            EXPECT_NEAR(pred.get(0), (2. / 0.1 + 1. / 0.9 + 3. / 1.1) / (1 / 0.1 + 1 / 0.9 + 1 / 1.1), 1e-12);
+            EXPECT_TRUE(std::isnan(pred.get(1)));
+            EXPECT_DOUBLE_EQ(pred.get(2), 10.);
+
+            const auto neighbors = uniform.radius_neighbors(X_test, 1.0, true, true);
+            EXPECT_TRUE(np::array_equal(neighbors.offsets, np::Array<np::Size>{0, 2, 2, 3}));
+            EXPECT_TRUE(np::array_equal(neighbors.indices, np::Array<np::Size>{1, 0, 3}));
+        }
+    }
+    // the approximate algorithms answer no radius queries
+    EXPECT_THROW(RadiusNeighborsRegressor<np::float_>{{.algorithm = AlgorithmType::kHnsw}}, std::runtime_error);
+    EXPECT_THROW(RadiusNeighborsRegressor<np::float_>{{.algorithm = AlgorithmType::kIvfPq}}, std::runtime_error);
+}
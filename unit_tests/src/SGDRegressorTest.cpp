@@ -34,6 +34,22 @@ SOFTWARE.
 
 class SGDRegressorTest : public SklearnTest {
 protected:
+    // n_samples x 5 gaussian features and y = 0.5 + x . kCoef + noise, row-major.
+    static void generate(np::Size n_samples, std::vector<np::float_> &X, std::vector<np::float_> &y) {
+        std::mt19937 generator{3};
+        std::normal_distribution<np::float_> normal{0.0, 1.0};
+        X.resize(n_samples * kCoef.size());
+        y.resize(n_samples);
+        for (np::Size i = 0; i < n_samples; ++i) {
+            y[i] = 0.5 + 0.1 * normal(generator);
+            for (np::Size j = 0; j < kCoef.size(); ++j) {
+                X[i * kCoef.size() + j] = normal(generator);
+                y[i] += kCoef[j] * X[i * kCoef.size() + j];
+            }
+        }
+    }
+
+    static inline const std::vector<np::float_> kCoef{1.5, -2.0, 0.25, 3.0, -1.0};
 };
 
 TEST_F(SGDRegressorTest, ordinaryLeastSquaresTest) {
@@ -44,16 +60,87 @@ TEST_F(SGDRegressorTest, ordinaryLeastSquaresTest) {
     np::float_ ar2[3] = {0.8, 3.2, 9.0};
     reg.fit(np::Array<np::float_>{ar1}, np::Array<np::float_>{ar2});
 
-    np::float_ coef[2] = {1.567695875262711, 1.5725461064903186};
-    compare(reg.coef_(), np::Array<np::float_>{coef});
+    np::float_ coef[2] = {1.5434303337371817, 1.5522574496994772};
+    for (np::Size j = 0; j < 2; ++j) {
+        EXPECT_NEAR(reg.coef_().get(j), coef[j], 1e-9);
+    }
 
-    EXPECT_DOUBLE_EQ(reg.intercept_(), 0.88612575198061738);
+    EXPECT_NEAR(reg.intercept_(), 0.86435442243056881, 1e-9);
+    EXPECT_EQ(reg.n_iter_(), 72);
+    EXPECT_DOUBLE_EQ(reg.t_(), 217.0);
 
     np::float_ ar_pred[3][2] = {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
     auto pred = reg.predict(np::Array<np::float_>{ar_pred});
 
-    np::float_ pred_sample[3] = {5.5989138402239655, 11.879397803730026, 18.159881767236083};
-    compare(pred, np::Array<np::float_>{pred_sample});
+    np::float_ pred_sample[3] = {5.5122996555667054, 11.703675222440022, 17.895050789313341};
+    for (np::Size i = 0; i < 3; ++i) {
+        EXPECT_NEAR(pred.get(i), pred_sample[i], 1e-9);
+    }
+}
+
+TEST_F(SGDRegressorTest, learningRatesTest) {
+    // Every schedule, loss and batch size converges to the coefficients of the data, stopping on tol long before
+    // max_iter, and a random_state reproduces a fit.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 10000;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    const np::Array<np::float_> X_array{X, np::Shape{n_samples, kCoef.size()}};
+    const np::Array<np::float_> y_array{y, np::Shape{n_samples}};
+    for (auto learning_rate: {LearningRateType::kConstant, LearningRateType::kOptimal, LearningRateType::kInvscaling, LearningRateType::kAdaptive}) {
+        for (auto loss: {LossType::kSquaredError, LossType::kHuber, LossType::kSquaredEpsilonInsensitive}) {
+            for (np::Size batch_size: {1, 32}) {
+                auto reg = SGDRegressor<np::Array<np::float_>>{{.loss = loss, .epsilon = loss == LossType::kHuber ? 1.0 : 0.1, .learning_rate = learning_rate, .batch_size = batch_size}};
+                reg.fit(X_array, y_array);
+                EXPECT_LT(reg.n_iter_(), 200);
+                for (np::Size j = 0; j < kCoef.size(); ++j) {
+                    EXPECT_NEAR(reg.coef_().get(j), kCoef[j], 0.1);
+                }
+                EXPECT_NEAR(reg.intercept_(), 0.5, 0.1);
+            }
+        }
+    }
+
+    auto reg = SGDRegressor<np::Array<np::float_>>{};
+    reg.fit(X_array, y_array);
+    auto again = SGDRegressor<np::Array<np::float_>>{};
+    again.fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_samples, kCoef.size()), y_array);
+    EXPECT_EQ(again.n_iter_(), reg.n_iter_());
+    for (np::Size j = 0; j < kCoef.size(); ++j) {
+        EXPECT_EQ(again.coef_().get(j), reg.coef_().get(j));
+    }
+
+    auto unlimited = SGDRegressor<np::Array<np::float_>>{{.max_iter = 20, .tol = std::nullopt}};
+    unlimited.fit(X_array, y_array);
+    EXPECT_EQ(unlimited.n_iter_(), 20);
+    EXPECT_DOUBLE_EQ(unlimited.t_(), 20.0 * n_samples + 1.0);
+
+    auto early = SGDRegressor<np::Array<np::float_>>{{.early_stopping = true}};
+    early.fit(X_array, y_array);
+    EXPECT_LT(early.n_iter_(), 200);
+    EXPECT_NEAR(early.coef_().get(0), kCoef[0], 0.1);
+
+    EXPECT_THROW((SGDRegressor<np::Array<np::float_>>{{.alpha = 0.0, .learning_rate = LearningRateType::kOptimal}}.fit(X_array, y_array)), std::runtime_error);
+    EXPECT_THROW((SGDRegressor<np::Array<np::float_>>{{.batch_size = 0}}.fit(X_array, y_array)), std::runtime_error);
+}
+
+TEST_F(SGDRegressorTest, penaltyTest) {
+    // L1 and Elastic Net truncate the coefficient of a feature the target does not depend on to zero.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 10000;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    for (np::Size i = 0; i < n_samples; ++i) {
+        y[i] -= kCoef[2] * X[i * kCoef.size() + 2];
+    }
+    for (auto penalty: {PenaltyType::kL1, PenaltyType::kElasticNet}) {
+        auto reg = SGDRegressor<np::Array<np::float_>>{{.penalty = penalty, .alpha = 0.01}};
+        reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, kCoef.size()}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+        EXPECT_EQ(reg.coef_().get(2), 0.0);
+        EXPECT_NEAR(reg.coef_().get(3), kCoef[3], 0.1);
+    }
 }
 
 TEST_F(SGDRegressorTest, diabetesTest) {
@@ -87,13 +174,61 @@ TEST_F(SGDRegressorTest, diabetesTest) {
     auto diabetes_y_pred = regr.predict(diabetes_X_test);
 
     // The coefficients
-    compare(regr.coef_(), np::Array<np::float_>{2.1681799});
+    EXPECT_NEAR(regr.coef_().get(0), 365.4804913, 1e-6);
     // The mean squared error
     MeanSquaredErrorParameters<decltype(diabetes_y_test), decltype(diabetes_y_pred)> mseParams{.y_true = diabetes_y_test, .y_pred = diabetes_y_pred};
     auto mse = mean_squared_error(mseParams);
-    EXPECT_DOUBLE_EQ(mse, 5676.474488286437);
+    EXPECT_NEAR(mse, 3925.202529, 1e-5);
     R2ScoreParameters<decltype(diabetes_y_test), decltype(diabetes_y_pred)> r2ScoreParams{.y_true = diabetes_y_test, .y_pred = diabetes_y_pred};
     // The coefficient of determination: 1 is perfect prediction
     auto r2 = r2_score(r2ScoreParams);
-    EXPECT_DOUBLE_EQ(r2, -0.17497132951225702);
-}
\ No newline at end of file
+    EXPECT_NEAR(r2, 0.1875237979, 1e-9);
+}
+
+TEST_F(SGDRegressorTest, partialFitTest) {
+    // partial_fit carries the coefficients, the learning rate, t_ and the averages over: batches fed in order give
+    // the same model as one pass over all the samples, and passes over a stream of batches converge.
+    using namespace sklearn::linear_model;
+    const np::Size n_samples = 10000;
+    const np::Size n_batch = 100;
+    std::vector<np::float_> X;
+    std::vector<np::float_> y;
+    generate(n_samples, X, y);
+    const auto batch = [&](np::Size begin, np::Size end) {
+        return np::Array<np::float_>{std::vector<np::float_>(y.cbegin() + static_cast<long>(begin), y.cbegin() + static_cast<long>(end)), np::Shape{end - begin}};
+    };
+    for (np::Size average: {0, 1, 5000}) {
+        const SGDRegressorParameters parameters{.max_iter = 1, .tol = std::nullopt, .shuffle = false, .average = average};
+        auto reg = SGDRegressor<np::Array<np::float_>>{parameters};
+        reg.fit(np::Array<np::float_>{X, np::Shape{n_samples, kCoef.size()}}, np::Array<np::float_>{y, np::Shape{n_samples}});
+        auto online = SGDRegressor<np::Array<np::float_>>{parameters};
+        for (np::Size begin = 0; begin < n_samples; begin += n_batch) {
+            online.partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data() + begin * kCoef.size(), n_batch, kCoef.size()), batch(begin, begin + n_batch));
+            EXPECT_EQ(online.n_iter_(), 1);
+        }
+        EXPECT_DOUBLE_EQ(online.t_(), reg.t_());
+        EXPECT_EQ(online.intercept_(), reg.intercept_());
+        for (np::Size j = 0; j < kCoef.size(); ++j) {
+            EXPECT_EQ(online.coef_().get(j), reg.coef_().get(j));
+        }
+    }
+
+    auto stream = SGDRegressor<np::Array<np::float_>>{{.learning_rate = LearningRateType::kConstant, .average = 1}};
+    for (np::Size pass = 0; pass < 5; ++pass) {
+        for (np::Size begin = 0; begin < n_samples; begin += n_batch) {
+            stream.partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data() + begin * kCoef.size(), n_batch, kCoef.size()), batch(begin, begin + n_batch));
+        }
+    }
+    EXPECT_DOUBLE_EQ(stream.t_(), 5.0 * n_samples + 1.0);
+    for (np::Size j = 0; j < kCoef.size(); ++j) {
+        EXPECT_NEAR(stream.coef_().get(j), kCoef[j], 0.05);
+    }
+    EXPECT_NEAR(stream.intercept_(), 0.5, 0.05);
+    // predict_into serves the coefficients of the last partial_fit, as predict does
+    np::float_ prediction{0};
+    stream.predict_into(X.data(), kCoef.size(), &prediction);
+    const auto first = stream.predict(np::Array<np::float_>{std::vector<np::float_>(X.cbegin(), X.cbegin() + static_cast<long>(kCoef.size())), np::Shape{1, kCoef.size()}});
+    EXPECT_EQ(prediction, first.get(0));
+
+    EXPECT_THROW(stream.partial_fit(sklearn::utils::DenseMatrix<np::float_>::view(X.data(), n_batch, kCoef.size() - 1), batch(0, n_batch)), std::runtime_error);
+}
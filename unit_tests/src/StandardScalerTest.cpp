@@ -90,3 +90,29 @@ TEST_F(StandardScalerTest, standardScalerTest3x3) {
     Array<float_> X_scaled_sample{X_scaled_arr};
     compare(X_scaled, X_scaled_sample);
 }
+
+TEST_F(StandardScalerTest, standardScalerFloat32Test) {
+    using namespace preprocessing;
+    using namespace np;
+    float X_train_arr[3][3] = {{1.f, -1.f, 2.f},
+                               {2.f, 0.f, 0.f},
+                               {0.f, 1.f, -1.f}};
+    Array<float> X_train{X_train_arr};
+    for (auto accumulation: {utils::Accumulation::kFloat64, utils::Accumulation::kFloat32}) {
+        auto scaler = StandardScaler<float>{StandardScalerParameters{.accumulation = accumulation}};
+        scaler.fit(X_train);
+        const Array<float_> scaler_var_sample{0.66666666666666663, 0.66666666666666663, 1.5555555555555556};
+        for (Size i = 0; i < 3; ++i) {
+            EXPECT_NEAR(scaler.var_().get(i), scaler_var_sample.get(i), 1e-6);
+        }
+
+        const Array<float> X_scaled = scaler.transform(X_train);
+        const float_ X_scaled_arr[9] = {0., -1.2247448713915889, 1.3363062095621221,
+                                        1.2247448713915889, 0., -0.2672612419124244,
+                                        -1.2247448713915889, 1.2247448713915889, -1.0690449676496976};
+        checkArrayShape(X_scaled, Shape{3, 3});
+        for (Size i = 0; i < 9; ++i) {
+            EXPECT_NEAR(X_scaled.get(i), X_scaled_arr[i], 1e-6);
+        }
+    }
+}